@@ -5,9 +5,13 @@ Creates plots similar to Figure 8 from the SST paper with separate subplots.
 
 Usage:
 python plot_logs.py --files log1.txt log2.txt --labels "HTTP/1.0 Serial" "HTTP/1.1 Pipelined"
+
+--files takes simulation logs or --results files (binary or CSV).
 """
 
 import re
+import csv
+import struct
 import argparse
 import matplotlib.pyplot as plt
 import numpy as np
@@ -45,6 +49,70 @@ def parse_log_file(filename):
     
     return pages
 
+RESULTS_MAGIC = b'SSTRSLTS'
+RESULTS_RECORD_PAGE = 1
+
+def add_result_page(pages, requests, completed, total_size, start_us, end_us):
+    """Keep a page the way the simulations count it: started, with at least one completion."""
+    if start_us > 0 and end_us > start_us and completed > 0:
+        pages.append({
+            'requests': requests,
+            'time_ms': (end_us - start_us) / 1000.0,
+            'total_size': total_size
+        })
+
+def parse_binary_results(filename):
+    """Read the page records of a binary --results file (see http-results.h)."""
+    pages = []
+    with open(filename, 'rb') as f:
+        data = f.read()
+
+    _, version, header_size, page_size, request_size, params_size, _ = struct.unpack_from('<8s6I', data, 0)
+    offset = header_size + params_size
+    if version == 1:
+        while offset + page_size <= len(data):
+            _, _, requests, completed, total_size, _, start_us, end_us = struct.unpack_from('<6I2q', data, offset)
+            offset += page_size + requests * request_size
+            add_result_page(pages, requests, completed, total_size, start_us, end_us)
+        return pages
+
+    # Version 2 tags every record with its type and size; transport
+    # samples and anything newer are skipped
+    while offset + 8 <= len(data):
+        record_type, record_size = struct.unpack_from('<2I', data, offset)
+        offset += 8
+        if record_type == RESULTS_RECORD_PAGE and offset + page_size <= len(data):
+            _, _, requests, completed, total_size, _, start_us, end_us = struct.unpack_from('<6I2q', data, offset)
+            add_result_page(pages, requests, completed, total_size, start_us, end_us)
+        offset += record_size
+    return pages
+
+def parse_csv_results(filename):
+    """Read the page rows of a CSV --results file."""
+    pages = []
+    with open(filename, 'r', newline='') as f:
+        rows = csv.DictReader(line for line in f if not line.startswith('#'))
+        for row in rows:
+            if row['record'] == 'page':
+                add_result_page(pages, int(row['requests']), int(row['completed']),
+                                int(row['size']), int(row['start_us']), int(row['end_us']))
+    return pages
+
+def parse_file(filename):
+    """Parse a --results file, or fall back to the page lines of a log."""
+    try:
+        with open(filename, 'rb') as f:
+            head = f.read(len(RESULTS_MAGIC))
+    except FileNotFoundError:
+        print(f"Warning: File {filename} not found")
+        return []
+
+    if head == RESULTS_MAGIC:
+        return parse_binary_results(filename)
+    if head.startswith(b'# mode='):
+        return parse_csv_results(filename)
+    return parse_log_file(filename)
+
 def group_by_request_count(pages):
     """
     Group pages by request count ranges like in Figure 8.
@@ -206,7 +274,7 @@ def print_statistics(data_sets, labels):
 def main():
     parser = argparse.ArgumentParser(description='Plot HTTP performance logs similar to SST paper Figure 8')
     parser.add_argument('--files', nargs='+', required=True,
-                        help='Log files to process')
+                        help='Log or --results files to process')
     parser.add_argument('--labels', nargs='+', required=True,
                         help='Labels for each log file')
     parser.add_argument('--output', default='http_performance_comparison.png',
@@ -226,7 +294,7 @@ def main():
     data_sets = []
     for filename in args.files:
         print(f"Parsing {filename}...")
-        pages = parse_log_file(filename)
+        pages = parse_file(filename)
         data_sets.append(pages)
         print(f"  Found {len(pages)} pages")
     
@@ -0,0 +1,364 @@
+/* http-bench.cc
+ *
+ * Performance benchmark for the HTTP simulation
+ *
+ * Runs every mode (serial, parallel, persistent, pipelined, sst) on fixed
+ * workloads, each run in its own process and one at a time so they do not
+ * compete for the machine, and reports per run:
+ *
+ * - wall-clock seconds of the whole process (startup, trace load, run)
+ * - simulator events executed and events per wall second
+ * - peak resident set size of the process
+ * - simulated pages completed per wall second
+ *
+ * Workloads:
+ * - "synthetic": a generated trace of --syntheticPages pages, the same for
+ *   a given --seed, written to <outDir>/synthetic.csv
+ * - "trace": the first --tracePages pages of --traceFile, when given
+ *
+ * Next to the plain run of each mode, a variant runs a mode with options of
+ * its own on every workload (BENCH_VARIANTS below), e.g. "sst-idle".
+ *
+ * Each case runs --repeat times; the summary takes the median wall time.
+ * Results go to --output as JSON so successive builds can be compared,
+ * e.g. by the nightly sweep job before it starts.
+ */
+
+ #include "ns3/core-module.h"
+ #include <sys/resource.h>
+ #include <sys/time.h>
+ #include <sys/wait.h>
+ #include <algorithm>
+ #include <cerrno>
+ #include <cstdint>
+ #include <cstdio>
+ #include <cstring>
+ #include <fstream>
+ #include <iostream>
+ #include <sstream>
+ #include <string>
+ #include <vector>
+ #include "http-common/http-process.h"
+
+ using namespace ns3;
+
+ NS_LOG_COMPONENT_DEFINE("HttpBench");
+
+ struct BenchWorkload {
+   std::string name;
+   std::string traceFile;
+   uint32_t pages;
+ };
+
+ struct BenchRun {
+   int exitCode;
+   double wallSeconds;
+   long peakRssKb;
+   HttpRunSummary summary;
+ };
+
+ struct BenchCase {
+   std::string name;                      // The mode, or the variant
+   std::string mode;
+   std::vector<std::string> args;         // The variant's options
+   const BenchWorkload* workload;
+   std::vector<BenchRun> runs;
+ };
+
+ struct BenchVariant {
+   const char* name;
+   const char* mode;
+   const char* args;
+ };
+
+ // sst-idle: the clients wait longer between pages than the server keeps
+ // an idle channel, so every page after the first finds its channel expired
+ // and goes through a RESET and a new channel first
+ static const BenchVariant BENCH_VARIANTS[] = {
+   {"sst-idle", "sst", "--channelIdleTimeout=0.5 --pageGap=1"},
+ };
+
+ static std::vector<std::string> Split(const std::string& s, char sep) {
+   std::vector<std::string> parts;
+   std::stringstream ss(s);
+   std::string part;
+   while (std::getline(ss, part, sep)) {
+     if (!part.empty()) {
+       parts.push_back(part);
+     }
+   }
+   return parts;
+ }
+
+ // Deterministic pages in the ucb_trace_parser CSV format: one primary
+ // and 0-19 embedded objects per page of 256 B - 64 KB each
+ static bool WriteSyntheticTrace(const std::string& filename, uint32_t pages, uint32_t seed) {
+   std::ofstream out(filename);
+   if (!out.is_open()) {
+     return false;
+   }
+   uint64_t state = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+   auto next = [&state](uint32_t range) {
+     state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+     return (uint32_t) ((state >> 33) % range);
+   };
+
+   out << "# Synthetic benchmark trace, seed " << seed << std::endl;
+   for (uint32_t p = 0; p < pages; p++) {
+     out << "GET /bench/" << p << "/index.html HTTP/1.0," << (2048 + next(30000)) << ",1" << std::endl;
+     uint32_t objects = next(20);
+     for (uint32_t o = 0; o < objects; o++) {
+       uint32_t size = (256u << next(9)) + next(256);
+       out << "GET /bench/" << p << "/object" << o << " HTTP/1.0," << size << ",0" << std::endl;
+     }
+     out << "# End of Page" << std::endl;
+   }
+   return out.good();
+ }
+
+ // Run one case to completion; wait4() gives the child's own peak RSS
+ static BenchRun RunOnce(const BenchCase& benchCase, const std::vector<std::string>& fixedArgs,
+                         const std::string& dir) {
+   std::vector<std::string> args;
+   args.push_back(HttpProcess::ProgramPath("http-bench", HttpProcess::GetProgram()));
+   args.push_back("--mode=" + benchCase.mode);
+   args.push_back("--traceFile=" + benchCase.workload->traceFile);
+   args.push_back("--maxPages=" + std::to_string(benchCase.workload->pages));
+   args.insert(args.end(), benchCase.args.begin(), benchCase.args.end());
+   args.insert(args.end(), fixedArgs.begin(), fixedArgs.end());
+
+   BenchRun run;
+   run.exitCode = -1;
+   run.wallSeconds = 0.0;
+   run.peakRssKb = 0;
+
+   double start = HttpProcess::WallClock();
+   pid_t pid = HttpProcess::Launch(args, dir);
+   if (pid < 0) {
+     NS_LOG_ERROR("fork failed: " << strerror(errno));
+     return run;
+   }
+
+   int status;
+   struct rusage usage;
+   while (wait4(pid, &status, 0, &usage) < 0) {
+     if (errno != EINTR) {
+       NS_LOG_ERROR("wait4 failed: " << strerror(errno));
+       return run;
+     }
+   }
+   run.wallSeconds = HttpProcess::WallClock() - start;
+   run.exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+   run.peakRssKb = usage.ru_maxrss;
+   run.summary = HttpProcess::ParseRunLog(dir + "/run.log");
+   return run;
+ }
+
+ static double PerSecond(double count, double seconds) {
+   return seconds > 0.0 ? count / seconds : 0.0;
+ }
+
+ // Run with the median wall time (the lower one for even counts)
+ static const BenchRun& MedianRun(const std::vector<BenchRun>& runs) {
+   std::vector<size_t> order(runs.size());
+   for (size_t i = 0; i < order.size(); i++) {
+     order[i] = i;
+   }
+   std::sort(order.begin(), order.end(), [&runs](size_t a, size_t b) {
+     return runs[a].wallSeconds < runs[b].wallSeconds;
+   });
+   return runs[order[(order.size() - 1) / 2]];
+ }
+
+ static std::string JsonString(const std::string& s) {
+   std::string quoted = "\"";
+   for (char c : s) {
+     if (c == '"' || c == '\\') {
+       quoted += '\\';
+       quoted += c;
+     } else if ((unsigned char) c < 0x20) {
+       char escape[8];
+       snprintf(escape, sizeof(escape), "\\u%04x", c);
+       quoted += escape;
+     } else {
+       quoted += c;
+     }
+   }
+   return quoted + "\"";
+ }
+
+ static void WriteRunJson(std::ostream& out, const BenchRun& run) {
+   out << "{\"exitCode\": " << run.exitCode
+       << ", \"wallSeconds\": " << run.wallSeconds
+       << ", \"simulatorEvents\": " << run.summary.simulatorEvents
+       << ", \"eventsPerSecond\": " << PerSecond(run.summary.simulatorEvents, run.wallSeconds)
+       << ", \"peakRssKb\": " << run.peakRssKb
+       << ", \"completedPages\": " << run.summary.completedPages
+       << ", \"totalPages\": " << run.summary.totalPages
+       << ", \"pagesPerWallSecond\": " << PerSecond(run.summary.completedPages, run.wallSeconds)
+       << ", \"avgPageTimeMs\": " << run.summary.avgPageTimeMs << "}";
+ }
+
+ static bool WriteJson(const std::string& filename, const std::vector<BenchCase>& cases,
+                       uint32_t seed, const std::string& extraArgs) {
+   std::ofstream out(filename);
+   if (!out.is_open()) {
+     return false;
+   }
+   char host[256] = "";
+   gethostname(host, sizeof(host) - 1);
+
+   out << "{" << std::endl;
+   out << "  \"host\": " << JsonString(host) << "," << std::endl;
+   out << "  \"cores\": " << sysconf(_SC_NPROCESSORS_ONLN) << "," << std::endl;
+   out << "  \"seed\": " << seed << "," << std::endl;
+   out << "  \"args\": " << JsonString(extraArgs) << "," << std::endl;
+   out << "  \"cases\": [" << std::endl;
+   for (size_t i = 0; i < cases.size(); i++) {
+     const BenchCase& benchCase = cases[i];
+     out << "    {\"case\": " << JsonString(benchCase.name)
+         << ", \"mode\": " << JsonString(benchCase.mode)
+         << ", \"workload\": " << JsonString(benchCase.workload->name)
+         << ", \"pages\": " << benchCase.workload->pages << "," << std::endl;
+     out << "     \"median\": ";
+     WriteRunJson(out, MedianRun(benchCase.runs));
+     out << "," << std::endl << "     \"runs\": [";
+     for (size_t r = 0; r < benchCase.runs.size(); r++) {
+       out << (r > 0 ? ",\n              " : "");
+       WriteRunJson(out, benchCase.runs[r]);
+     }
+     out << "]}" << (i + 1 < cases.size() ? "," : "") << std::endl;
+   }
+   out << "  ]" << std::endl << "}" << std::endl;
+   return out.good();
+ }
+
+ int main(int argc, char* argv[]) {
+   std::string modes = "serial,parallel,persistent,pipelined,sst";
+   std::string traceFile = "";
+   uint32_t tracePages = 200;
+   uint32_t syntheticPages = 100;
+   uint32_t seed = 1;
+   uint32_t repeat = 3;
+   std::string extraArgs = "";
+   std::string outDir = "bench";
+   std::string outputFile = "";
+
+   CommandLine cmd(__FILE__);
+   cmd.AddValue("modes", "Comma-separated HTTP modes to benchmark", modes);
+   cmd.AddValue("traceFile", "Real trace to benchmark a slice of (optional)", traceFile);
+   cmd.AddValue("tracePages", "Pages of --traceFile to replay", tracePages);
+   cmd.AddValue("syntheticPages", "Pages in the synthetic workload (0 to skip it)", syntheticPages);
+   cmd.AddValue("seed", "Seed of the synthetic workload", seed);
+   cmd.AddValue("repeat", "Runs per mode and workload", repeat);
+   cmd.AddValue("args", "Extra options passed to every run, e.g. \"--time=100 --clients=4\"", extraArgs);
+   cmd.AddValue("outDir", "Directory for the workloads and per-run directories", outDir);
+   cmd.AddValue("output", "JSON results (default <outDir>/bench.json)", outputFile);
+   cmd.Parse(argc, argv);
+
+   std::vector<std::string> modeList = Split(modes, ',');
+   for (const std::string& mode : modeList) {
+     if (!HttpProcess::IsMode(mode)) {
+       std::cout << "Error: unknown mode " << mode << std::endl;
+       return 1;
+     }
+   }
+   if (modeList.empty() || repeat == 0) {
+     std::cout << "Error: nothing to run (check --modes and --repeat)" << std::endl;
+     return 1;
+   }
+   if (!HttpProcess::MakeDirectory(outDir)) {
+     std::cout << "Error: could not create " << outDir << ": " << strerror(errno) << std::endl;
+     return 1;
+   }
+   outDir = HttpProcess::AbsolutePath(outDir);
+   if (outputFile.empty()) {
+     outputFile = outDir + "/bench.json";
+   }
+
+   std::vector<BenchWorkload> workloads;
+   if (syntheticPages > 0) {
+     BenchWorkload synthetic;
+     synthetic.name = "synthetic";
+     synthetic.traceFile = outDir + "/synthetic.csv";
+     synthetic.pages = syntheticPages;
+     if (!WriteSyntheticTrace(synthetic.traceFile, syntheticPages, seed)) {
+       std::cout << "Error: could not write " << synthetic.traceFile << std::endl;
+       return 1;
+     }
+     workloads.push_back(synthetic);
+   }
+   if (!traceFile.empty()) {
+     BenchWorkload trace;
+     trace.name = "trace";
+     trace.traceFile = HttpProcess::AbsolutePath(traceFile);
+     trace.pages = tracePages;
+     workloads.push_back(trace);
+   }
+   if (workloads.empty()) {
+     std::cout << "Error: no workload (give --traceFile or --syntheticPages)" << std::endl;
+     return 1;
+   }
+
+   std::vector<std::string> fixedArgs = Split(extraArgs, ' ');
+   std::vector<BenchCase> cases;
+   for (const BenchWorkload& workload : workloads) {
+     for (const std::string& mode : modeList) {
+       BenchCase benchCase;
+       benchCase.name = mode;
+       benchCase.mode = mode;
+       benchCase.workload = &workload;
+       cases.push_back(benchCase);
+     }
+     for (const BenchVariant& variant : BENCH_VARIANTS) {
+       if (std::find(modeList.begin(), modeList.end(), variant.mode) == modeList.end()) {
+         continue;
+       }
+       BenchCase benchCase;
+       benchCase.name = variant.name;
+       benchCase.mode = variant.mode;
+       benchCase.args = Split(variant.args, ' ');
+       benchCase.workload = &workload;
+       cases.push_back(benchCase);
+     }
+   }
+
+   uint32_t failures = 0;
+   for (size_t i = 0; i < cases.size(); i++) {
+     BenchCase& benchCase = cases[i];
+     std::string dir = outDir + "/" + benchCase.workload->name + "-" + benchCase.name;
+     if (!HttpProcess::MakeDirectory(dir)) {
+       std::cout << "Error: could not create " << dir << ": " << strerror(errno) << std::endl;
+       return 1;
+     }
+     for (uint32_t r = 0; r < repeat; r++) {
+       BenchRun run = RunOnce(benchCase, fixedArgs, dir);
+       if (run.exitCode != 0) {
+         failures++;
+         NS_LOG_WARN(benchCase.name << " on " << benchCase.workload->name << " exited with "
+                     << run.exitCode << ", see " << dir << "/run.log");
+       }
+       benchCase.runs.push_back(run);
+     }
+
+     const BenchRun& median = MedianRun(benchCase.runs);
+     printf("%-10s %-9s %8.3fs %12llu events %12.0f events/s %8ld KB %9.2f pages/s%s\n",
+            benchCase.name.c_str(), benchCase.workload->name.c_str(), median.wallSeconds,
+            (unsigned long long) median.summary.simulatorEvents,
+            PerSecond(median.summary.simulatorEvents, median.wallSeconds), median.peakRssKb,
+            PerSecond(median.summary.completedPages, median.wallSeconds),
+            median.exitCode == 0 ? "" : "  FAILED");
+     fflush(stdout);
+   }
+
+   if (!WriteJson(outputFile, cases, seed, extraArgs)) {
+     std::cout << "Error: could not write " << outputFile << std::endl;
+     return 1;
+   }
+   std::cout << "Wrote " << cases.size() << " benchmark cases to " << outputFile;
+   if (failures > 0) {
+     std::cout << " (" << failures << " runs failed)";
+   }
+   std::cout << std::endl;
+   return failures > 0 ? 1 : 0;
+ }
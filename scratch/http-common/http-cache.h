@@ -0,0 +1,193 @@
+/* http-cache.h
+ *
+ * Browser cache model driven by the trace's cache headers. Each client
+ * gets its own LRU cache with a byte budget, kept in a page source that
+ * wraps the client's own: as a page is handed out, requests for fresh
+ * cached objects (Expires still ahead of the request's trace time) are
+ * dropped, and stale objects with a Last-Modified are revalidated with a
+ * conditional GET. A request the traced browser sent with If-Modified-Since
+ * is revalidated too when it misses, since that browser held a copy from
+ * before the trace. Finished responses are stored when the client is done
+ * with the page, so a request that failed or timed out leaves the cache
+ * alone.
+ *
+ * Conditional GETs carry the object's Last-Modified in the URL next to
+ * size= and the client's copy in If-Modified-Since; the servers answer a
+ * 304 with no body when the object has not changed (HttpNotModified).
+ */
+
+ #ifndef HTTP_CACHE_H
+ #define HTTP_CACHE_H
+
+ #include "ns3/core-module.h"
+ #include "http-counters.h"
+ #include "http-page-source.h"
+ #include "http-trace.h"
+ #include <cstdlib>
+ #include <list>
+ #include <string>
+ #include <unordered_map>
+
+ using namespace ns3;
+
+ // Request URL suffix and header lines of a conditional GET; both are empty
+ // for a plain one, so runs without a cache send the same bytes as before
+ inline std::string HttpCacheQuery(const WebRequest& req) {
+   return req.validator != 0 ? "&lm=" + std::to_string(req.lastModified) : "";
+ }
+
+ inline std::string HttpCacheHeaders(const WebRequest& req) {
+   return req.validator != 0 ? "If-Modified-Since: " + std::to_string(req.validator) + "\r\n" : "";
+ }
+
+ // Server side: whether a GET for url (request holds the request line and
+ // headers) is answered with a 304
+ inline bool HttpRequestNotModified(const std::string& request, const std::string& url) {
+   size_t lm = url.find("&lm=");
+   size_t ims = request.find("\nIf-Modified-Since:");
+   if (lm == std::string::npos || ims == std::string::npos) {
+     return false;
+   }
+   uint32_t lastModified = strtoul(url.c_str() + lm + 4, nullptr, 10);
+   uint32_t ifModifiedSince = strtoul(request.c_str() + ims + 19, nullptr, 10);
+   return HttpNotModified(lastModified, ifModifiedSince);
+ }
+
+ // Status line and headers of a 304, e.g. ("HTTP/1.1", "keep-alive")
+ inline std::string HttpNotModifiedResponse(const std::string& version, const std::string& connection) {
+   return version + " 304 Not Modified\r\nConnection: " + connection + "\r\n\r\n";
+ }
+
+ class HttpCachingPageSource : public HttpPageSource {
+ public:
+   HttpCachingPageSource(Ptr<HttpPageSource> source, uint64_t capacity)
+     : m_source(source), m_capacity(capacity), m_bytes(0) {}
+
+   // Pages whose requests are all fresh in the cache never go out; they
+   // are counted and skipped
+   virtual bool Next(WebPage& page) {
+     while (m_source->Next(page)) {
+       Apply(page);
+       if (!page.requests.empty()) {
+         return true;
+       }
+       HttpCount(HTTP_COUNTER_CACHED_PAGES);
+     }
+     return false;
+   }
+
+   virtual void Done(const WebPage& page) {
+     for (const WebRequest& req : page.requests) {
+       if (req.isComplete) {
+         Store(req);
+       }
+     }
+     m_source->Done(page);
+   }
+
+   virtual bool IsEndless() const {
+     return m_source->IsEndless();
+   }
+
+ private:
+   struct Entry {
+     std::string url;
+     uint32_t size;
+     uint32_t expires;             // 0 if the response had no Expires
+     uint32_t lastModified;        // 0 if it had no Last-Modified
+   };
+
+   typedef std::list<Entry>::iterator EntryIt;
+
+   // Drop the fresh hits and pick the requests to revalidate
+   void Apply(WebPage& page) {
+     size_t kept = 0;
+     for (size_t i = 0; i < page.requests.size(); i++) {
+       WebRequest& req = page.requests[i];
+       req.validator = 0;
+
+       // A reload goes to the server whatever is cached
+       if (!(req.cacheFlags & HTTP_TRACE_NO_CACHE)) {
+         auto it = m_index.find(req.url);
+         if (it != m_index.end()) {
+           Entry& entry = *it->second;
+           if (entry.expires != 0 && req.traceTime < entry.expires) {
+             m_lru.splice(m_lru.begin(), m_lru, it->second);
+             HttpCount(HTTP_COUNTER_CACHE_HITS);
+             continue;
+           }
+           req.validator = entry.lastModified;
+         } else if (req.cacheFlags & HTTP_TRACE_IF_MODIFIED_SINCE) {
+           req.validator = req.ifModifiedSince;
+         }
+       }
+       if (req.validator != 0) {
+         HttpCount(HTTP_COUNTER_CONDITIONAL_REQUESTS);
+       }
+
+       if (kept != i) {
+         page.requests[kept] = std::move(req);
+       }
+       kept++;
+     }
+     page.requests.resize(kept);
+
+     // The page may have lost its primary to the cache
+     for (const WebRequest& req : page.requests) {
+       if (req.isPrimary) {
+         return;
+       }
+     }
+     if (!page.requests.empty()) {
+       page.requests[0].isPrimary = true;
+     }
+   }
+
+   void Store(const WebRequest& req) {
+     auto it = m_index.find(req.url);
+     uint32_t expires = (req.cacheFlags & HTTP_TRACE_EXPIRES) ? req.expires : 0;
+     uint32_t lastModified = (req.cacheFlags & HTTP_TRACE_LAST_MODIFIED) ? req.lastModified : 0;
+
+     // Responses that cannot be reused without asking, or that the server
+     // told us not to keep, replace nothing
+     if ((req.cacheFlags & HTTP_TRACE_SERVER_NO_CACHE) || (expires == 0 && lastModified == 0)) {
+       if (it != m_index.end()) {
+         Erase(it->second);
+       }
+       return;
+     }
+
+     // A 304 refreshes the copy we have; anything else replaces it
+     uint32_t size = req.size;
+     if (it != m_index.end()) {
+       if (req.IsNotModified()) {
+         size = it->second->size;
+       }
+       Erase(it->second);
+     }
+     if (size > m_capacity) {
+       return;
+     }
+     while (m_bytes + size > m_capacity) {
+       Erase(std::prev(m_lru.end()));
+     }
+
+     m_lru.push_front(Entry{req.url, size, expires, lastModified});
+     m_index[req.url] = m_lru.begin();
+     m_bytes += size;
+   }
+
+   void Erase(EntryIt entry) {
+     m_bytes -= entry->size;
+     m_index.erase(entry->url);
+     m_lru.erase(entry);
+   }
+
+   Ptr<HttpPageSource> m_source;
+   uint64_t m_capacity;                 // Byte budget
+   uint64_t m_bytes;                    // Bytes of the cached objects
+   std::list<Entry> m_lru;              // Most recently used first
+   std::unordered_map<std::string, EntryIt> m_index;   // Keyed by URL
+ };
+
+ #endif /* HTTP_CACHE_H */
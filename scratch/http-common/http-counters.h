@@ -0,0 +1,130 @@
+/* http-counters.h
+ *
+ * Event counters and a response time histogram that the HTTP applications
+ * bump in place of per-event log lines. Each update is an array increment,
+ * so they stay on in every build; the totals are printed once after the
+ * run (summed over all ranks in distributed runs).
+ */
+
+ #ifndef HTTP_COUNTERS_H
+ #define HTTP_COUNTERS_H
+
+ #include "ns3/nstime.h"
+ #include <cstdint>
+ #include <iostream>
+
+ using namespace ns3;
+
+ enum HttpCounter {
+   HTTP_COUNTER_REQUESTS_SENT,
+   HTTP_COUNTER_RESPONSES_COMPLETED,
+   HTTP_COUNTER_REQUEST_TIMEOUTS,      // Requests abandoned by a request or page timer
+   HTTP_COUNTER_CONNECTION_FAILURES,
+   HTTP_COUNTER_CONNECTIONS_OPENED,    // TCP connections the clients opened
+   HTTP_COUNTER_IDLE_CLOSES,           // Pooled connections closed after their idle timeout
+   HTTP_COUNTER_CACHE_HITS,            // Requests served fresh from a browser cache
+   HTTP_COUNTER_CACHED_PAGES,          // Pages served from a browser cache entirely
+   HTTP_COUNTER_CONDITIONAL_REQUESTS,  // Requests sent with If-Modified-Since
+   HTTP_COUNTER_NOT_MODIFIED,          // 304 responses the servers sent
+   HTTP_COUNTER_RETRANSMITS,           // SST packets resent after an RTO
+   HTTP_COUNTER_FAST_RETRANSMITS,      // SST packets resent after skipped ACKs
+   HTTP_COUNTER_RTO_EXPIRIES,          // SST retransmission timer expiries that found a loss
+   HTTP_COUNTER_GIVE_UPS,              // SST packets dropped after 5 retransmissions
+   HTTP_COUNTER_SST_RESETS,            // SST RESETs sent for channels without state
+   HTTP_COUNTER_SIMULATOR_EVENTS,      // Events the simulator executed, added after the run
+   HTTP_COUNTER_COUNT
+ };
+
+ class HttpCounters {
+ public:
+   // Buckets of the response time histogram: bucket b counts times in
+   // [2^(b-1), 2^b) microseconds, the last one everything longer
+   static const uint32_t HISTOGRAM_BUCKETS = 32;
+
+   // Number of uint64_t values in GetData()
+   static const uint32_t DATA_SIZE = HTTP_COUNTER_COUNT + HISTOGRAM_BUCKETS;
+
+   // One set per process: the simulator is single threaded
+   static HttpCounters& Get() {
+     static HttpCounters counters;
+     return counters;
+   }
+
+   void Add(HttpCounter counter, uint64_t count = 1) {
+     m_data[counter] += count;
+   }
+
+   // A completed response and how long it took from its request
+   void AddResponse(Time elapsed) {
+     m_data[HTTP_COUNTER_RESPONSES_COMPLETED]++;
+     int64_t micros = elapsed.GetMicroSeconds();
+     uint32_t bucket = 0;
+     while (micros > 0 && bucket < HISTOGRAM_BUCKETS - 1) {
+       micros >>= 1;
+       bucket++;
+     }
+     m_data[HTTP_COUNTER_COUNT + bucket]++;
+   }
+
+   uint64_t GetValue(HttpCounter counter) const {
+     return m_data[counter];
+   }
+
+   // Counters followed by the histogram buckets, for reductions
+   uint64_t* GetData() {
+     return m_data;
+   }
+
+   // Zero everything, between runs of one process
+   void Reset() {
+     for (uint32_t i = 0; i < DATA_SIZE; i++) {
+       m_data[i] = 0;
+     }
+   }
+
+   // Non-zero counters, then the non-empty histogram buckets
+   void Print(std::ostream& os) const {
+     static const char* const names[HTTP_COUNTER_COUNT] = {
+       "requests sent", "responses completed", "request timeouts", "connection failures",
+       "connections opened", "idle closes", "cache hits", "cached pages", "conditional requests",
+       "not modified responses", "retransmits", "fast retransmits", "RTO expiries", "give-ups",
+       "SST resets", "simulator events"
+     };
+
+     os << "\nCounters:" << std::endl;
+     for (uint32_t i = 0; i < HTTP_COUNTER_COUNT; i++) {
+       if (m_data[i] > 0) {
+         os << "  " << names[i] << ": " << m_data[i] << std::endl;
+       }
+     }
+
+     if (m_data[HTTP_COUNTER_RESPONSES_COMPLETED] == 0) {
+       return;
+     }
+     os << "Response time histogram (us):" << std::endl;
+     for (uint32_t b = 0; b < HISTOGRAM_BUCKETS; b++) {
+       uint64_t count = m_data[HTTP_COUNTER_COUNT + b];
+       if (count == 0) {
+         continue;
+       }
+       uint64_t low = b == 0 ? 0 : (uint64_t) 1 << (b - 1);
+       os << "  >= " << low;
+       if (b < HISTOGRAM_BUCKETS - 1) {
+         os << " < " << ((uint64_t) 1 << b);
+       }
+       os << ": " << count << std::endl;
+     }
+   }
+
+ private:
+   HttpCounters() : m_data() {}
+
+   uint64_t m_data[DATA_SIZE];
+ };
+
+ // Shorthand for the call sites
+ inline void HttpCount(HttpCounter counter) {
+   HttpCounters::Get().Add(counter);
+ }
+
+ #endif /* HTTP_COUNTERS_H */
@@ -0,0 +1,199 @@
+/* http-fork.h
+ *
+ * Copy-on-write forking of a prepared simulation, for sweep points that
+ * differ only in their link parameters. With --forkPoints=<file> the
+ * simulation driver loads the trace, builds the topology and installs the
+ * applications once, then forks one child per point: each child applies
+ * its point's options to the network that is already built and runs only
+ * its own traffic. The children share the parent's trace, shards and nodes
+ * copy-on-write, so a point pays for neither a process start nor the setup.
+ *
+ * The point file has one point per line,
+ *   <dir> --key=value ...
+ * with the point's working directory, which cannot contain whitespace
+ * (its stdout/stderr go to <dir>/run.log), and the options IsPointOption
+ * accepts: the link parameters, which can change on a built topology, and
+ * RngRun. A child's RngRun seeds the random streams created after the
+ * fork; those of the setup keep the parent's. As each child exits the
+ * parent prints
+ *   Point <dir> status <waitpid status> wall <seconds>
+ * which ParseStatusLine reads back.
+ */
+
+ #ifndef HTTP_FORK_H
+ #define HTTP_FORK_H
+
+ #include <sys/types.h>
+ #include <sys/wait.h>
+ #include <fcntl.h>
+ #include <unistd.h>
+ #include <cerrno>
+ #include <cstdio>
+ #include <cstring>
+ #include <fstream>
+ #include <iostream>
+ #include <map>
+ #include <sstream>
+ #include <string>
+ #include <utility>
+ #include <vector>
+ #include "http-process.h"
+
+ struct HttpForkPoint {
+   std::string dir;                                            // Absolute working directory
+   std::vector<std::pair<std::string, std::string>> options;   // Without the leading --
+ };
+
+ class HttpForkServer {
+ public:
+   HttpForkServer() : m_failures(0) {}
+
+   // Options a child can still apply once the applications are installed
+   static bool IsPointOption(const std::string& key) {
+     return key == "bandwidth" || key == "delay" || key == "accessBandwidth" ||
+            key == "accessDelay" || key == "RngRun";
+   }
+
+   static bool WritePoints(const std::string& filename, const std::vector<HttpForkPoint>& points) {
+     std::ofstream out(filename);
+     for (const HttpForkPoint& point : points) {
+       out << point.dir;
+       for (const auto& option : point.options) {
+         out << " --" << option.first << "=" << option.second;
+       }
+       out << "\n";
+     }
+     return out.good();
+   }
+
+   static bool ParseStatusLine(const std::string& line, std::string& dir, int& status, double& wallSeconds) {
+     char path[4096];
+     if (sscanf(line.c_str(), "Point %4095s status %d wall %lf", path, &status, &wallSeconds) != 3) {
+       return false;
+     }
+     dir = path;
+     return true;
+   }
+
+   bool Load(const std::string& filename, std::string& error) {
+     std::ifstream in(filename);
+     if (!in.is_open()) {
+       error = "cannot open point file " + filename;
+       return false;
+     }
+     m_points.clear();
+     std::string line;
+     while (std::getline(in, line)) {
+       std::istringstream fields(line);
+       HttpForkPoint point;
+       if (!(fields >> point.dir)) {
+         continue;
+       }
+       std::string option;
+       while (fields >> option) {
+         size_t eq = option.find('=');
+         if (option.compare(0, 2, "--") != 0 || eq == std::string::npos) {
+           error = "bad option '" + option + "' in point file, expected --key=value";
+           return false;
+         }
+         std::string key = option.substr(2, eq - 2);
+         if (!IsPointOption(key)) {
+           error = "--" + key + " cannot differ between forked points";
+           return false;
+         }
+         point.options.push_back({key, option.substr(eq + 1)});
+       }
+       m_points.push_back(point);
+     }
+     if (m_points.empty()) {
+       error = "no points in " + filename;
+       return false;
+     }
+     return true;
+   }
+
+   // Fork a child for every point, at most jobs at once. Returns in each
+   // child with its point, now in the point's directory; returns nullptr in
+   // the parent once every child has exited.
+   const HttpForkPoint* Serve(uint32_t jobs) {
+     std::map<pid_t, size_t> running;
+     std::vector<double> startTimes(m_points.size(), 0.0);
+     size_t next = 0;
+     while (next < m_points.size() || !running.empty()) {
+       while (running.size() < jobs && next < m_points.size()) {
+         // Buffered output would be written again by every child
+         std::cout.flush();
+         std::cerr.flush();
+         fflush(nullptr);
+
+         pid_t pid = fork();
+         if (pid == 0) {
+           if (!EnterDirectory(m_points[next].dir)) {
+             _exit(126);
+           }
+           return &m_points[next];
+         }
+         if (pid < 0) {
+           std::cerr << "Error: fork failed for " << m_points[next].dir << ": " << strerror(errno) << std::endl;
+           if (!running.empty()) {
+             break;  // Retry once a child has exited
+           }
+           ReportPoint(next++, -1, 0.0);
+           continue;
+         }
+         startTimes[next] = HttpProcess::WallClock();
+         running[pid] = next++;
+       }
+       if (running.empty()) {
+         continue;
+       }
+
+       int status;
+       pid_t pid = waitpid(-1, &status, 0);
+       if (pid < 0) {
+         if (errno == EINTR) {
+           continue;
+         }
+         std::cerr << "Error: waitpid failed: " << strerror(errno) << std::endl;
+         return nullptr;
+       }
+       auto it = running.find(pid);
+       if (it == running.end()) {
+         continue;
+       }
+       ReportPoint(it->second, status, HttpProcess::WallClock() - startTimes[it->second]);
+       running.erase(it);
+     }
+     return nullptr;
+   }
+
+   // Points whose child failed or could not be forked
+   uint32_t GetFailures() const {
+     return m_failures;
+   }
+
+ private:
+   static bool EnterDirectory(const std::string& dir) {
+     std::string log = dir + "/run.log";
+     int fd = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+     if (fd < 0 || chdir(dir.c_str()) != 0) {
+       return false;
+     }
+     dup2(fd, STDOUT_FILENO);
+     dup2(fd, STDERR_FILENO);
+     close(fd);
+     return true;
+   }
+
+   void ReportPoint(size_t index, int status, double wallSeconds) {
+     if (status < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+       m_failures++;
+     }
+     std::cout << "Point " << m_points[index].dir << " status " << status << " wall " << wallSeconds << std::endl;
+   }
+
+   std::vector<HttpForkPoint> m_points;
+   uint32_t m_failures;
+ };
+
+ #endif /* HTTP_FORK_H */
@@ -0,0 +1,53 @@
+/* http-log.h
+ *
+ * Compile-time gate for the per-request and per-packet logging in the HTTP
+ * applications. HTTP_LOG_INFO, HTTP_LOG_DEBUG and HTTP_LOG_FUNCTION expand
+ * to the NS_LOG macro of the same name only when their level is at most
+ * HTTP_LOG_MAX_LEVEL; above it the whole statement, message formatting
+ * included, is discarded at compile time and never reaches NS_LOG's
+ * runtime checks. Setup messages, warnings and errors keep using NS_LOG
+ * directly.
+ *
+ * HTTP_LOG_MAX_LEVEL defaults to everything in ns-3 debug builds and to
+ * nothing in release and optimized builds. Override it with e.g.
+ *   CXXFLAGS="-DHTTP_LOG_MAX_LEVEL=1" ./ns3 configure ...
+ * Counts that runs rely on go through http-counters.h instead.
+ */
+
+ #ifndef HTTP_LOG_H
+ #define HTTP_LOG_H
+
+ #include "ns3/log.h"
+
+ enum HttpLogLevel {
+   HTTP_LOG_LEVEL_OFF = 0,
+   HTTP_LOG_LEVEL_INFO = 1,
+   HTTP_LOG_LEVEL_DEBUG = 2,
+   HTTP_LOG_LEVEL_FUNCTION = 3
+ };
+
+ #ifndef HTTP_LOG_MAX_LEVEL
+ #ifdef NS3_BUILD_PROFILE_DEBUG
+ #define HTTP_LOG_MAX_LEVEL HTTP_LOG_LEVEL_FUNCTION
+ #else
+ #define HTTP_LOG_MAX_LEVEL HTTP_LOG_LEVEL_OFF
+ #endif
+ #endif
+
+ template <int Level>
+ struct HttpLogCompiled {
+   static constexpr bool value = Level <= HTTP_LOG_MAX_LEVEL;
+ };
+
+ #define HTTP_LOG_AT(level, statement)                  \
+   do {                                                 \
+     if constexpr (HttpLogCompiled<level>::value) {     \
+       statement;                                       \
+     }                                                  \
+   } while (false)
+
+ #define HTTP_LOG_INFO(msg) HTTP_LOG_AT(HTTP_LOG_LEVEL_INFO, NS_LOG_INFO(msg))
+ #define HTTP_LOG_DEBUG(msg) HTTP_LOG_AT(HTTP_LOG_LEVEL_DEBUG, NS_LOG_DEBUG(msg))
+ #define HTTP_LOG_FUNCTION(parameters) HTTP_LOG_AT(HTTP_LOG_LEVEL_FUNCTION, NS_LOG_FUNCTION(parameters))
+
+ #endif /* HTTP_LOG_H */
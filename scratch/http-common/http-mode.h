@@ -0,0 +1,141 @@
+/* http-mode.h
+ *
+ * Transport mode registry of the simulation driver. Each mode header
+ * (http-serial.h, http-parallel.h, http-persistent.h, http-pipelined.h,
+ * http-sst.h) defines its client and server applications and registers an
+ * HttpMode by name with HTTP_MODE_REGISTER; the driver creates modes by
+ * name and only talks to them through this interface, so several of them
+ * can run back to back in one process.
+ */
+
+ #ifndef HTTP_MODE_H
+ #define HTTP_MODE_H
+
+ #include "ns3/core-module.h"
+ #include "ns3/network-module.h"
+ #include "http-page-source.h"
+ #include "http-results.h"
+ #include <map>
+ #include <memory>
+ #include <string>
+ #include <vector>
+
+ using namespace ns3;
+
+ class HttpMode {
+ public:
+   virtual ~HttpMode() {}
+
+   // Protocol and mode for the run banner, e.g. "HTTP/1.0 SST"
+   virtual std::string GetDescription() const = 0;
+
+   // Mode specific options, added before the command line is parsed
+   virtual void AddOptions(CommandLine& cmd) {}
+
+   // Check the parsed options
+   virtual bool Configure(std::string& error) {
+     return true;
+   }
+
+   // results takes the server's transport samples, if it has any
+   virtual void InstallServer(Ptr<Node> node, uint16_t port, HttpResults* results,
+                              Time start, Time stop) = 0;
+
+   virtual void InstallClient(Ptr<Node> node, uint32_t clientId, Address server,
+                              Ptr<HttpPageSource> pages, HttpResults* results,
+                              Time start, Time stop) = 0;
+
+   // After the run: report the pages the clients did not finish and let
+   // go of them
+   virtual void ReportRemainingPages() = 0;
+ };
+
+ // The usual mode: one server application, client applications that take
+ // their pages from a source and report them to the results
+ template <typename Client, typename Server>
+ class HttpModeOf : public HttpMode {
+ public:
+   virtual void InstallServer(Ptr<Node> node, uint16_t port, HttpResults* results,
+                              Time start, Time stop) {
+     Ptr<Server> server = CreateObject<Server>();
+     server->SetPort(port);
+     ConfigureServer(server);
+     ConfigureServerResults(server, results);
+     node->AddApplication(server);
+     server->SetStartTime(start);
+     server->SetStopTime(stop);
+   }
+
+   virtual void InstallClient(Ptr<Node> node, uint32_t clientId, Address server,
+                              Ptr<HttpPageSource> pages, HttpResults* results,
+                              Time start, Time stop) {
+     Ptr<Client> client = CreateObject<Client>();
+     client->SetServer(server);
+     client->SetResults(results, clientId);
+     client->SetPageSource(pages);
+     ConfigureClient(client);
+     node->AddApplication(client);
+     client->SetStartTime(start);
+     client->SetStopTime(stop);
+     m_clients.push_back(client);
+   }
+
+   virtual void ReportRemainingPages() {
+     for (const auto& client : m_clients) {
+       client->ReportRemainingPages();
+     }
+     m_clients.clear();
+   }
+
+ protected:
+   // Apply the mode's options to a new application
+   virtual void ConfigureServer(Ptr<Server> server) {}
+
+   // Only servers that sample their own transport need the results
+   virtual void ConfigureServerResults(Ptr<Server> server, HttpResults* results) {}
+   virtual void ConfigureClient(Ptr<Client> client) {}
+
+ private:
+   std::vector<Ptr<Client>> m_clients;
+ };
+
+ class HttpModeRegistry {
+ public:
+   typedef std::unique_ptr<HttpMode> (*Factory)();
+
+   static bool Register(const std::string& name, Factory factory) {
+     GetFactories()[name] = factory;
+     return true;
+   }
+
+   // nullptr for an unknown name
+   static std::unique_ptr<HttpMode> Create(const std::string& name) {
+     auto it = GetFactories().find(name);
+     if (it == GetFactories().end()) {
+       return nullptr;
+     }
+     return it->second();
+   }
+
+   static std::vector<std::string> GetNames() {
+     std::vector<std::string> names;
+     for (const auto& entry : GetFactories()) {
+       names.push_back(entry.first);
+     }
+     return names;
+   }
+
+ private:
+   static std::map<std::string, Factory>& GetFactories() {
+     static std::map<std::string, Factory> factories;
+     return factories;
+   }
+ };
+
+ // Register type (an HttpMode subclass) as mode name at static
+ // initialization
+ #define HTTP_MODE_REGISTER(name, type)                                      \
+   static const bool g_##type##Registered = HttpModeRegistry::Register(     \
+     name, []() -> std::unique_ptr<HttpMode> { return std::unique_ptr<HttpMode>(new type()); })
+
+ #endif /* HTTP_MODE_H */
@@ -0,0 +1,126 @@
+/* http-mpi.h
+ *
+ * Optional MPI support for the HTTP simulations. With ns-3 configured
+ * --enable-mpi, a run started under mpirun with --distributed uses the
+ * distributed simulator: every rank builds the whole topology, but only
+ * runs the applications on its own nodes (HttpTopology::IsLocal) and the
+ * results are summed over all ranks at the end.
+ *
+ * Without MPI the helpers report a single rank, so callers need no #ifdefs.
+ */
+
+ #ifndef HTTP_MPI_H
+ #define HTTP_MPI_H
+
+ #include "ns3/core-module.h"
+ #include "http-counters.h"
+ #include "http-stats.h"
+ #include <string>
+
+ #ifdef NS3_MPI
+ #include "ns3/mpi-interface.h"
+ #include <mpi.h>
+ #endif
+
+ using namespace ns3;
+
+ class HttpMpi {
+ public:
+   // Must run before any node is created
+   static bool Enable(int* argc, char*** argv, bool nullMessage, std::string& error) {
+ #ifdef NS3_MPI
+     GlobalValue::Bind("SimulatorImplementationType",
+                       StringValue(nullMessage ? "ns3::NullMessageSimulatorImpl"
+                                               : "ns3::DistributedSimulatorImpl"));
+     MpiInterface::Enable(argc, argv);
+     return true;
+ #else
+     (void) argc;
+     (void) argv;
+     (void) nullMessage;
+     error = "this ns-3 build has no MPI support (configure with --enable-mpi)";
+     return false;
+ #endif
+   }
+
+   static void Disable() {
+ #ifdef NS3_MPI
+     if (MpiInterface::IsEnabled()) {
+       MpiInterface::Disable();
+     }
+ #endif
+   }
+
+   static uint32_t GetSystemId() {
+ #ifdef NS3_MPI
+     if (MpiInterface::IsEnabled()) {
+       return MpiInterface::GetSystemId();
+     }
+ #endif
+     return 0;
+   }
+
+   static uint32_t GetSystemCount() {
+ #ifdef NS3_MPI
+     if (MpiInterface::IsEnabled()) {
+       return MpiInterface::GetSize();
+     }
+ #endif
+     return 1;
+   }
+
+   // Sum every rank's totals and sketches so each rank ends up with the
+   // global result
+   static void ReduceStats(HttpRunStats& stats) {
+ #ifdef NS3_MPI
+     if (!MpiInterface::IsEnabled() || MpiInterface::GetSize() == 1) {
+       return;
+     }
+     double totals[5] = {
+       (double) stats.pageCount, (double) stats.completedPageCount, stats.totalPageTime,
+       (double) stats.totalCompletedRequests, stats.totalRequestTime
+     };
+     MPI_Allreduce(MPI_IN_PLACE, totals, 5, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+     stats.pageCount = totals[0];
+     stats.completedPageCount = totals[1];
+     stats.totalPageTime = totals[2];
+     stats.totalCompletedRequests = totals[3];
+     stats.totalRequestTime = totals[4];
+
+     // Sketches merge by adding their bins
+     stats.ForEachSketch([](const std::string&, HttpQuantileSketch& sketch) {
+       MPI_Allreduce(MPI_IN_PLACE, sketch.GetData(), HttpQuantileSketch::BINS, MPI_UINT64_T,
+                     MPI_SUM, MPI_COMM_WORLD);
+     });
+ #else
+     (void) stats;
+ #endif
+   }
+
+   static void ReduceCounters(HttpCounters& counters) {
+ #ifdef NS3_MPI
+     if (!MpiInterface::IsEnabled() || MpiInterface::GetSize() == 1) {
+       return;
+     }
+     MPI_Allreduce(MPI_IN_PLACE, counters.GetData(), HttpCounters::DATA_SIZE, MPI_UINT64_T,
+                   MPI_SUM, MPI_COMM_WORLD);
+ #else
+     (void) counters;
+ #endif
+   }
+ };
+
+ // Disables MPI when it goes out of scope, so that every way out of main
+ // finalizes it, error returns included
+ class HttpMpiScope {
+ public:
+   HttpMpiScope() {}
+   ~HttpMpiScope() {
+     HttpMpi::Disable();
+   }
+
+   HttpMpiScope(const HttpMpiScope&) = delete;
+   HttpMpiScope& operator=(const HttpMpiScope&) = delete;
+ };
+
+ #endif /* HTTP_MPI_H */
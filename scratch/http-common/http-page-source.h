@@ -0,0 +1,156 @@
+/* http-page-source.h
+ *
+ * Streaming page replay. A client pulls its pages from an HttpPageSource
+ * one at a time as it starts them and hands each one to the results as
+ * soon as it is finished, so only the page being replayed is in memory
+ * however long the trace is. The trace itself stays memory-mapped and is
+ * only read as pages are materialized.
+ */
+
+ #ifndef HTTP_PAGE_SOURCE_H
+ #define HTTP_PAGE_SOURCE_H
+
+ #include "ns3/core-module.h"
+ #include "http-results.h"
+ #include "http-trace.h"
+ #include <cstdint>
+ #include <utility>
+ #include <vector>
+
+ using namespace ns3;
+
+ class HttpPageSource : public SimpleRefCount<HttpPageSource> {
+ public:
+   virtual ~HttpPageSource() {}
+
+   // Fill page with the next page; false once there are no more
+   virtual bool Next(WebPage& page) = 0;
+
+   // The client is done with the last page Next() gave it; called just
+   // before the page is reported and freed
+   virtual void Done(const WebPage& page) {}
+
+   // Generated sources may never run out; nothing is left over to report
+   // from them when a run ends
+   virtual bool IsEndless() const {
+     return false;
+   }
+ };
+
+ // The pages of one client's shard, materialized from the trace on demand.
+ // The trace must stay open until the run is over.
+ class HttpTracePageSource : public HttpPageSource {
+ public:
+   HttpTracePageSource(const HttpTrace& trace, std::vector<uint64_t> indices)
+     : m_trace(trace), m_indices(std::move(indices)), m_next(0) {}
+
+   virtual bool Next(WebPage& page) {
+     if (m_next >= m_indices.size()) {
+       return false;
+     }
+     page = m_trace.GetPage(m_indices[m_next++]);
+     return true;
+   }
+
+ private:
+   const HttpTrace& m_trace;
+   std::vector<uint64_t> m_indices;     // Page indices of the shard, in replay order
+   size_t m_next;
+ };
+
+ // Pages that were built in memory (synthetic workloads); each one is
+ // moved out as it is handed over
+ class HttpVectorPageSource : public HttpPageSource {
+ public:
+   HttpVectorPageSource() : m_next(0) {}
+
+   void Add(WebPage page) {
+     m_pages.push_back(std::move(page));
+   }
+
+   virtual bool Next(WebPage& page) {
+     if (m_next >= m_pages.size()) {
+       return false;
+     }
+     page = std::move(m_pages[m_next]);
+     m_pages[m_next++] = WebPage();
+     return true;
+   }
+
+ private:
+   std::vector<WebPage> m_pages;
+   size_t m_next;
+ };
+
+ // A client's view of its pages: the page being replayed, pulled from the
+ // source, and the completion hook that reports and frees it
+ class HttpPageFeed {
+ public:
+   HttpPageFeed() : m_results(nullptr), m_clientId(0), m_index(0), m_hasPage(false) {}
+
+   void SetSource(Ptr<HttpPageSource> source) {
+     m_source = source;
+   }
+
+   void SetResults(HttpResults* results, uint32_t clientId) {
+     m_results = results;
+     m_clientId = clientId;
+   }
+
+   // Replace the current page with the next one from the source; false
+   // once the source is exhausted
+   bool Next() {
+     if (m_hasPage) {
+       Finish();
+     }
+     m_hasPage = m_source && m_source->Next(m_page);
+     return m_hasPage;
+   }
+
+   bool HasPage() const {
+     return m_hasPage;
+   }
+
+   WebPage& Current() {
+     return m_page;
+   }
+
+   // The current page is done: report it and release its requests. Any
+   // WebRequest pointers into it are invalid afterwards.
+   void Finish() {
+     if (!m_hasPage) {
+       return;
+     }
+     if (m_source) {
+       m_source->Done(m_page);
+     }
+     if (m_results) {
+       m_results->AddPage(m_page, m_clientId, m_index);
+     }
+     m_page = WebPage();
+     m_hasPage = false;
+     m_index++;
+   }
+
+   // Report the page in progress and the ones that never started, for
+   // when the run ends before the client got through its share
+   void FinishAll() {
+     Finish();
+     if (m_source && m_source->IsEndless()) {
+       return;
+     }
+     while (Next()) {
+       Finish();
+     }
+   }
+
+ private:
+   Ptr<HttpPageSource> m_source;
+   HttpResults* m_results;
+   uint32_t m_clientId;
+   uint32_t m_index;             // Index of the current page in the client's share
+   bool m_hasPage;
+   WebPage m_page;
+ };
+
+ #endif /* HTTP_PAGE_SOURCE_H */
@@ -0,0 +1,793 @@
+/* http-parallel.h
+ * 
+ * HTTP/1.0 parallel mode client and server applications for replaying UCB web trace data
+ * Opens up to 8 concurrent TCP connections, one request per connection
+ *
+ * Logs through the log component of the program that includes it, which
+ * must NS_LOG_COMPONENT_DEFINE one before the include.
+ */
+
+ #ifndef HTTP_PARALLEL_H
+ #define HTTP_PARALLEL_H
+
+ #include "ns3/applications-module.h"
+ #include "ns3/core-module.h"
+ #include "ns3/internet-module.h"
+ #include "ns3/network-module.h"
+ #include "ns3/point-to-point-module.h"
+ #include <fstream>
+ #include <string>
+ #include <vector>
+ #include <iostream>
+ #include <sstream>
+ #include <map>
+ #include <queue>
+ #include <algorithm>
+ #include "http-cache.h"
+ #include "http-counters.h"
+ #include "http-log.h"
+ #include "http-parser.h"
+ #include "http-profile.h"
+ #include "http-page-source.h"
+ #include "http-results.h"
+ #include "http-sampler.h"
+ #include "http-send-queue.h"
+ #include "http-trace.h"
+ #include "http-mode.h"
+
+ using namespace ns3;
+ 
+ // Structure to track a parallel connection
+ struct ParallelConnection {
+   Ptr<Socket> socket;
+   bool isActive;
+   bool isConnecting;
+   WebRequest* currentRequest;
+   uint32_t pendingBytes;
+   HttpResponseParser parser;
+   Ptr<HttpTcpTransport> transport;   // Socket state while it is open; queue is 1 until the response is in
+   
+   ParallelConnection() : socket(nullptr), isActive(false), isConnecting(false), 
+                         currentRequest(nullptr), pendingBytes(0),
+                         transport(CreateObject<HttpTcpTransport>()) {}
+ };
+ 
+ // HTTP/1.0 parallel client application
+ class HttpParallelClient : public Application {
+ public:
+   HttpParallelClient() : m_running(false), m_currentPageIndex(0), 
+                         m_maxConnections(8), m_waitingForPrimary(false) {
+     m_sampler.SetTrace(&m_transportTrace);
+   }
+   virtual ~HttpParallelClient() {}
+ 
+   static TypeId GetTypeId() {
+     static TypeId tid = TypeId("ns3::HttpParallelClient")
+       .SetParent<Application>()
+       .SetGroupName("Applications")
+       .AddConstructor<HttpParallelClient>()
+       .AddTraceSource("TransportSample", "Each connection's TCP state, every sample interval it changed",
+                       MakeTraceSourceAccessor(&HttpParallelClient::m_transportTrace),
+                       "ns3::HttpTransportSampler::SampleTracedCallback");
+     return tid;
+   }
+ 
+   // Pages are pulled from the source as the client gets to them
+   void SetPageSource(Ptr<HttpPageSource> source) {
+     m_feed.SetSource(source);
+   }
+ 
+   void SetServer(Address address) {
+     m_serverAddress = address;
+   }
+ 
+   void SetResults(HttpResults* results, uint32_t clientId) {
+     m_feed.SetResults(results, clientId);
+     m_sampler.SetResults(results, clientId, 0);
+   }
+ 
+   // Connection i's transport state, for trace sinks; the object lasts as
+   // long as the client, so sinks can connect before it starts
+   Ptr<HttpTcpTransport> GetTransport(uint32_t connection) {
+     if (m_connections.size() < m_maxConnections) {
+       m_connections.resize(m_maxConnections);
+     }
+     if (connection >= m_connections.size()) {
+       return nullptr;
+     }
+     return m_connections[connection].transport;
+   }
+ 
+   // Report the pages the run ended before this client finished
+   void ReportRemainingPages() {
+     m_feed.FinishAll();
+   }
+ 
+ protected:
+   virtual void DoDispose() {
+     for (uint32_t i = 0; i < m_connections.size(); i++) {
+       CleanupConnection(i);
+     }
+     Application::DoDispose();
+   }
+ 
+   virtual void StartApplication() {
+     HTTP_LOG_FUNCTION(this);
+     m_running = true;
+     
+     // Initialize connection pool
+     m_connections.resize(m_maxConnections);
+     m_sampler.Start([this]() { SampleTransport(); });
+     
+     ProcessNextPage();
+   }
+ 
+   virtual void StopApplication() {
+     HTTP_LOG_FUNCTION(this);
+     m_running = false;
+     m_sampler.Stop();
+     
+     for (uint32_t i = 0; i < m_connections.size(); i++) {
+       CleanupConnection(i);
+     }
+   }
+ 
+ private:
+   // Closed connections are sampled too, as zeros, so a series shows the gaps
+   void SampleTransport() {
+     for (uint32_t i = 0; i < m_connections.size(); i++) {
+       m_sampler.Add(i, m_connections[i].transport);
+     }
+   }
+ 
+   void CleanupConnection(uint32_t connIndex) {
+     if (connIndex >= m_connections.size()) return;
+     
+     ParallelConnection& conn = m_connections[connIndex];
+     
+     if (conn.socket) {
+       // Clear all callbacks before closing
+       conn.socket->SetConnectCallback(
+         MakeNullCallback<void, Ptr<Socket>>(),
+         MakeNullCallback<void, Ptr<Socket>>()
+       );
+       conn.socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+       conn.socket->SetCloseCallbacks(
+         MakeNullCallback<void, Ptr<Socket>>(),
+         MakeNullCallback<void, Ptr<Socket>>()
+       );
+       
+       conn.socket->Close();
+       conn.socket = nullptr;
+     }
+     conn.transport->Unwatch();
+     conn.transport->queue = 0;
+     
+     conn.isActive = false;
+     conn.isConnecting = false;
+     conn.currentRequest = nullptr;
+     conn.pendingBytes = 0;
+     conn.parser.Reset(0);
+   }
+ 
+   void ProcessNextPage() {
+     HTTP_PROFILE_SCOPE(HTTP_PROFILE_PROCESS_NEXT_PAGE);
+     if (!m_running || !m_feed.Next()) {
+       HTTP_LOG_INFO("All pages processed");
+       return;
+     }
+     
+     WebPage& page = m_feed.Current();
+     
+     if (page.requests.empty()) {
+       NS_LOG_WARN("Empty page found at index " << m_currentPageIndex);
+       page.isComplete = true;
+       FinishPage();
+       Simulator::Schedule(MicroSeconds(1), &HttpParallelClient::ProcessNextPage, this);
+       return;
+     }
+     
+     m_pageStartTime = Simulator::Now();
+     
+     // Ensure primary request is first
+     for (size_t i = 0; i < page.requests.size(); i++) {
+       if (page.requests[i].isPrimary) {
+         if (i != 0) {
+           std::swap(page.requests[0], page.requests[i]);
+         }
+         page.primaryRequestId = page.requests[0].id;
+         break;
+       }
+     }
+     
+     // Reset page state
+     page.primaryCompleted = false;
+     page.isComplete = false;
+     m_waitingForPrimary = true;
+     
+     // Clear pending requests queue
+     while (!m_pendingRequests.empty()) {
+       m_pendingRequests.pop();
+     }
+     
+     HTTP_LOG_INFO("Starting page " << m_currentPageIndex << " with " << page.requests.size() << " requests");
+     
+     // Start with primary request
+     StartPrimaryRequest();
+     
+     // Set a timeout for the entire page
+     Simulator::Schedule(Seconds(30), &HttpParallelClient::HandlePageTimeout, this, m_currentPageIndex);
+   }
+ 
+   void StartPrimaryRequest() {
+     if (!m_running || !m_feed.HasPage()) {
+       return;
+     }
+     
+     WebPage& page = m_feed.Current();
+     if (page.requests.empty()) return;
+     
+     HTTP_LOG_INFO("Starting primary request for page " << m_currentPageIndex);
+     
+     // Find an available connection and start the primary request
+     StartRequest(&page.requests[0]);
+   }
+ 
+   void StartSecondaryRequests() {
+     if (!m_running || !m_feed.HasPage()) {
+       return;
+     }
+     
+     WebPage& page = m_feed.Current();
+     if (page.requests.size() <= 1) return;
+     
+     HTTP_LOG_INFO("Starting " << (page.requests.size() - 1) << " secondary requests for page " << m_currentPageIndex);
+     
+     // Queue all secondary requests
+     for (size_t i = 1; i < page.requests.size(); i++) {
+       m_pendingRequests.push(&page.requests[i]);
+     }
+     
+     // Process the queue
+     ProcessPendingRequests();
+   }
+ 
+   void ProcessPendingRequests() {
+     if (!m_running) return;
+     
+     // Try to start as many pending requests as we have available connections
+     while (!m_pendingRequests.empty() && HasAvailableConnection()) {
+       WebRequest* req = m_pendingRequests.front();
+       m_pendingRequests.pop();
+       StartRequest(req);
+     }
+   }
+ 
+   bool HasAvailableConnection() {
+     for (const auto& conn : m_connections) {
+       if (!conn.isActive && !conn.isConnecting) {
+         return true;
+       }
+     }
+     return false;
+   }
+ 
+   int GetAvailableConnectionIndex() {
+     for (size_t i = 0; i < m_connections.size(); i++) {
+       if (!m_connections[i].isActive && !m_connections[i].isConnecting) {
+         return i;
+       }
+     }
+     return -1;
+   }
+ 
+   void StartRequest(WebRequest* request) {
+     int connIndex = GetAvailableConnectionIndex();
+     if (connIndex < 0) {
+       NS_LOG_WARN("No available connections, queueing request");
+       m_pendingRequests.push(request);
+       return;
+     }
+     
+     ParallelConnection& conn = m_connections[connIndex];
+     
+     // Extra safety check
+     if (conn.isActive || conn.isConnecting || conn.currentRequest || conn.socket) {
+       NS_LOG_ERROR("Connection " << connIndex << " is not properly cleaned up");
+       CleanupConnection(connIndex);
+     }
+     
+     conn.currentRequest = request;
+     conn.isConnecting = true;
+     
+     // Create new socket for this request
+     conn.socket = Socket::CreateSocket(GetNode(), TcpSocketFactory::GetTypeId());
+     conn.socket->Bind();
+     conn.transport->Watch(conn.socket);
+     conn.transport->queue = 1;
+     HttpCount(HTTP_COUNTER_CONNECTIONS_OPENED);
+     
+     // Set up callbacks
+     conn.socket->SetConnectCallback(
+       MakeCallback(&HttpParallelClient::ConnectionSucceeded, this, connIndex),
+       MakeCallback(&HttpParallelClient::ConnectionFailed, this, connIndex)
+     );
+     conn.socket->SetRecvCallback(
+       MakeCallback(&HttpParallelClient::HandleRead, this, connIndex)
+     );
+     conn.socket->SetCloseCallbacks(
+       MakeCallback(&HttpParallelClient::HandleClose, this, connIndex),
+       MakeCallback(&HttpParallelClient::HandleClose, this, connIndex)
+     );
+     
+     // Connect to server
+     conn.socket->Connect(m_serverAddress);
+     
+     HTTP_LOG_INFO("Starting connection " << connIndex << " for request " 
+                 << (request->isPrimary ? "[PRIMARY]" : "[SECONDARY]") 
+                 << " URL: " << request->url);
+   }
+ 
+   void ConnectionSucceeded(uint32_t connIndex, Ptr<Socket> socket) {
+     HTTP_LOG_FUNCTION(this << connIndex);
+     
+     if (!m_running || connIndex >= m_connections.size()) return;
+     
+     ParallelConnection& conn = m_connections[connIndex];
+     
+     // Check if this connection is still valid
+     if (!conn.isConnecting || conn.socket != socket) {
+       NS_LOG_WARN("Stale connection callback for connection " << connIndex);
+       return;
+     }
+     
+     conn.isActive = true;
+     conn.isConnecting = false;
+     
+     if (!conn.currentRequest) {
+       NS_LOG_ERROR("Connection succeeded but no current request");
+       CleanupConnection(connIndex);
+       return;
+     }
+     
+     conn.currentRequest->startTime = Simulator::Now();
+     
+     // Extract path from URL
+     std::string path = conn.currentRequest->url;
+     std::istringstream iss(conn.currentRequest->url);
+     std::string method, extractedPath, version;
+     if (iss >> method >> extractedPath >> version) {
+       path = extractedPath;
+     }
+     
+     // Send HTTP/1.0 request
+     std::ostringstream oss;
+     oss << "GET " << path << "?size=" << conn.currentRequest->size
+         << HttpCacheQuery(*conn.currentRequest) << " HTTP/1.0\r\n"
+         << "Host: example.com\r\n"
+         << "User-Agent: ns3-http-parallel-client\r\n"
+         << "Connection: close\r\n"
+         << HttpCacheHeaders(*conn.currentRequest)
+         << "\r\n";
+     std::string request = oss.str();
+     
+     Ptr<Packet> packet = Create<Packet>((uint8_t*) request.c_str(), request.size());
+     int result = socket->Send(packet);
+     
+     if (result == -1) {
+       NS_LOG_ERROR("Failed to send request");
+     } else {
+       HttpCount(HTTP_COUNTER_REQUESTS_SENT);
+       HTTP_LOG_INFO("Connection " << connIndex << " sent request for " 
+                   << conn.currentRequest->url << " (size=" << conn.currentRequest->size << ")"
+                   << (conn.currentRequest->isPrimary ? " [PRIMARY]" : " [SECONDARY]"));
+     }
+     
+     // Set up expected response
+     conn.pendingBytes = conn.currentRequest->size;
+     conn.parser.Reset(conn.pendingBytes);
+   }
+ 
+   void ConnectionFailed(uint32_t connIndex, Ptr<Socket> socket) {
+     HTTP_LOG_FUNCTION(this << connIndex);
+     
+     if (!m_running || connIndex >= m_connections.size()) return;
+     
+     ParallelConnection& conn = m_connections[connIndex];
+     
+     // Check if this is a stale callback
+     if (!conn.isConnecting || conn.socket != socket) {
+       NS_LOG_WARN("Stale connection failed callback for connection " << connIndex);
+       return;
+     }
+     
+     NS_LOG_ERROR("Connection " << connIndex << " failed");
+     HttpCount(HTTP_COUNTER_CONNECTION_FAILURES);
+     
+     // Put request back in queue
+     if (conn.currentRequest) {
+       m_pendingRequests.push(conn.currentRequest);
+     }
+     
+     CleanupConnection(connIndex);
+     
+     // Try to process pending requests with other connections
+     Simulator::Schedule(MicroSeconds(10), &HttpParallelClient::ProcessPendingRequests, this);
+   }
+ 
+   void HandleRead(uint32_t connIndex, Ptr<Socket> socket) {
+     HTTP_PROFILE_SCOPE(HTTP_PROFILE_CLIENT_READ);
+     HTTP_LOG_FUNCTION(this << connIndex);
+     
+     if (!m_running || connIndex >= m_connections.size()) return;
+     
+     ParallelConnection& conn = m_connections[connIndex];
+     
+     // Check if this is a stale callback
+     if (!conn.isActive || conn.socket != socket) {
+       NS_LOG_WARN("Stale read callback for connection " << connIndex);
+       return;
+     }
+     
+     Ptr<Packet> packet;
+     Address from;
+     
+     while ((packet = socket->RecvFrom(from))) {
+       ProcessResponse(connIndex, packet);
+     }
+   }
+ 
+   void ProcessResponse(uint32_t connIndex, Ptr<Packet> packet) {
+     if (connIndex >= m_connections.size()) return;
+     
+     ParallelConnection& conn = m_connections[connIndex];
+     uint32_t used = conn.parser.Consume(packet);
+     
+     // Check if connection is still valid (defensive programming)
+     if (!conn.currentRequest) {
+       NS_LOG_WARN("Connection " << connIndex << " has no current request during response processing");
+       return;
+     }
+     
+     HTTP_LOG_DEBUG("Connection " << connIndex << " received " << used 
+                  << " bytes (body: " << conn.parser.GetBodyBytes() 
+                  << "/" << conn.parser.GetContentLength() << ")");
+     
+     // Check if response is complete
+     if (conn.parser.IsComplete() && conn.currentRequest) {
+       conn.currentRequest->completeTime = Simulator::Now();
+       conn.currentRequest->isComplete = true;
+       Time responseTime = conn.currentRequest->completeTime - conn.currentRequest->startTime;
+       HttpCounters::Get().AddResponse(responseTime);
+       
+       bool isPrimary = conn.currentRequest->isPrimary;
+       
+       HTTP_LOG_INFO("Connection " << connIndex << " completed request in " 
+                   << responseTime.GetSeconds() << " seconds"
+                   << (isPrimary ? " [PRIMARY]" : " [SECONDARY]"));
+       
+       if (isPrimary) {
+         HandlePrimaryRequestComplete();
+       }
+       
+       // Clean up this connection
+       CleanupConnection(connIndex);
+       
+       // Process more pending requests
+       ProcessPendingRequests();
+       
+       // Check if page is complete
+       CheckPageComplete();
+     }
+   }
+ 
+   void HandlePrimaryRequestComplete() {
+     if (!m_feed.HasPage()) return;
+     
+     WebPage& page = m_feed.Current();
+     page.primaryCompleted = true;
+     m_waitingForPrimary = false;
+     
+     HTTP_LOG_INFO("Primary request completed for page " << m_currentPageIndex << " - starting secondary requests");
+     
+     StartSecondaryRequests();
+   }
+ 
+   void CheckPageComplete() {
+     if (!m_feed.HasPage()) return;
+     
+     WebPage& page = m_feed.Current();
+     
+     // Count completed requests
+     uint32_t completedRequests = 0;
+     for (const auto& req : page.requests) {
+       if (!req.completeTime.IsZero()) {
+         completedRequests++;
+       }
+     }
+     
+     // Check if all requests are complete
+     if (completedRequests >= page.requests.size()) {
+       page.isComplete = true;
+       
+       // Calculate page load time
+       Time pageStartTime = Seconds(0);
+       Time pageEndTime = Seconds(0);
+       
+       // Find primary request start time
+       for (const auto& req : page.requests) {
+         if (req.isPrimary && !req.startTime.IsZero()) {
+           pageStartTime = req.startTime;
+           break;
+         }
+       }
+       
+       // Find latest completion time
+       for (const auto& req : page.requests) {
+         if (!req.completeTime.IsZero() && 
+             (pageEndTime.IsZero() || req.completeTime > pageEndTime)) {
+           pageEndTime = req.completeTime;
+         }
+       }
+       
+       if (!pageStartTime.IsZero() && !pageEndTime.IsZero()) {
+         double pageTime = (pageEndTime - pageStartTime).GetSeconds();
+         HTTP_LOG_INFO("Page " << m_currentPageIndex << " completed in " 
+                     << pageTime << " seconds (all " << completedRequests << " requests done)");
+       }
+       
+       FinishPage();
+       Simulator::Schedule(MicroSeconds(10), &HttpParallelClient::ProcessNextPage, this);
+     }
+   }
+ 
+   // The page is done: drop every pointer still held into it and hand it
+   // to the results, which frees it
+   void FinishPage() {
+     while (!m_pendingRequests.empty()) {
+       m_pendingRequests.pop();
+     }
+     m_feed.Finish();
+     m_currentPageIndex++;
+   }
+ 
+   void HandlePageTimeout(uint32_t pageIndex) {
+     if (!m_running || pageIndex != m_currentPageIndex) {
+       return;
+     }
+     
+     WebPage& page = m_feed.Current();
+     
+     uint32_t completedRequests = 0;
+     for (const auto& req : page.requests) {
+       if (!req.completeTime.IsZero()) {
+         completedRequests++;
+       }
+     }
+     
+     NS_LOG_WARN("Page " << m_currentPageIndex << " timeout - only " << completedRequests 
+                 << "/" << page.requests.size() << " requests completed. Moving to next page.");
+     
+     // Mark incomplete requests as completed (for statistics)
+     for (auto& req : page.requests) {
+       if (req.completeTime.IsZero()) {
+         req.completeTime = Simulator::Now();
+         HttpCount(HTTP_COUNTER_REQUEST_TIMEOUTS);
+       }
+     }
+     
+     // Cancel all active connections
+     for (uint32_t i = 0; i < m_connections.size(); i++) {
+       if (m_connections[i].isActive || m_connections[i].isConnecting) {
+         CleanupConnection(i);
+       }
+     }
+     
+     page.isComplete = true;
+     FinishPage();
+     Simulator::Schedule(MicroSeconds(10), &HttpParallelClient::ProcessNextPage, this);
+   }
+ 
+   void HandleClose(uint32_t connIndex, Ptr<Socket> socket) {
+     HTTP_LOG_FUNCTION(this << connIndex);
+     
+     if (connIndex >= m_connections.size()) return;
+     
+     ParallelConnection& conn = m_connections[connIndex];
+     
+     // Check if this is a stale callback
+     if (conn.socket != socket) {
+       NS_LOG_WARN("Stale close callback for connection " << connIndex);
+       return;
+     }
+     
+     // Connection closed - might be normal after response is complete
+     if (conn.isActive && conn.currentRequest && conn.currentRequest->completeTime.IsZero()) {
+       // Unexpected close
+       NS_LOG_WARN("Connection " << connIndex << " closed unexpectedly");
+       
+       // Put request back in queue to retry
+       m_pendingRequests.push(conn.currentRequest);
+     }
+     
+     CleanupConnection(connIndex);
+     
+     // Try to process more pending requests
+     ProcessPendingRequests();
+   }
+ 
+   bool m_running;
+   Address m_serverAddress;
+   HttpPageFeed m_feed;                        // Page being replayed, pulled from the source
+   uint32_t m_currentPageIndex;
+   std::vector<ParallelConnection> m_connections;
+   uint32_t m_maxConnections;
+   std::queue<WebRequest*> m_pendingRequests;
+   Time m_pageStartTime;
+   bool m_waitingForPrimary;
+   HttpTransportSampler m_sampler;
+   TracedCallback<const HttpResultsSampleRecord&> m_transportTrace;
+ };
+ 
+ // HTTP server application (same as in serial version)
+ class HttpParallelServer : public Application {
+ public:
+   HttpParallelServer() : m_socket(nullptr), m_running(false) {}
+   virtual ~HttpParallelServer() {}
+ 
+   static TypeId GetTypeId() {
+     static TypeId tid = TypeId("ns3::HttpParallelServer")
+       .SetParent<Application>()
+       .SetGroupName("Applications")
+       .AddConstructor<HttpParallelServer>();
+     return tid;
+   }
+ 
+   void SetPort(uint16_t port) {
+     m_port = port;
+   }
+ 
+ protected:
+   virtual void DoDispose() {
+     if (m_socket) {
+       m_socket->Close();
+       m_socket = nullptr;
+     }
+     
+     m_sendQueue.CloseAll();
+     
+     Application::DoDispose();
+   }
+ 
+   virtual void StartApplication() {
+     HTTP_LOG_FUNCTION(this);
+     m_running = true;
+     
+     if (!m_socket) {
+       m_socket = Socket::CreateSocket(GetNode(), TcpSocketFactory::GetTypeId());
+       InetSocketAddress local = InetSocketAddress(Ipv4Address::GetAny(), m_port);
+       m_socket->Bind(local);
+       m_socket->Listen();
+       
+       m_socket->SetAcceptCallback(
+         MakeNullCallback<bool, Ptr<Socket>, const Address &>(),
+         MakeCallback(&HttpParallelServer::HandleAccept, this)
+       );
+     }
+     
+     HTTP_LOG_INFO("HTTP server listening on port " << m_port);
+   }
+ 
+   virtual void StopApplication() {
+     HTTP_LOG_FUNCTION(this);
+     m_running = false;
+     
+     if (m_socket) {
+       m_socket->Close();
+       m_socket = nullptr;
+     }
+     
+     m_sendQueue.CloseAll();
+   }
+ 
+ private:
+   void HandleAccept(Ptr<Socket> socket, const Address& from) {
+     HTTP_LOG_FUNCTION(this << socket << from);
+     
+     socket->SetRecvCallback(MakeCallback(&HttpParallelServer::HandleRead, this));
+     socket->SetCloseCallbacks(MakeCallback(&HttpParallelServer::HandleClose, this),
+                               MakeCallback(&HttpParallelServer::HandleClose, this));
+     m_sendQueue.Add(socket);
+     
+     HTTP_LOG_INFO("Server accepted connection from " 
+                 << InetSocketAddress::ConvertFrom(from).GetIpv4());
+   }
+   
+   // The client closed the connection or it failed: release the socket
+   void HandleClose(Ptr<Socket> socket) {
+     HTTP_LOG_FUNCTION(this << socket);
+     m_sendQueue.Remove(socket);
+     socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+     socket->Close();
+   }
+ 
+   void HandleRead(Ptr<Socket> socket) {
+     HTTP_PROFILE_SCOPE(HTTP_PROFILE_SERVER_READ);
+     HTTP_LOG_FUNCTION(this << socket);
+     
+     Ptr<Packet> packet;
+     Address from;
+     
+     while ((packet = socket->RecvFrom(from))) {
+       uint32_t size = std::min(packet->GetSize(), (uint32_t)2048);
+       std::string request(size, '\0');
+       packet->CopyData((uint8_t*) &request[0], size);
+       
+       HTTP_LOG_INFO("Server received request: " << size << " bytes");
+       
+       // Parse the request
+       std::istringstream iss(request);
+       std::string method, path, version;
+       if (iss >> method >> path >> version) {
+         SendResponse(socket, path, HttpRequestNotModified(request, path));
+       }
+     }
+   }
+ 
+   void SendResponse(Ptr<Socket> socket, const std::string& url, bool notModified) {
+     HTTP_PROFILE_SCOPE(HTTP_PROFILE_SEND_RESPONSE);
+     if (notModified) {
+       HttpCount(HTTP_COUNTER_NOT_MODIFIED);
+       m_sendQueue.Send(socket, HttpNotModifiedResponse("HTTP/1.0", "close"), 0);
+       return;
+     }
+     
+     // Determine response size first
+     uint32_t responseSize = 1024;
+     
+     size_t pos = url.find("size=");
+     if (pos != std::string::npos) {
+       try {
+         std::string sizeStr = url.substr(pos + 5);
+         size_t endPos = sizeStr.find_first_of(" \t\r\n&");
+         if (endPos != std::string::npos) {
+           sizeStr = sizeStr.substr(0, endPos);
+         }
+         responseSize = std::stoul(sizeStr);
+       } catch (const std::exception& e) {
+         NS_LOG_WARN("Invalid size in URL: " << url);
+       }
+     }
+     
+     // Send HTTP headers with Content-Length
+     std::ostringstream header;
+     header << "HTTP/1.0 200 OK\r\n"
+            << "Content-Type: text/html\r\n"
+            << "Content-Length: " << responseSize << "\r\n"
+            << "Connection: close\r\n"
+            << "\r\n";
+     std::string headerStr = header.str();
+     
+     HTTP_LOG_INFO("Server sending response of " << responseSize << " bytes");
+     
+     // Headers, then the body as fast as the TX buffer drains
+     m_sendQueue.Send(socket, headerStr, responseSize);
+   }
+ 
+   Ptr<Socket> m_socket;
+   HttpSendQueue m_sendQueue;   // Connected sockets and their unsent responses
+   uint16_t m_port;
+   bool m_running;
+ };
+
+ // Up to 8 concurrent connections, one request each
+ class HttpParallelMode : public HttpModeOf<HttpParallelClient, HttpParallelServer> {
+ public:
+   virtual std::string GetDescription() const {
+     return "HTTP/1.0 parallel";
+   }
+ };
+ 
+ HTTP_MODE_REGISTER("parallel", HttpParallelMode);
+
+ #endif /* HTTP_PARALLEL_H */
@@ -0,0 +1,153 @@
+/* http-parser.h
+ *
+ * Incremental HTTP response parser shared by the TCP clients. Response
+ * bodies are size-only ns-3 packets, so only header bytes are copied out
+ * of a packet; once the headers are parsed the body is just counted down
+ * from Content-Length, or taken to be empty for a status that has none
+ * (304 Not Modified). Every byte is looked at once, however the response
+ * is split across packets.
+ *
+ * Consume() stops at the end of the body and returns how many bytes it
+ * used, so a pipelined client can hand the rest of the packet to the next
+ * response.
+ */
+
+ #ifndef HTTP_PARSER_H
+ #define HTTP_PARSER_H
+
+ #include "ns3/network-module.h"
+ #include <algorithm>
+ #include <cstdlib>
+ #include <strings.h>
+ #include <string>
+
+ using namespace ns3;
+
+ class HttpResponseParser {
+ public:
+   HttpResponseParser() {
+     Reset(0);
+   }
+
+   // Start a new response. fallbackLength is the body length to expect
+   // when the headers carry no Content-Length.
+   void Reset(uint32_t fallbackLength) {
+     m_inHeader = true;
+     m_statusLine = true;
+     m_line.clear();
+     m_status = 0;
+     m_contentLength = fallbackLength;
+     m_bodyBytes = 0;
+   }
+
+   // Feed the bytes of packet from offset on; returns how many belong to
+   // this response
+   uint32_t Consume(Ptr<const Packet> packet, uint32_t offset = 0) {
+     uint32_t available = packet->GetSize() - offset;
+     uint32_t used = 0;
+
+     while (m_inHeader && used < available) {
+       uint8_t buffer[HEADER_CHUNK];
+       uint32_t chunk = std::min(available - used, HEADER_CHUNK);
+       CopyBytes(packet, offset + used, chunk, buffer);
+
+       uint32_t i = 0;
+       while (i < chunk && m_inHeader) {
+         ScanHeaderByte(buffer[i++]);
+       }
+       used += i;
+     }
+
+     if (!m_inHeader) {
+       uint32_t body = std::min(available - used, m_contentLength - m_bodyBytes);
+       m_bodyBytes += body;
+       used += body;
+     }
+     return used;
+   }
+
+   bool InHeader() const {
+     return m_inHeader;
+   }
+
+   bool IsComplete() const {
+     return !m_inHeader && m_bodyBytes >= m_contentLength;
+   }
+
+   // Status code, 0 until the status line is in
+   uint32_t GetStatus() const {
+     return m_status;
+   }
+
+   uint32_t GetContentLength() const {
+     return m_contentLength;
+   }
+
+   uint32_t GetBodyBytes() const {
+     return m_bodyBytes;
+   }
+
+ private:
+   static constexpr uint32_t HEADER_CHUNK = 256;
+   static const size_t MAX_LINE = 1024;
+
+   static void CopyBytes(Ptr<const Packet> packet, uint32_t offset, uint32_t size, uint8_t* buffer) {
+     if (offset == 0) {
+       packet->CopyData(buffer, size);
+     } else {
+       packet->CreateFragment(offset, size)->CopyData(buffer, size);
+     }
+   }
+
+   void ScanHeaderByte(uint8_t c) {
+     if (c != '\n') {
+       if (c != '\r' && m_line.size() < MAX_LINE) {
+         m_line.push_back((char) c);
+       }
+       return;
+     }
+
+     // An empty line ends the headers
+     if (m_line.empty()) {
+       m_inHeader = false;
+       return;
+     }
+     if (m_statusLine) {
+       m_statusLine = false;
+       ParseStatusLine();
+     } else if (HasBody() && m_line.size() > 15 && strncasecmp(m_line.c_str(), "Content-Length:", 15) == 0) {
+       char* end = nullptr;
+       unsigned long length = strtoul(m_line.c_str() + 15, &end, 10);
+       if (end != m_line.c_str() + 15) {
+         m_contentLength = length;
+       }
+     }
+     m_line.clear();
+   }
+
+   // "HTTP/1.x NNN Reason"
+   void ParseStatusLine() {
+     size_t space = m_line.find(' ');
+     if (m_line.compare(0, 5, "HTTP/") != 0 || space == std::string::npos) {
+       return;
+     }
+     m_status = strtoul(m_line.c_str() + space + 1, nullptr, 10);
+     if (!HasBody()) {
+       m_contentLength = 0;
+     }
+   }
+
+   // 1xx, 204 and 304 responses end with their headers
+   bool HasBody() const {
+     return !(m_status / 100 == 1 || m_status == 204 || m_status == 304);
+   }
+
+   bool m_inHeader;
+   bool m_statusLine;           // The next header line is the status line
+   std::string m_line;          // Current header line without CR/LF
+   uint32_t m_status;
+   uint32_t m_contentLength;
+   uint32_t m_bodyBytes;
+ };
+
+ #endif /* HTTP_PARSER_H */
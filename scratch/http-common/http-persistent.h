@@ -0,0 +1,916 @@
+/* http-persistent.h
+ * 
+ * HTTP/1.1 persistent mode client and server applications for replaying UCB web trace data
+ * Uses up to 2 concurrent persistent TCP connections as per RFC 2616
+ * No pipelining - waits for response before sending next request on same connection
+ *
+ * Logs through the log component of the program that includes it, which
+ * must NS_LOG_COMPONENT_DEFINE one before the include.
+ */
+
+ #ifndef HTTP_PERSISTENT_H
+ #define HTTP_PERSISTENT_H
+
+ #include "ns3/applications-module.h"
+ #include "ns3/core-module.h"
+ #include "ns3/internet-module.h"
+ #include "ns3/network-module.h"
+ #include "ns3/point-to-point-module.h"
+ #include <fstream>
+ #include <string>
+ #include <vector>
+ #include <iostream>
+ #include <sstream>
+ #include <map>
+ #include <unordered_map>
+ #include <queue>
+ #include <algorithm>
+ #include "http-cache.h"
+ #include "http-counters.h"
+ #include "http-log.h"
+ #include "http-parser.h"
+ #include "http-profile.h"
+ #include "http-page-source.h"
+ #include "http-results.h"
+ #include "http-sampler.h"
+ #include "http-send-queue.h"
+ #include "http-trace.h"
+ #include "http-mode.h"
+
+ using namespace ns3;
+ 
+ // Structure to track a persistent connection
+ struct PersistentConnection {
+   Ptr<Socket> socket;
+   bool isConnected;
+   bool isConnecting;
+   bool isBusy;           // Is currently handling a request
+   WebRequest* currentRequest;    // Null while draining a response of a finished page
+   HttpResponseParser parser;
+   EventId idleTimer;             // Closes the connection once it has been idle too long
+   Ptr<HttpTcpTransport> transport;   // Socket state while it is open; queue is 1 while busy
+   
+   PersistentConnection() : socket(nullptr), isConnected(false), isConnecting(false), 
+                           isBusy(false), currentRequest(nullptr),
+                           transport(CreateObject<HttpTcpTransport>()) {}
+ };
+ 
+ // HTTP/1.1 persistent client application
+ class HttpPersistentClient : public Application {
+ public:
+   HttpPersistentClient() : m_running(false), m_currentPageIndex(0), 
+                           m_maxConnections(2), m_idleTimeout(Seconds(0)), m_waitingForPrimary(false) {
+     m_sampler.SetTrace(&m_transportTrace);
+   }
+   virtual ~HttpPersistentClient() {}
+ 
+   static TypeId GetTypeId() {
+     static TypeId tid = TypeId("ns3::HttpPersistentClient")
+       .SetParent<Application>()
+       .SetGroupName("Applications")
+       .AddConstructor<HttpPersistentClient>()
+       .AddTraceSource("TransportSample", "Each pooled connection's TCP state, every sample interval it changed",
+                       MakeTraceSourceAccessor(&HttpPersistentClient::m_transportTrace),
+                       "ns3::HttpTransportSampler::SampleTracedCallback");
+     return tid;
+   }
+ 
+   // Pages are pulled from the source as the client gets to them
+   void SetPageSource(Ptr<HttpPageSource> source) {
+     m_feed.SetSource(source);
+   }
+ 
+   void SetServer(Address address) {
+     m_serverAddress = address;
+   }
+ 
+   void SetResults(HttpResults* results, uint32_t clientId) {
+     m_feed.SetResults(results, clientId);
+     m_sampler.SetResults(results, clientId, 0);
+   }
+ 
+   // Size of the connection pool to the server; set before the client starts
+   void SetMaxConnections(uint32_t connections) {
+     m_maxConnections = connections;
+   }
+ 
+   // Close pooled connections that have had nothing to do for this long;
+   // zero keeps them open for the whole run
+   void SetIdleTimeout(Time timeout) {
+     m_idleTimeout = timeout;
+   }
+ 
+   // Connection i's transport state, for trace sinks; the object lasts as
+   // long as the client, so sinks can connect before it starts;
+   // call it after SetMaxConnections
+   Ptr<HttpTcpTransport> GetTransport(uint32_t connection) {
+     if (m_connections.size() < m_maxConnections) {
+       m_connections.resize(m_maxConnections);
+     }
+     if (connection >= m_connections.size()) {
+       return nullptr;
+     }
+     return m_connections[connection].transport;
+   }
+ 
+   // Report the pages the run ended before this client finished
+   void ReportRemainingPages() {
+     m_feed.FinishAll();
+   }
+ 
+ protected:
+   virtual void DoDispose() {
+     for (auto& conn : m_connections) {
+       CleanupConnection(conn);
+     }
+     Application::DoDispose();
+   }
+ 
+   virtual void StartApplication() {
+     HTTP_LOG_FUNCTION(this);
+     m_running = true;
+     
+     // The connection pool (2 persistent connections as per RFC 2616 by
+     // default); connections open on demand and stay open across pages
+     m_connections.resize(m_maxConnections);
+     m_sampler.Start([this]() { SampleTransport(); });
+     
+     ProcessNextPage();
+   }
+ 
+   virtual void StopApplication() {
+     HTTP_LOG_FUNCTION(this);
+     m_running = false;
+     m_sampler.Stop();
+     
+     for (auto& conn : m_connections) {
+       CleanupConnection(conn);
+     }
+   }
+ 
+ private:
+   // Closed connections are sampled too, as zeros, so a series shows the gaps
+   void SampleTransport() {
+     for (uint32_t i = 0; i < m_connections.size(); i++) {
+       m_sampler.Add(i, m_connections[i].transport);
+     }
+   }
+ 
+   void CleanupConnection(PersistentConnection& conn) {
+     Simulator::Cancel(conn.idleTimer);
+     if (conn.socket) {
+       // Clear all callbacks before closing
+       conn.socket->SetConnectCallback(
+         MakeNullCallback<void, Ptr<Socket>>(),
+         MakeNullCallback<void, Ptr<Socket>>()
+       );
+       conn.socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+       conn.socket->SetCloseCallbacks(
+         MakeNullCallback<void, Ptr<Socket>>(),
+         MakeNullCallback<void, Ptr<Socket>>()
+       );
+       
+       conn.socket->Close();
+       conn.socket = nullptr;
+     }
+     conn.transport->Unwatch();
+     conn.transport->queue = 0;
+     
+     conn.isConnected = false;
+     conn.isConnecting = false;
+     conn.isBusy = false;
+     conn.currentRequest = nullptr;
+     conn.parser.Reset(0);
+   }
+ 
+   void ProcessNextPage() {
+     HTTP_PROFILE_SCOPE(HTTP_PROFILE_PROCESS_NEXT_PAGE);
+     if (!m_running || !m_feed.Next()) {
+       HTTP_LOG_INFO("All pages processed");
+       return;
+     }
+     
+     WebPage& page = m_feed.Current();
+     
+     if (page.requests.empty()) {
+       NS_LOG_WARN("Empty page found at index " << m_currentPageIndex);
+       page.isComplete = true;
+       FinishPage();
+       Simulator::Schedule(MicroSeconds(1), &HttpPersistentClient::ProcessNextPage, this);
+       return;
+     }
+     
+     m_pageStartTime = Simulator::Now();
+     
+     // Ensure primary request is first
+     for (size_t i = 0; i < page.requests.size(); i++) {
+       if (page.requests[i].isPrimary) {
+         if (i != 0) {
+           std::swap(page.requests[0], page.requests[i]);
+         }
+         page.primaryRequestId = page.requests[0].id;
+         break;
+       }
+     }
+     
+     // Reset page state
+     page.primaryCompleted = false;
+     page.isComplete = false;
+     m_waitingForPrimary = true;
+     
+     // Clear pending requests queue
+     while (!m_pendingRequests.empty()) {
+       m_pendingRequests.pop();
+     }
+     
+     // Pooled connections carry over from the last page as they are; one
+     // still receiving a response of that page is free once it is drained
+     
+     HTTP_LOG_INFO("Starting page " << m_currentPageIndex << " with " << page.requests.size() << " requests");
+     
+     // Start with primary request
+     StartPrimaryRequest();
+     
+     // Set a timeout for the entire page
+     Simulator::Schedule(Seconds(30), &HttpPersistentClient::HandlePageTimeout, this, m_currentPageIndex);
+   }
+ 
+   void StartPrimaryRequest() {
+     if (!m_running || !m_feed.HasPage()) {
+       return;
+     }
+     
+     WebPage& page = m_feed.Current();
+     if (page.requests.empty()) return;
+     
+     HTTP_LOG_INFO("Starting primary request for page " << m_currentPageIndex);
+     
+     // Find an available connection and start the primary request
+     SendRequest(&page.requests[0]);
+   }
+ 
+   void StartSecondaryRequests() {
+     if (!m_running || !m_feed.HasPage()) {
+       return;
+     }
+     
+     WebPage& page = m_feed.Current();
+     if (page.requests.size() <= 1) return;
+     
+     HTTP_LOG_INFO("Starting " << (page.requests.size() - 1) << " secondary requests for page " << m_currentPageIndex);
+     
+     // Queue all secondary requests
+     for (size_t i = 1; i < page.requests.size(); i++) {
+       m_pendingRequests.push(&page.requests[i]);
+     }
+     
+     // Process pending requests
+     ProcessPendingRequests();
+   }
+ 
+   void ProcessPendingRequests() {
+     if (!m_running) return;
+     
+     // Try to send pending requests on available connections
+     while (!m_pendingRequests.empty()) {
+       int availableConnIndex = GetAvailableConnectionIndex();
+       if (availableConnIndex < 0) {
+         break; // No available connections
+       }
+       
+       WebRequest* req = m_pendingRequests.front();
+       m_pendingRequests.pop();
+       SendRequest(req);
+     }
+   }
+ 
+   int GetAvailableConnectionIndex() {
+     // First, look for connected but idle connections
+     for (size_t i = 0; i < m_connections.size(); i++) {
+       if (m_connections[i].isConnected && !m_connections[i].isBusy) {
+         return i;
+       }
+     }
+     
+     // If no idle connected connections, look for unconnected ones
+     for (size_t i = 0; i < m_connections.size(); i++) {
+       if (!m_connections[i].isConnected && !m_connections[i].isConnecting) {
+         return i;
+       }
+     }
+     
+     return -1; // No available connections
+   }
+ 
+   void SendRequest(WebRequest* request) {
+     int connIndex = GetAvailableConnectionIndex();
+     if (connIndex < 0) {
+       NS_LOG_WARN("No available connections, queueing request");
+       m_pendingRequests.push(request);
+       return;
+     }
+     
+     PersistentConnection& conn = m_connections[connIndex];
+     conn.currentRequest = request;
+     conn.isBusy = true;
+     conn.transport->queue = 1;
+     Simulator::Cancel(conn.idleTimer);
+     
+     if (!conn.isConnected && !conn.isConnecting) {
+       // Need to establish connection
+       ConnectToServer(connIndex);
+     } else if (conn.isConnected) {
+       // Connection already established, send request immediately
+       SendHttpRequest(connIndex);
+     }
+     // If connecting, request will be sent when connection succeeds
+   }
+ 
+   void ConnectToServer(uint32_t connIndex) {
+     HTTP_LOG_FUNCTION(this << connIndex);
+     
+     if (connIndex >= m_connections.size()) return;
+     
+     PersistentConnection& conn = m_connections[connIndex];
+     
+     if (conn.socket) {
+       CleanupConnection(conn);
+     }
+     
+     conn.isConnecting = true;
+     conn.socket = Socket::CreateSocket(GetNode(), TcpSocketFactory::GetTypeId());
+     conn.socket->Bind();
+     conn.transport->Watch(conn.socket);
+     HttpCount(HTTP_COUNTER_CONNECTIONS_OPENED);
+     
+     // Set up callbacks
+     conn.socket->SetConnectCallback(
+       MakeCallback(&HttpPersistentClient::ConnectionSucceeded, this, connIndex),
+       MakeCallback(&HttpPersistentClient::ConnectionFailed, this, connIndex)
+     );
+     conn.socket->SetRecvCallback(
+       MakeCallback(&HttpPersistentClient::HandleRead, this, connIndex)
+     );
+     conn.socket->SetCloseCallbacks(
+       MakeCallback(&HttpPersistentClient::HandleClose, this, connIndex),
+       MakeCallback(&HttpPersistentClient::HandleClose, this, connIndex)
+     );
+     
+     // Connect to server
+     conn.socket->Connect(m_serverAddress);
+     
+     HTTP_LOG_INFO("Starting connection " << connIndex << " for request " 
+                 << (conn.currentRequest ? (conn.currentRequest->isPrimary ? "[PRIMARY]" : "[SECONDARY]") : "[UNKNOWN]"));
+   }
+ 
+   void ConnectionSucceeded(uint32_t connIndex, Ptr<Socket> socket) {
+     HTTP_LOG_FUNCTION(this << connIndex);
+     
+     if (!m_running || connIndex >= m_connections.size()) return;
+     
+     PersistentConnection& conn = m_connections[connIndex];
+     
+     // Check if this connection is still valid
+     if (!conn.isConnecting || conn.socket != socket) {
+       NS_LOG_WARN("Stale connection callback for connection " << connIndex);
+       return;
+     }
+     
+     conn.isConnected = true;
+     conn.isConnecting = false;
+     
+     HTTP_LOG_INFO("Connection " << connIndex << " established");
+     
+     // Send the queued request; if its page ended while connecting, the
+     // connection joins the pool idle
+     if (conn.currentRequest) {
+       SendHttpRequest(connIndex);
+     } else {
+       ReleaseConnection(connIndex);
+     }
+   }
+ 
+   void ConnectionFailed(uint32_t connIndex, Ptr<Socket> socket) {
+     HTTP_LOG_FUNCTION(this << connIndex);
+     
+     if (!m_running || connIndex >= m_connections.size()) return;
+     
+     PersistentConnection& conn = m_connections[connIndex];
+     
+     NS_LOG_ERROR("Connection " << connIndex << " failed");
+     HttpCount(HTTP_COUNTER_CONNECTION_FAILURES);
+     
+     // Put request back in queue
+     if (conn.currentRequest) {
+       m_pendingRequests.push(conn.currentRequest);
+     }
+     
+     CleanupConnection(conn);
+     
+     // Try to process pending requests with other connections
+     Simulator::Schedule(MicroSeconds(10), &HttpPersistentClient::ProcessPendingRequests, this);
+   }
+ 
+   void SendHttpRequest(uint32_t connIndex) {
+     if (connIndex >= m_connections.size()) return;
+     
+     PersistentConnection& conn = m_connections[connIndex];
+     
+     if (!conn.currentRequest || !conn.isConnected) {
+       NS_LOG_ERROR("Cannot send request: no request or not connected");
+       return;
+     }
+     
+     WebRequest* req = conn.currentRequest;
+     req->startTime = Simulator::Now();
+     
+     // Extract path from URL (trace format: "GET path HTTP/1.0")
+     std::string path = "/";
+     std::istringstream iss(req->url);
+     std::string method, extractedPath, version;
+     if (iss >> method >> extractedPath >> version) {
+       path = extractedPath;
+     } else {
+       // Fallback: use the URL as-is if parsing fails
+       path = req->url;
+     }
+     
+     // Send HTTP/1.1 request with keep-alive
+     std::ostringstream oss;
+     oss << "GET " << path << "?size=" << req->size << HttpCacheQuery(*req) << " HTTP/1.1\r\n"
+         << "Host: example.com\r\n"
+         << "User-Agent: ns3-http-persistent-client\r\n"
+         << "Connection: keep-alive\r\n"
+         << HttpCacheHeaders(*req)
+         << "\r\n";
+     std::string request = oss.str();
+     
+     Ptr<Packet> packet = Create<Packet>((uint8_t*) request.c_str(), request.size());
+     int result = conn.socket->Send(packet);
+     
+     if (result == -1) {
+       NS_LOG_ERROR("Failed to send request");
+     } else {
+       HttpCount(HTTP_COUNTER_REQUESTS_SENT);
+       HTTP_LOG_INFO("Connection " << connIndex << " sent request for " 
+                   << req->url << " (size=" << req->size << ")"
+                   << (req->isPrimary ? " [PRIMARY]" : " [SECONDARY]"));
+     }
+     
+     // Set up expected response
+     conn.parser.Reset(req->size);
+   }
+ 
+   void HandleRead(uint32_t connIndex, Ptr<Socket> socket) {
+     HTTP_PROFILE_SCOPE(HTTP_PROFILE_CLIENT_READ);
+     HTTP_LOG_FUNCTION(this << connIndex);
+     
+     if (!m_running || connIndex >= m_connections.size()) return;
+     
+     PersistentConnection& conn = m_connections[connIndex];
+     
+     // Check if this is a stale callback
+     if (!conn.isConnected || conn.socket != socket) {
+       NS_LOG_WARN("Stale read callback for connection " << connIndex);
+       return;
+     }
+     
+     Ptr<Packet> packet;
+     Address from;
+     
+     while ((packet = socket->RecvFrom(from))) {
+       ProcessResponse(connIndex, packet);
+     }
+   }
+ 
+   void ProcessResponse(uint32_t connIndex, Ptr<Packet> packet) {
+     if (connIndex >= m_connections.size()) return;
+     
+     PersistentConnection& conn = m_connections[connIndex];
+     uint32_t used = conn.parser.Consume(packet);
+     
+     // The rest of a response whose page has already ended: drain it so the
+     // connection can be reused
+     if (!conn.currentRequest) {
+       if (conn.isBusy && conn.parser.IsComplete()) {
+         HTTP_LOG_INFO("Connection " << connIndex << " drained a response of an earlier page");
+         ReleaseConnection(connIndex);
+       }
+       return;
+     }
+     
+     HTTP_LOG_DEBUG("Connection " << connIndex << " received " << used 
+                  << " bytes (body: " << conn.parser.GetBodyBytes() 
+                  << "/" << conn.parser.GetContentLength() << ")");
+     
+     // Check if response is complete
+     if (conn.parser.IsComplete() && conn.currentRequest) {
+       conn.currentRequest->completeTime = Simulator::Now();
+       conn.currentRequest->isComplete = true;
+       Time responseTime = conn.currentRequest->completeTime - conn.currentRequest->startTime;
+       HttpCounters::Get().AddResponse(responseTime);
+       
+       bool isPrimary = conn.currentRequest->isPrimary;
+       
+       HTTP_LOG_INFO("Connection " << connIndex << " completed request in " 
+                   << responseTime.GetSeconds() << " seconds"
+                   << (isPrimary ? " [PRIMARY]" : " [SECONDARY]"));
+       
+       if (isPrimary) {
+         HandlePrimaryRequestComplete();
+       }
+       
+       // Mark connection as available for next request
+       conn.currentRequest = nullptr;
+       ReleaseConnection(connIndex);
+       
+       // Check if page is complete
+       CheckPageComplete();
+     }
+   }
+ 
+   // The connection has nothing in flight: give it the next pending request
+   // or let it idle in the pool
+   void ReleaseConnection(uint32_t connIndex) {
+     PersistentConnection& conn = m_connections[connIndex];
+     conn.isBusy = false;
+     conn.transport->queue = 0;
+     conn.parser.Reset(0);
+     
+     ProcessPendingRequests();
+     
+     if (!conn.isBusy && conn.isConnected && m_idleTimeout.IsStrictlyPositive()) {
+       Simulator::Cancel(conn.idleTimer);
+       conn.idleTimer = Simulator::Schedule(m_idleTimeout, &HttpPersistentClient::HandleIdleTimeout,
+                                            this, connIndex);
+     }
+   }
+ 
+   void HandleIdleTimeout(uint32_t connIndex) {
+     PersistentConnection& conn = m_connections[connIndex];
+     if (!m_running || conn.isBusy || !conn.isConnected) {
+       return;
+     }
+     HTTP_LOG_INFO("Connection " << connIndex << " idle for " << m_idleTimeout.GetSeconds()
+                 << " seconds, closing");
+     HttpCount(HTTP_COUNTER_IDLE_CLOSES);
+     CleanupConnection(conn);
+   }
+ 
+   void HandlePrimaryRequestComplete() {
+     if (!m_feed.HasPage()) return;
+     
+     WebPage& page = m_feed.Current();
+     page.primaryCompleted = true;
+     m_waitingForPrimary = false;
+     
+     HTTP_LOG_INFO("Primary request completed for page " << m_currentPageIndex << " - starting secondary requests");
+     
+     StartSecondaryRequests();
+   }
+ 
+   void CheckPageComplete() {
+     if (!m_feed.HasPage()) return;
+     
+     WebPage& page = m_feed.Current();
+     
+     // Count completed requests
+     uint32_t completedRequests = 0;
+     for (const auto& req : page.requests) {
+       if (!req.completeTime.IsZero()) {
+         completedRequests++;
+       }
+     }
+     
+     // Check if all requests are complete
+     if (completedRequests >= page.requests.size()) {
+       page.isComplete = true;
+       
+       // Calculate page load time
+       Time pageStartTime = Seconds(0);
+       Time pageEndTime = Seconds(0);
+       
+       // Find primary request start time
+       for (const auto& req : page.requests) {
+         if (req.isPrimary && !req.startTime.IsZero()) {
+           pageStartTime = req.startTime;
+           break;
+         }
+       }
+       
+       // Find latest completion time
+       for (const auto& req : page.requests) {
+         if (!req.completeTime.IsZero() && 
+             (pageEndTime.IsZero() || req.completeTime > pageEndTime)) {
+           pageEndTime = req.completeTime;
+         }
+       }
+       
+       if (!pageStartTime.IsZero() && !pageEndTime.IsZero()) {
+         double pageTime = (pageEndTime - pageStartTime).GetSeconds();
+         HTTP_LOG_INFO("Page " << m_currentPageIndex << " completed in " 
+                     << pageTime << " seconds (all " << completedRequests << " requests done)");
+       }
+       
+       FinishPage();
+       Simulator::Schedule(MicroSeconds(10), &HttpPersistentClient::ProcessNextPage, this);
+     }
+   }
+ 
+   // The page is done: drop every pointer still held into it and hand it
+   // to the results, which frees it
+   void FinishPage() {
+     while (!m_pendingRequests.empty()) {
+       m_pendingRequests.pop();
+     }
+     for (auto& conn : m_connections) {
+       conn.currentRequest = nullptr;
+     }
+     m_feed.Finish();
+     m_currentPageIndex++;
+   }
+ 
+   void HandlePageTimeout(uint32_t pageIndex) {
+     if (!m_running || pageIndex != m_currentPageIndex) {
+       return;
+     }
+     
+     WebPage& page = m_feed.Current();
+     
+     uint32_t completedRequests = 0;
+     for (const auto& req : page.requests) {
+       if (!req.completeTime.IsZero()) {
+         completedRequests++;
+       }
+     }
+     
+     NS_LOG_WARN("Page " << m_currentPageIndex << " timeout - only " << completedRequests 
+                 << "/" << page.requests.size() << " requests completed. Moving to next page.");
+     
+     // Mark incomplete requests as completed (for statistics)
+     for (auto& req : page.requests) {
+       if (req.completeTime.IsZero()) {
+         req.completeTime = Simulator::Now();
+         HttpCount(HTTP_COUNTER_REQUEST_TIMEOUTS);
+       }
+     }
+     
+     page.isComplete = true;
+     FinishPage();
+     Simulator::Schedule(MicroSeconds(10), &HttpPersistentClient::ProcessNextPage, this);
+   }
+ 
+   void HandleClose(uint32_t connIndex, Ptr<Socket> socket) {
+     HTTP_LOG_FUNCTION(this << connIndex);
+     
+     if (connIndex >= m_connections.size()) return;
+     
+     PersistentConnection& conn = m_connections[connIndex];
+     
+     // Check if this is a stale callback
+     if (conn.socket != socket) {
+       NS_LOG_WARN("Stale close callback for connection " << connIndex);
+       return;
+     }
+     
+     HTTP_LOG_INFO("Connection " << connIndex << " closed");
+     
+     // Put current request back in queue if it wasn't completed
+     if (conn.currentRequest && conn.currentRequest->completeTime.IsZero()) {
+       NS_LOG_WARN("Connection " << connIndex << " closed with incomplete request");
+       m_pendingRequests.push(conn.currentRequest);
+     }
+     
+     CleanupConnection(conn);
+     
+     // Try to process pending requests
+     ProcessPendingRequests();
+   }
+ 
+   bool m_running;
+   Address m_serverAddress;
+   HttpPageFeed m_feed;                        // Page being replayed, pulled from the source
+   uint32_t m_currentPageIndex;
+   std::vector<PersistentConnection> m_connections;
+   uint32_t m_maxConnections;  // Pool size, 2 connections as per RFC 2616 by default
+   Time m_idleTimeout;         // Zero keeps idle connections open
+   std::queue<WebRequest*> m_pendingRequests;
+   Time m_pageStartTime;
+   bool m_waitingForPrimary;
+   HttpTransportSampler m_sampler;
+   TracedCallback<const HttpResultsSampleRecord&> m_transportTrace;
+ };
+ 
+ // HTTP server application (same as in other versions but with keep-alive support)
+ class HttpPersistentServer : public Application {
+ public:
+   HttpPersistentServer() : m_socket(nullptr), m_running(false) {}
+   virtual ~HttpPersistentServer() {}
+ 
+   static TypeId GetTypeId() {
+     static TypeId tid = TypeId("ns3::HttpPersistentServer")
+       .SetParent<Application>()
+       .SetGroupName("Applications")
+       .AddConstructor<HttpPersistentServer>();
+     return tid;
+   }
+ 
+   void SetPort(uint16_t port) {
+     m_port = port;
+   }
+ 
+ protected:
+   virtual void DoDispose() {
+     if (m_socket) {
+       m_socket->Close();
+       m_socket = nullptr;
+     }
+     
+     m_sendQueue.CloseAll();
+     m_socketBuffers.clear();
+     
+     Application::DoDispose();
+   }
+ 
+   virtual void StartApplication() {
+     HTTP_LOG_FUNCTION(this);
+     m_running = true;
+     
+     if (!m_socket) {
+       m_socket = Socket::CreateSocket(GetNode(), TcpSocketFactory::GetTypeId());
+       InetSocketAddress local = InetSocketAddress(Ipv4Address::GetAny(), m_port);
+       m_socket->Bind(local);
+       m_socket->Listen();
+       
+       m_socket->SetAcceptCallback(
+         MakeNullCallback<bool, Ptr<Socket>, const Address &>(),
+         MakeCallback(&HttpPersistentServer::HandleAccept, this)
+       );
+     }
+     
+     HTTP_LOG_INFO("HTTP/1.1 persistent server listening on port " << m_port);
+   }
+ 
+   virtual void StopApplication() {
+     HTTP_LOG_FUNCTION(this);
+     m_running = false;
+     
+     if (m_socket) {
+       m_socket->Close();
+       m_socket = nullptr;
+     }
+     
+     m_sendQueue.CloseAll();
+     m_socketBuffers.clear();
+   }
+ 
+ private:
+   void HandleAccept(Ptr<Socket> socket, const Address& from) {
+     HTTP_LOG_FUNCTION(this << socket << from);
+     
+     socket->SetRecvCallback(MakeCallback(&HttpPersistentServer::HandleRead, this));
+     socket->SetCloseCallbacks(MakeCallback(&HttpPersistentServer::HandleClose, this),
+                               MakeCallback(&HttpPersistentServer::HandleClose, this));
+     m_sendQueue.Add(socket);
+     m_socketBuffers[PeekPointer(socket)] = "";
+     
+     HTTP_LOG_INFO("Server accepted connection from " 
+                 << InetSocketAddress::ConvertFrom(from).GetIpv4());
+   }
+   
+   // The client closed the connection or it failed: release the socket
+   void HandleClose(Ptr<Socket> socket) {
+     HTTP_LOG_FUNCTION(this << socket);
+     m_sendQueue.Remove(socket);
+     m_socketBuffers.erase(PeekPointer(socket));
+     socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+     socket->Close();
+   }
+ 
+   void HandleRead(Ptr<Socket> socket) {
+     HTTP_PROFILE_SCOPE(HTTP_PROFILE_SERVER_READ);
+     HTTP_LOG_FUNCTION(this << socket);
+     
+     Ptr<Packet> packet;
+     Address from;
+     
+     while ((packet = socket->RecvFrom(from))) {
+       uint32_t packetSize = packet->GetSize();
+       uint8_t* buffer = new uint8_t[packetSize];
+       packet->CopyData(buffer, packetSize);
+       
+       m_socketBuffers[PeekPointer(socket)].append((char*)buffer, packetSize);
+       delete[] buffer;
+       
+       ProcessRequests(socket);
+     }
+   }
+ 
+   void ProcessRequests(Ptr<Socket> socket) {
+     std::string& buffer = m_socketBuffers[PeekPointer(socket)];
+     
+     while (!buffer.empty()) {
+       size_t requestEnd = buffer.find("\r\n\r\n");
+       if (requestEnd == std::string::npos) {
+         break;
+       }
+       
+       std::string request = buffer.substr(0, requestEnd);
+       buffer.erase(0, requestEnd + 4);
+       
+       HTTP_LOG_INFO("Server processing request");
+       
+       std::istringstream iss(request);
+       std::string method, path, version;
+       if (iss >> method >> path >> version) {
+         SendResponse(socket, path, HttpRequestNotModified(request, path));
+       }
+     }
+   }
+ 
+   void SendResponse(Ptr<Socket> socket, const std::string& url, bool notModified) {
+     HTTP_PROFILE_SCOPE(HTTP_PROFILE_SEND_RESPONSE);
+     if (notModified) {
+       HttpCount(HTTP_COUNTER_NOT_MODIFIED);
+       m_sendQueue.Send(socket, HttpNotModifiedResponse("HTTP/1.1", "keep-alive"), 0);
+       return;
+     }
+     
+     uint32_t responseSize = 1024;
+     
+     size_t pos = url.find("size=");
+     if (pos != std::string::npos) {
+       try {
+         std::string sizeStr = url.substr(pos + 5);
+         size_t endPos = sizeStr.find_first_of(" \t\r\n&");
+         if (endPos != std::string::npos) {
+           sizeStr = sizeStr.substr(0, endPos);
+         }
+         responseSize = std::stoul(sizeStr);
+       } catch (const std::exception& e) {
+         NS_LOG_WARN("Invalid size in URL: " << url);
+       }
+     }
+     
+     // Send HTTP/1.1 headers with keep-alive
+     std::ostringstream header;
+     header << "HTTP/1.1 200 OK\r\n"
+            << "Content-Type: text/html\r\n"
+            << "Content-Length: " << responseSize << "\r\n"
+            << "Connection: keep-alive\r\n"
+            << "\r\n";
+     std::string headerStr = header.str();
+     
+     HTTP_LOG_INFO("Server sending response of " << responseSize << " bytes");
+     
+     // Headers, then the body as fast as the TX buffer drains
+     m_sendQueue.Send(socket, headerStr, responseSize);
+   }
+ 
+   Ptr<Socket> m_socket;
+   HttpSendQueue m_sendQueue;   // Connected sockets and their unsent responses
+   std::unordered_map<Socket*, std::string> m_socketBuffers;   // Unparsed request bytes per socket
+   uint16_t m_port;
+   bool m_running;
+ };
+
+ // Up to 2 persistent connections, no pipelining
+ class HttpPersistentMode : public HttpModeOf<HttpPersistentClient, HttpPersistentServer> {
+ public:
+   HttpPersistentMode() : m_connections(2), m_idleTimeout(0.0) {}
+ 
+   virtual std::string GetDescription() const {
+     return "HTTP/1.1 persistent";
+   }
+ 
+   virtual void AddOptions(CommandLine& cmd) {
+     cmd.AddValue("persistentConnections", "Persistent: connections kept open to the server", m_connections);
+     cmd.AddValue("persistentIdleTimeout", "Persistent: seconds before an idle connection is closed (0 = never)", m_idleTimeout);
+   }
+ 
+   virtual bool Configure(std::string& error) {
+     if (m_connections == 0) {
+       error = "--persistentConnections must be at least 1";
+       return false;
+     }
+     if (m_idleTimeout < 0.0) {
+       error = "--persistentIdleTimeout must not be negative";
+       return false;
+     }
+     return true;
+   }
+ 
+ protected:
+   virtual void ConfigureClient(Ptr<HttpPersistentClient> client) {
+     client->SetMaxConnections(m_connections);
+     client->SetIdleTimeout(Seconds(m_idleTimeout));
+   }
+ 
+ private:
+   uint32_t m_connections;
+   double m_idleTimeout;
+ };
+ 
+ HTTP_MODE_REGISTER("persistent", HttpPersistentMode);
+
+ #endif /* HTTP_PERSISTENT_H */
@@ -0,0 +1,1019 @@
+/* http-pipelined.h
+ * 
+ * HTTP/1.1 pipelined mode client and server applications for replaying UCB web trace data
+ * OPTIMIZED version that addresses head-of-line blocking and connection usage
+ *
+ * Logs through the log component of the program that includes it, which
+ * must NS_LOG_COMPONENT_DEFINE one before the include.
+ */
+
+ #ifndef HTTP_PIPELINED_H
+ #define HTTP_PIPELINED_H
+
+ #include "ns3/applications-module.h"
+ #include "ns3/core-module.h"
+ #include "ns3/internet-module.h"
+ #include "ns3/network-module.h"
+ #include "ns3/point-to-point-module.h"
+ #include <fstream>
+ #include <string>
+ #include <vector>
+ #include <iostream>
+ #include <sstream>
+ #include <map>
+ #include <unordered_map>
+ #include <queue>
+ #include <algorithm>
+ #include "http-cache.h"
+ #include "http-counters.h"
+ #include "http-log.h"
+ #include "http-parser.h"
+ #include "http-profile.h"
+ #include "http-page-source.h"
+ #include "http-results.h"
+ #include "http-sampler.h"
+ #include "http-send-queue.h"
+ #include "http-trace.h"
+ #include "http-mode.h"
+
+ using namespace ns3;
+ 
+ // Structure to track a pipelined connection - OPTIMIZED
+ struct PipelinedConnection {
+   Ptr<Socket> socket;
+   size_t index;                  // Position in the client's connection pool
+   std::queue<WebRequest*> pendingRequests;
+   std::queue<WebRequest*> sentRequests;
+   uint32_t orphanedResponses;    // Responses owed for earlier pages, ahead of sentRequests
+   uint32_t pipelinedCount;       // Requests sent and not yet answered, orphans included
+   bool isConnected;
+   bool isConnecting;
+   Address serverAddress;
+   HttpResponseParser parser;     // Response at the head of the pipeline
+   uint32_t totalPendingBytes;    // Track total bytes in pipeline
+   uint32_t outstandingBytes;     // Response bytes requested and not yet received
+   EventId idleTimer;             // Closes the connection once it has been idle too long
+   
+   // Path estimates for the pipelining depth
+   Time connectStart;
+   Time rttProbeStart;            // Request sent on an empty pipeline, waiting for its first byte
+   Time srtt;                     // Smoothed RTT, zero until the first sample
+   Time lastDelivery;             // When the last response finished
+   double deliveryRate;           // Smoothed response bytes per second, 0 until the first sample
+   
+   Ptr<HttpTcpTransport> transport;   // Socket state while it is open
+   
+   PipelinedConnection() : socket(nullptr), index(0), orphanedResponses(0), pipelinedCount(0),
+                          isConnected(false), isConnecting(false), totalPendingBytes(0),
+                          outstandingBytes(0), deliveryRate(0.0),
+                          transport(CreateObject<HttpTcpTransport>()) {}
+   
+   // The transport's queue: requests waiting or in the pipeline
+   void UpdateQueue() {
+     transport->queue = pendingRequests.size() + pipelinedCount;
+   }
+ };
+ 
+ // HTTP/1.1 pipelined client application - OPTIMIZED VERSION
+ class HttpPipelinedClient : public Application {
+ public:
+   HttpPipelinedClient() : m_running(false), m_currentPageIndex(0), 
+                          m_maxConnections(6), m_maxPipelineDepth(6), m_idleTimeout(Seconds(0)),
+                          m_pageStartTime(Seconds(0)), m_waitingForPrimary(true) {
+     m_sampler.SetTrace(&m_transportTrace);
+   }
+   virtual ~HttpPipelinedClient() {}
+ 
+   static TypeId GetTypeId() {
+     static TypeId tid = TypeId("ns3::HttpPipelinedClient")
+       .SetParent<Application>()
+       .SetGroupName("Applications")
+       .AddConstructor<HttpPipelinedClient>()
+       .AddTraceSource("TransportSample", "Each pooled connection's TCP state, every sample interval it changed",
+                       MakeTraceSourceAccessor(&HttpPipelinedClient::m_transportTrace),
+                       "ns3::HttpTransportSampler::SampleTracedCallback");
+     return tid;
+   }
+ 
+   // Pages are pulled from the source as the client gets to them
+   void SetPageSource(Ptr<HttpPageSource> source) {
+     m_feed.SetSource(source);
+   }
+ 
+   void SetServer(Address address) {
+     m_serverAddress = address;
+   }
+ 
+   void SetResults(HttpResults* results, uint32_t clientId) {
+     m_feed.SetResults(results, clientId);
+     m_sampler.SetResults(results, clientId, 0);
+   }
+ 
+   // Size of the connection pool to the server; set before the client starts
+   void SetMaxConnections(uint32_t connections) {
+     m_maxConnections = connections;
+   }
+ 
+   // Most requests outstanding on one connection, whatever the estimates say
+   void SetMaxPipelineDepth(uint32_t depth) {
+     m_maxPipelineDepth = depth;
+   }
+ 
+   // Close pooled connections that have had nothing to do for this long;
+   // zero keeps them open for the whole run
+   void SetIdleTimeout(Time timeout) {
+     m_idleTimeout = timeout;
+   }
+ 
+   // Connection i's transport state, for trace sinks; the object lasts as
+   // long as the client, so sinks can connect before it starts;
+   // call it after SetMaxConnections
+   Ptr<HttpTcpTransport> GetTransport(uint32_t connection) {
+     if (m_connections.size() < m_maxConnections) {
+       m_connections.resize(m_maxConnections);
+     }
+     if (connection >= m_connections.size()) {
+       return nullptr;
+     }
+     return m_connections[connection].transport;
+   }
+ 
+   // Report the pages the run ended before this client finished
+   void ReportRemainingPages() {
+     m_feed.FinishAll();
+   }
+ 
+ protected:
+   virtual void DoDispose() {
+     for (auto& conn : m_connections) {
+       CloseConnection(conn);
+     }
+     Application::DoDispose();
+   }
+ 
+   virtual void StartApplication() {
+     HTTP_LOG_FUNCTION(this);
+     m_running = true;
+     
+     // OPTIMIZED: Use more connections like browsers do (6 instead of 2).
+     // They open on demand and stay open across pages.
+     m_connections.resize(m_maxConnections);
+     for (size_t i = 0; i < m_connections.size(); i++) {
+       m_connections[i].index = i;
+       m_connections[i].serverAddress = m_serverAddress;
+     }
+     m_sampler.Start([this]() { SampleTransport(); });
+     
+     ProcessNextPage();
+   }
+ 
+   virtual void StopApplication() {
+     HTTP_LOG_FUNCTION(this);
+     m_running = false;
+     m_sampler.Stop();
+     
+     for (auto& conn : m_connections) {
+       CloseConnection(conn);
+     }
+   }
+ 
+ private:
+   // Closed connections are sampled too, as zeros, so a series shows the gaps
+   void SampleTransport() {
+     for (const PipelinedConnection& conn : m_connections) {
+       m_sampler.Add(conn.index, conn.transport);
+     }
+   }
+ 
+   // Close the socket without hearing back from it and forget everything
+   // that was in flight on it
+   void CloseConnection(PipelinedConnection& conn) {
+     Simulator::Cancel(conn.idleTimer);
+     if (conn.socket) {
+       conn.socket->SetConnectCallback(
+         MakeNullCallback<void, Ptr<Socket>>(),
+         MakeNullCallback<void, Ptr<Socket>>()
+       );
+       conn.socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+       conn.socket->SetCloseCallbacks(
+         MakeNullCallback<void, Ptr<Socket>>(),
+         MakeNullCallback<void, Ptr<Socket>>()
+       );
+       conn.socket->Close();
+       conn.socket = nullptr;
+     }
+     conn.transport->Unwatch();
+     conn.isConnected = false;
+     conn.isConnecting = false;
+     while (!conn.sentRequests.empty()) {
+       conn.sentRequests.pop();
+     }
+     conn.orphanedResponses = 0;
+     conn.pipelinedCount = 0;
+     conn.outstandingBytes = 0;
+     conn.totalPendingBytes = 0;
+     conn.rttProbeStart = Seconds(0);
+     conn.parser.Reset(0);
+     conn.UpdateQueue();
+   }
+ 
+   void ProcessNextPage() {
+     HTTP_PROFILE_SCOPE(HTTP_PROFILE_PROCESS_NEXT_PAGE);
+     if (!m_running || !m_feed.Next()) {
+       HTTP_LOG_INFO("Simulation complete - processed " << m_currentPageIndex << " pages");
+       return;
+     }
+     
+     WebPage& page = m_feed.Current();
+     
+     if (page.requests.empty()) {
+       NS_LOG_WARN("Empty page found at index " << m_currentPageIndex);
+       page.isComplete = true;
+       FinishPage();
+       Simulator::Schedule(MicroSeconds(1), &HttpPipelinedClient::ProcessNextPage, this);
+       return;
+     }
+     
+     m_pageStartTime = Simulator::Now();
+     
+     // Ensure primary request is first
+     for (size_t i = 0; i < page.requests.size(); i++) {
+       if (page.requests[i].isPrimary) {
+         if (i != 0) {
+           std::swap(page.requests[0], page.requests[i]);
+         }
+         page.primaryRequestId = page.requests[0].id;
+         break;
+       }
+     }
+     
+     // Reset page state
+     page.primaryCompleted = false;
+     page.isComplete = false;
+     m_waitingForPrimary = true;
+     
+     // Pooled connections carry over from the last page; responses still
+     // owed for it are drained ahead of this page's and count as load
+     for (auto& conn : m_connections) {
+       while (!conn.pendingRequests.empty()) {
+         conn.pendingRequests.pop();
+       }
+       conn.totalPendingBytes = conn.outstandingBytes;
+       conn.UpdateQueue();
+     }
+     
+     HTTP_LOG_INFO("Starting page " << m_currentPageIndex << " with " << page.requests.size() << " requests");
+     
+     // Set a timeout for the entire page
+     Simulator::Schedule(Seconds(30), &HttpPipelinedClient::HandlePageTimeout, this, m_currentPageIndex);
+     
+     StartPrimaryRequest();
+   }
+ 
+   void StartPrimaryRequest() {
+     if (!m_running || !m_feed.HasPage()) {
+       return;
+     }
+     
+     WebPage& page = m_feed.Current();
+     if (page.requests.empty()) return;
+     
+     HTTP_LOG_INFO("Starting primary request for page " << m_currentPageIndex);
+     
+     // The primary request goes on the warmest, least loaded connection
+     PipelinedConnection& conn = PickPrimaryConnection();
+     conn.pendingRequests.push(&page.requests[0]);
+     conn.totalPendingBytes += page.requests[0].GetBodySize();
+     
+     ProcessConnection(conn);
+   }
+ 
+   // An open connection with nothing in flight, else the open one owing
+   // the fewest bytes, else the first closed one
+   PipelinedConnection& PickPrimaryConnection() {
+     PipelinedConnection* best = nullptr;
+     for (auto& conn : m_connections) {
+       if (!conn.isConnected) {
+         continue;
+       }
+       if (conn.pipelinedCount == 0) {
+         return conn;
+       }
+       if (!best || conn.outstandingBytes < best->outstandingBytes) {
+         best = &conn;
+       }
+     }
+     if (best) {
+       return *best;
+     }
+     for (auto& conn : m_connections) {
+       if (!conn.isConnecting) {
+         return conn;
+       }
+     }
+     return m_connections[0];
+   }
+ 
+   // OPTIMIZED: Smart distribution of secondary requests
+   void StartSecondaryRequests() {
+     if (!m_running || !m_feed.HasPage()) {
+       return;
+     }
+     
+     WebPage& page = m_feed.Current();
+     if (page.requests.size() <= 1) return;
+     
+     HTTP_LOG_INFO("Starting " << (page.requests.size() - 1) << " secondary requests for page " << m_currentPageIndex);
+     
+     // OPTIMIZED: Sort secondary requests by size (smallest first to minimize HOL blocking)
+     std::vector<WebRequest*> secondaryRequests;
+     for (size_t i = 1; i < page.requests.size(); i++) {
+       secondaryRequests.push_back(&page.requests[i]);
+     }
+     
+     // Sort by size (ascending) to minimize head-of-line blocking
+     std::sort(secondaryRequests.begin(), secondaryRequests.end(),
+               [](WebRequest* a, WebRequest* b) { return a->size < b->size; });
+     
+     // OPTIMIZED: Distribute requests based on connection load
+     for (auto* req : secondaryRequests) {
+       // Find connection with least pending bytes (load balancing)
+       size_t bestConnIndex = 0;
+       uint32_t minPendingBytes = m_connections[0].totalPendingBytes;
+       
+       for (size_t i = 1; i < m_connections.size(); i++) {
+         if (m_connections[i].totalPendingBytes < minPendingBytes) {
+           minPendingBytes = m_connections[i].totalPendingBytes;
+           bestConnIndex = i;
+         }
+       }
+       
+       PipelinedConnection& conn = m_connections[bestConnIndex];
+       conn.pendingRequests.push(req);
+       conn.totalPendingBytes += req->GetBodySize();  // Track pending load
+     }
+     
+     // Process all connections
+     for (auto& conn : m_connections) {
+       ProcessConnection(conn);
+     }
+   }
+ 
+   void ProcessConnection(PipelinedConnection& conn) {
+     if (!m_running) return;
+     
+     if (!conn.socket || !conn.isConnected) {
+       if (!conn.isConnecting && !conn.pendingRequests.empty()) {
+         ConnectToServer(conn);
+       }
+       conn.UpdateQueue();
+       return;
+     }
+     
+     // Adaptive depth: keep about two bandwidth-delay products of response
+     // bytes requested ahead, so the next response is already on its way
+     // when one finishes, without queueing more behind a large object than
+     // the path can carry in that time
+     uint32_t target = TargetBytesInFlight(conn);
+     while (!conn.pendingRequests.empty() && conn.pipelinedCount < m_maxPipelineDepth) {
+       if (conn.pipelinedCount > 0 && conn.outstandingBytes >= target) {
+         break;
+       }
+       SendRequest(conn);
+     }
+     conn.UpdateQueue();
+   }
+ 
+   // Response bytes to keep outstanding on the connection; without
+   // estimates yet only the depth limit applies
+   uint32_t TargetBytesInFlight(const PipelinedConnection& conn) const {
+     if (conn.srtt.IsZero() || conn.deliveryRate <= 0.0) {
+       return UINT32_MAX;
+     }
+     double bdp = conn.deliveryRate * conn.srtt.GetSeconds();
+     return (uint32_t) std::min(std::max(2.0 * bdp, (double) MIN_BYTES_IN_FLIGHT), (double) UINT32_MAX);
+   }
+ 
+   // Exponentially weighted RTT and delivery rate, gain 1/8 as in TCP
+   static void UpdateRtt(PipelinedConnection& conn, Time sample) {
+     conn.srtt = conn.srtt.IsZero() ? sample : (conn.srtt * 7 + sample) / 8;
+   }
+ 
+   static void UpdateDeliveryRate(PipelinedConnection& conn, double sample) {
+     conn.deliveryRate = conn.deliveryRate <= 0.0 ? sample : (conn.deliveryRate * 7 + sample) / 8;
+   }
+ 
+   void ConnectToServer(PipelinedConnection& conn) {
+     HTTP_LOG_FUNCTION(this);
+     
+     conn.isConnecting = true;
+     conn.connectStart = Simulator::Now();
+     conn.socket = Socket::CreateSocket(GetNode(), TcpSocketFactory::GetTypeId());
+     conn.socket->Bind();
+     conn.transport->Watch(conn.socket);
+     HttpCount(HTTP_COUNTER_CONNECTIONS_OPENED);
+     size_t connIndex = conn.index;
+     
+     conn.socket->SetConnectCallback(
+       MakeCallback(&HttpPipelinedClient::ConnectionSucceeded, this, connIndex),
+       MakeCallback(&HttpPipelinedClient::ConnectionFailed, this, connIndex)
+     );
+     conn.socket->SetRecvCallback(
+       MakeCallback(&HttpPipelinedClient::HandleRead, this, connIndex)
+     );
+     conn.socket->SetCloseCallbacks(
+       MakeCallback(&HttpPipelinedClient::HandleClose, this, connIndex),
+       MakeCallback(&HttpPipelinedClient::HandleClose, this, connIndex)
+     );
+     
+     conn.socket->Connect(conn.serverAddress);
+   }
+ 
+   void ConnectionSucceeded(size_t connIndex, Ptr<Socket> socket) {
+     HTTP_LOG_FUNCTION(this << connIndex);
+     
+     if (!m_running || connIndex >= m_connections.size()) return;
+     
+     PipelinedConnection& conn = m_connections[connIndex];
+     conn.isConnected = true;
+     conn.isConnecting = false;
+     
+     // The handshake is the first RTT sample
+     UpdateRtt(conn, Simulator::Now() - conn.connectStart);
+     
+     HTTP_LOG_INFO("Connection " << connIndex << " established");
+     
+     ProcessConnection(conn);
+     ReleaseIfIdle(conn);
+   }
+ 
+   void ConnectionFailed(size_t connIndex, Ptr<Socket> socket) {
+     HTTP_LOG_FUNCTION(this << connIndex);
+     
+     if (!m_running || connIndex >= m_connections.size()) return;
+     
+     PipelinedConnection& conn = m_connections[connIndex];
+     if (conn.socket != socket) {
+       return;
+     }
+     
+     NS_LOG_ERROR("Connection " << connIndex << " failed");
+     HttpCount(HTTP_COUNTER_CONNECTION_FAILURES);
+     
+     std::vector<WebRequest*> failedRequests;
+     while (!conn.pendingRequests.empty()) {
+       failedRequests.push_back(conn.pendingRequests.front());
+       conn.pendingRequests.pop();
+     }
+     
+     // Tear the failed socket down first, so that a reconnect below gets a
+     // socket of its own
+     CloseConnection(conn);
+     conn.UpdateQueue();
+     
+     if (failedRequests.empty()) {
+       return;
+     }
+     
+     // OPTIMIZED: Better request redistribution to the least loaded of the
+     // other connections; with no other connection they stay on this one,
+     // which reconnects
+     HTTP_LOG_INFO("Redistributing " << failedRequests.size() << " pending requests");
+     for (auto* req : failedRequests) {
+       size_t bestConnIndex = connIndex;
+       uint32_t minPendingBytes = UINT32_MAX;
+       
+       for (size_t i = 0; i < m_connections.size(); i++) {
+         if (i != connIndex && m_connections[i].totalPendingBytes < minPendingBytes) {
+           minPendingBytes = m_connections[i].totalPendingBytes;
+           bestConnIndex = i;
+         }
+       }
+       
+       m_connections[bestConnIndex].pendingRequests.push(req);
+       m_connections[bestConnIndex].totalPendingBytes += req->GetBodySize();
+     }
+     
+     for (auto& other : m_connections) {
+       ProcessConnection(other);
+     }
+   }
+ 
+   void SendRequest(PipelinedConnection& conn) {
+     if (conn.pendingRequests.empty() || !conn.isConnected) {
+       return;
+     }
+     
+     WebRequest* req = conn.pendingRequests.front();
+     conn.pendingRequests.pop();
+     Simulator::Cancel(conn.idleTimer);
+     
+     // The first byte of a response to an idle pipeline is one RTT away
+     if (conn.pipelinedCount == 0) {
+       conn.rttProbeStart = Simulator::Now();
+     }
+     conn.sentRequests.push(req);
+     conn.pipelinedCount++;
+     conn.outstandingBytes += req->GetBodySize();
+     
+     req->startTime = Simulator::Now();
+     
+     // Extract path from URL
+     std::string path = req->url;
+     std::istringstream iss(req->url);
+     std::string method, extractedPath, version;
+     if (iss >> method >> extractedPath >> version) {
+       path = extractedPath;
+     }
+     
+     // Send HTTP/1.1 request with keep-alive
+     std::ostringstream oss;
+     oss << "GET " << path << "?size=" << req->size << HttpCacheQuery(*req) << " HTTP/1.1\r\n"
+         << "Host: example.com\r\n"
+         << "User-Agent: ns3-http-pipelined-client\r\n"
+         << "Connection: keep-alive\r\n"
+         << HttpCacheHeaders(*req)
+         << "\r\n";
+     std::string request = oss.str();
+     
+     Ptr<Packet> packet = Create<Packet>((uint8_t*) request.c_str(), request.size());
+     int result = conn.socket->Send(packet);
+     
+     if (result == -1) {
+       NS_LOG_ERROR("Failed to send request for " << req->url);
+     } else {
+       HttpCount(HTTP_COUNTER_REQUESTS_SENT);
+       HTTP_LOG_INFO("Sent pipelined request (pipeline depth: " << conn.pipelinedCount 
+                   << ") for " << req->url << " (size=" << req->size << ")"
+                   << (req->isPrimary ? " [PRIMARY]" : " [SECONDARY]"));
+     }
+   }
+ 
+   void HandleRead(size_t connIndex, Ptr<Socket> socket) {
+     HTTP_PROFILE_SCOPE(HTTP_PROFILE_CLIENT_READ);
+     HTTP_LOG_FUNCTION(this << connIndex);
+     
+     if (!m_running || connIndex >= m_connections.size()) return;
+     
+     PipelinedConnection& conn = m_connections[connIndex];
+     
+     if (!conn.rttProbeStart.IsZero()) {
+       UpdateRtt(conn, Simulator::Now() - conn.rttProbeStart);
+       conn.rttProbeStart = Seconds(0);
+     }
+     
+     Ptr<Packet> packet;
+     Address from;
+     
+     while ((packet = socket->RecvFrom(from))) {
+       ProcessResponses(conn, packet);
+     }
+   }
+ 
+   // A packet can hold the tail of one response and the start of the next,
+   // so walk it with an offset
+   void ProcessResponses(PipelinedConnection& conn, Ptr<Packet> packet) {
+     uint32_t offset = 0;
+     
+     while (conn.orphanedResponses > 0 || !conn.sentRequests.empty()) {
+       bool wasInHeader = conn.parser.InHeader();
+       offset += conn.parser.Consume(packet, offset);
+       
+       if (wasInHeader && !conn.parser.InHeader()) {
+         HTTP_LOG_DEBUG("Parsed headers, expecting " << conn.parser.GetContentLength() << " bytes of content");
+       }
+       
+       if (!conn.parser.IsComplete()) {
+         break;
+       }
+       uint32_t responseBytes = conn.parser.GetContentLength();
+       conn.parser.Reset(0);
+       conn.pipelinedCount--;
+       conn.outstandingBytes -= std::min(conn.outstandingBytes, responseBytes);
+       conn.totalPendingBytes -= std::min(conn.totalPendingBytes, responseBytes);
+       
+       // A response of a page that already ended only frees its slot
+       if (conn.orphanedResponses > 0) {
+         conn.orphanedResponses--;
+         conn.lastDelivery = Simulator::Now();
+         HTTP_LOG_INFO("Drained a response of an earlier page (pipeline depth now: "
+                     << conn.pipelinedCount << ")");
+         ProcessConnection(conn);
+         ReleaseIfIdle(conn);
+         continue;
+       }
+       
+       WebRequest* req = conn.sentRequests.front();
+       conn.sentRequests.pop();
+       req->completeTime = Simulator::Now();
+       req->isComplete = true;
+       HttpCounters::Get().AddResponse(req->completeTime - req->startTime);
+       
+       // Delivery rate over the time this response had the connection
+       // to itself: from its request, or from the previous response if
+       // that finished later
+       Time busyStart = std::max(req->startTime, conn.lastDelivery);
+       if (req->completeTime > busyStart) {
+         UpdateDeliveryRate(conn, responseBytes / (req->completeTime - busyStart).GetSeconds());
+       }
+       conn.lastDelivery = req->completeTime;
+       
+       Time responseTime = req->completeTime - req->startTime;
+       HTTP_LOG_INFO("Request completed in " << responseTime.GetSeconds() 
+                   << " seconds (pipeline depth now: " << conn.pipelinedCount << ")"
+                   << (req->isPrimary ? " [PRIMARY]" : " [SECONDARY]"));
+       
+       if (req->isPrimary) {
+         HandlePrimaryRequestComplete();
+       }
+       
+       ProcessConnection(conn);
+       CheckPageComplete();
+       ReleaseIfIdle(conn);
+     }
+   }
+ 
+   // A connection with nothing left to send or receive idles in the pool
+   // until the idle timeout closes it
+   void ReleaseIfIdle(PipelinedConnection& conn) {
+     if (!m_idleTimeout.IsStrictlyPositive() || !conn.isConnected || conn.pipelinedCount > 0 ||
+         !conn.pendingRequests.empty() || conn.idleTimer.IsPending()) {
+       return;
+     }
+     conn.idleTimer = Simulator::Schedule(m_idleTimeout, &HttpPipelinedClient::HandleIdleTimeout,
+                                          this, conn.index);
+   }
+ 
+   void HandleIdleTimeout(size_t connIndex) {
+     PipelinedConnection& conn = m_connections[connIndex];
+     if (!m_running || !conn.isConnected || conn.pipelinedCount > 0 || !conn.pendingRequests.empty()) {
+       return;
+     }
+     HTTP_LOG_INFO("Connection " << connIndex << " idle for " << m_idleTimeout.GetSeconds()
+                 << " seconds, closing");
+     HttpCount(HTTP_COUNTER_IDLE_CLOSES);
+     CloseConnection(conn);
+   }
+ 
+   void HandlePrimaryRequestComplete() {
+     if (!m_feed.HasPage()) return;
+     
+     WebPage& page = m_feed.Current();
+     page.primaryCompleted = true;
+     m_waitingForPrimary = false;
+     
+     HTTP_LOG_INFO("Primary request completed for page " << m_currentPageIndex << " - starting secondary requests");
+     
+     StartSecondaryRequests();
+   }
+ 
+   void CheckPageComplete() {
+     if (!m_feed.HasPage()) return;
+     
+     WebPage& page = m_feed.Current();
+     
+     uint32_t completedRequests = 0;
+     for (const auto& req : page.requests) {
+       if (!req.completeTime.IsZero()) {
+         completedRequests++;
+       }
+     }
+     
+     if (completedRequests >= page.requests.size()) {
+       page.isComplete = true;
+       
+       Time pageStartTime = Seconds(0);
+       Time pageEndTime = Seconds(0);
+       
+       for (const auto& req : page.requests) {
+         if (req.isPrimary && !req.startTime.IsZero()) {
+           pageStartTime = req.startTime;
+           break;
+         }
+       }
+       
+       for (const auto& req : page.requests) {
+         if (!req.completeTime.IsZero() && 
+             (pageEndTime.IsZero() || req.completeTime > pageEndTime)) {
+           pageEndTime = req.completeTime;
+         }
+       }
+       
+       if (!pageStartTime.IsZero() && !pageEndTime.IsZero()) {
+         double pageTime = (pageEndTime - pageStartTime).GetSeconds();
+         HTTP_LOG_INFO("Page " << m_currentPageIndex << " completed in " 
+                     << pageTime << " seconds (all " << completedRequests << " requests done)");
+       }
+       
+       FinishPage();
+       Simulator::Schedule(MicroSeconds(10), &HttpPipelinedClient::ProcessNextPage, this);
+     }
+   }
+ 
+   // The page is done: drop every pointer still held into it and hand it
+   // to the results, which frees it
+   void FinishPage() {
+     for (auto& conn : m_connections) {
+       while (!conn.pendingRequests.empty()) {
+         conn.pendingRequests.pop();
+       }
+       conn.UpdateQueue();
+       // Responses still on their way keep the connection busy until they
+       // are drained
+       conn.orphanedResponses += conn.sentRequests.size();
+       while (!conn.sentRequests.empty()) {
+         conn.sentRequests.pop();
+       }
+     }
+     m_feed.Finish();
+     m_currentPageIndex++;
+   }
+ 
+   void HandlePageTimeout(uint32_t pageIndex) {
+     if (!m_running || pageIndex != m_currentPageIndex) {
+       return;
+     }
+     
+     WebPage& page = m_feed.Current();
+     
+     uint32_t completedRequests = 0;
+     for (const auto& req : page.requests) {
+       if (!req.completeTime.IsZero()) {
+         completedRequests++;
+       }
+     }
+     
+     NS_LOG_WARN("Page " << m_currentPageIndex << " timeout - only " << completedRequests 
+                 << "/" << page.requests.size() << " requests completed. Moving to next page.");
+     
+     for (auto& req : page.requests) {
+       if (req.completeTime.IsZero()) {
+         req.completeTime = Simulator::Now();
+         HttpCount(HTTP_COUNTER_REQUEST_TIMEOUTS);
+       }
+     }
+     
+     page.isComplete = true;
+     FinishPage();
+     Simulator::Schedule(MicroSeconds(10), &HttpPipelinedClient::ProcessNextPage, this);
+   }
+ 
+   void HandleClose(size_t connIndex, Ptr<Socket> socket) {
+     HTTP_LOG_FUNCTION(this << connIndex);
+     
+     if (connIndex >= m_connections.size()) return;
+     
+     PipelinedConnection& conn = m_connections[connIndex];
+     if (conn.socket != socket) {
+       return;
+     }
+     
+     // Requests of this page that were sent but not answered go back in
+     // front of the ones still waiting, to be sent again on a new connection
+     std::queue<WebRequest*> unanswered;
+     uint32_t unansweredBytes = 0;
+     for (std::queue<WebRequest*>* requests : {&conn.sentRequests, &conn.pendingRequests}) {
+       while (!requests->empty()) {
+         unanswered.push(requests->front());
+         unansweredBytes += requests->front()->GetBodySize();
+         requests->pop();
+       }
+     }
+     CloseConnection(conn);
+     conn.pendingRequests.swap(unanswered);
+     conn.totalPendingBytes = unansweredBytes;
+     
+     HTTP_LOG_INFO("Connection " << connIndex << " closed");
+     ProcessConnection(conn);
+   }
+ 
+   bool m_running;
+   Address m_serverAddress;
+   HttpPageFeed m_feed;                        // Page being replayed, pulled from the source
+   uint32_t m_currentPageIndex;
+   std::vector<PipelinedConnection> m_connections;
+   // Floor on the adaptive pipelining target: two full segments
+   static const uint32_t MIN_BYTES_IN_FLIGHT = 2920;
+   
+   uint32_t m_maxConnections;    // Pool size, 6 connections by default
+   uint32_t m_maxPipelineDepth;  // Cap on the adaptive depth
+   Time m_idleTimeout;           // Zero keeps idle connections open
+   Time m_pageStartTime;
+   bool m_waitingForPrimary;
+   HttpTransportSampler m_sampler;
+   TracedCallback<const HttpResultsSampleRecord&> m_transportTrace;
+ };
+
+// Server implementation (same as before)
+class HttpPipelinedServer : public Application {
+public:
+  HttpPipelinedServer() : m_socket(nullptr), m_running(false) {}
+  virtual ~HttpPipelinedServer() {}
+
+  static TypeId GetTypeId() {
+    static TypeId tid = TypeId("ns3::HttpPipelinedServer")
+      .SetParent<Application>()
+      .SetGroupName("Applications")
+      .AddConstructor<HttpPipelinedServer>();
+    return tid;
+  }
+
+  void SetPort(uint16_t port) {
+    m_port = port;
+  }
+
+protected:
+  virtual void DoDispose() {
+    if (m_socket) {
+      m_socket->Close();
+      m_socket = nullptr;
+    }
+    
+    m_sendQueue.CloseAll();
+    m_socketBuffers.clear();
+    
+    Application::DoDispose();
+  }
+
+  virtual void StartApplication() {
+    HTTP_LOG_FUNCTION(this);
+    m_running = true;
+    
+    if (!m_socket) {
+      m_socket = Socket::CreateSocket(GetNode(), TcpSocketFactory::GetTypeId());
+      InetSocketAddress local = InetSocketAddress(Ipv4Address::GetAny(), m_port);
+      m_socket->Bind(local);
+      m_socket->Listen();
+      
+      m_socket->SetAcceptCallback(
+        MakeNullCallback<bool, Ptr<Socket>, const Address &>(),
+        MakeCallback(&HttpPipelinedServer::HandleAccept, this)
+      );
+    }
+    
+    HTTP_LOG_INFO("HTTP/1.1 server listening on port " << m_port);
+  }
+
+  virtual void StopApplication() {
+    HTTP_LOG_FUNCTION(this);
+    m_running = false;
+    
+    if (m_socket) {
+      m_socket->Close();
+      m_socket = nullptr;
+    }
+    
+    m_sendQueue.CloseAll();
+    m_socketBuffers.clear();
+  }
+
+private:
+  void HandleAccept(Ptr<Socket> socket, const Address& from) {
+    HTTP_LOG_FUNCTION(this << socket << from);
+    
+    socket->SetRecvCallback(MakeCallback(&HttpPipelinedServer::HandleRead, this));
+    socket->SetCloseCallbacks(MakeCallback(&HttpPipelinedServer::HandleClose, this),
+                              MakeCallback(&HttpPipelinedServer::HandleClose, this));
+    m_sendQueue.Add(socket);
+    m_socketBuffers[PeekPointer(socket)] = "";
+    
+    HTTP_LOG_INFO("Server accepted connection from " 
+                << InetSocketAddress::ConvertFrom(from).GetIpv4());
+  }
+  
+  // The client closed the connection or it failed: release the socket
+  void HandleClose(Ptr<Socket> socket) {
+    HTTP_LOG_FUNCTION(this << socket);
+    m_sendQueue.Remove(socket);
+    m_socketBuffers.erase(PeekPointer(socket));
+    socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+    socket->Close();
+  }
+
+  void HandleRead(Ptr<Socket> socket) {
+    HTTP_PROFILE_SCOPE(HTTP_PROFILE_SERVER_READ);
+    HTTP_LOG_FUNCTION(this << socket);
+    
+    Ptr<Packet> packet;
+    Address from;
+    
+    while ((packet = socket->RecvFrom(from))) {
+      uint32_t packetSize = packet->GetSize();
+      uint8_t* buffer = new uint8_t[packetSize];
+      packet->CopyData(buffer, packetSize);
+      
+      m_socketBuffers[PeekPointer(socket)].append((char*)buffer, packetSize);
+      delete[] buffer;
+      
+      ProcessRequests(socket);
+    }
+  }
+
+  void ProcessRequests(Ptr<Socket> socket) {
+    std::string& buffer = m_socketBuffers[PeekPointer(socket)];
+    
+    while (!buffer.empty()) {
+      size_t requestEnd = buffer.find("\r\n\r\n");
+      if (requestEnd == std::string::npos) {
+        break;
+      }
+      
+      std::string request = buffer.substr(0, requestEnd);
+      buffer.erase(0, requestEnd + 4);
+      
+      HTTP_LOG_INFO("Server processing request");
+      
+      std::istringstream iss(request);
+      std::string method, path, version;
+      if (iss >> method >> path >> version) {
+        SendResponse(socket, path, HttpRequestNotModified(request, path));
+      }
+    }
+  }
+
+  void SendResponse(Ptr<Socket> socket, const std::string& url, bool notModified) {
+    HTTP_PROFILE_SCOPE(HTTP_PROFILE_SEND_RESPONSE);
+    if (notModified) {
+      HttpCount(HTTP_COUNTER_NOT_MODIFIED);
+      m_sendQueue.Send(socket, HttpNotModifiedResponse("HTTP/1.1", "keep-alive"), 0);
+      return;
+    }
+    
+    uint32_t responseSize = 1024;
+    
+    size_t pos = url.find("size=");
+    if (pos != std::string::npos) {
+      try {
+        std::string sizeStr = url.substr(pos + 5);
+        size_t endPos = sizeStr.find_first_of(" \t\r\n&");
+        if (endPos != std::string::npos) {
+          sizeStr = sizeStr.substr(0, endPos);
+        }
+        responseSize = std::stoul(sizeStr);
+      } catch (const std::exception& e) {
+        NS_LOG_WARN("Invalid size in URL: " << url);
+      }
+    }
+    
+    std::ostringstream header;
+    header << "HTTP/1.1 200 OK\r\n"
+           << "Content-Type: text/html\r\n"
+           << "Content-Length: " << responseSize << "\r\n"
+           << "Connection: keep-alive\r\n"
+           << "\r\n";
+    std::string headerStr = header.str();
+    
+    m_sendQueue.Send(socket, headerStr, responseSize);
+    HTTP_LOG_INFO("Server queued response of " << responseSize << " bytes");
+  }
+
+  Ptr<Socket> m_socket;
+  HttpSendQueue m_sendQueue;   // Connected sockets and their unsent responses
+  std::unordered_map<Socket*, std::string> m_socketBuffers;   // Unparsed request bytes per socket
+  uint16_t m_port;
+  bool m_running;
+};
+
+ // Persistent connections with pipelined requests
+ class HttpPipelinedMode : public HttpModeOf<HttpPipelinedClient, HttpPipelinedServer> {
+ public:
+   HttpPipelinedMode() : m_connections(6), m_depth(6), m_idleTimeout(0.0) {}
+ 
+   virtual std::string GetDescription() const {
+     return "HTTP/1.1 pipelined";
+   }
+ 
+   virtual void AddOptions(CommandLine& cmd) {
+     cmd.AddValue("pipelinedConnections", "Pipelined: connections kept open to the server", m_connections);
+     cmd.AddValue("pipelineDepth", "Pipelined: most requests outstanding per connection", m_depth);
+     cmd.AddValue("pipelinedIdleTimeout", "Pipelined: seconds before an idle connection is closed (0 = never)", m_idleTimeout);
+   }
+ 
+   virtual bool Configure(std::string& error) {
+     if (m_connections == 0 || m_depth == 0) {
+       error = "--pipelinedConnections and --pipelineDepth must be at least 1";
+       return false;
+     }
+     if (m_idleTimeout < 0.0) {
+       error = "--pipelinedIdleTimeout must not be negative";
+       return false;
+     }
+     return true;
+   }
+ 
+ protected:
+   virtual void ConfigureClient(Ptr<HttpPipelinedClient> client) {
+     client->SetMaxConnections(m_connections);
+     client->SetMaxPipelineDepth(m_depth);
+     client->SetIdleTimeout(Seconds(m_idleTimeout));
+   }
+ 
+ private:
+   uint32_t m_connections;
+   uint32_t m_depth;
+   double m_idleTimeout;
+ };
+ 
+ HTTP_MODE_REGISTER("pipelined", HttpPipelinedMode);
+
+ #endif /* HTTP_PIPELINED_H */
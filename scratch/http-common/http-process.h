@@ -0,0 +1,153 @@
+/* http-process.h
+ *
+ * Running the simulation programs as child processes, shared by the
+ * sweep (http-sweep.cc) and benchmark (http-bench.cc) drivers: where the
+ * simulation program lives, launching it with its output in a run
+ * directory, and reading the summary it printed back.
+ */
+
+ #ifndef HTTP_PROCESS_H
+ #define HTTP_PROCESS_H
+
+ #include <sys/stat.h>
+ #include <sys/types.h>
+ #include <fcntl.h>
+ #include <unistd.h>
+ #include <algorithm>
+ #include <cerrno>
+ #include <climits>
+ #include <cstdio>
+ #include <cstdlib>
+ #include <cstring>
+ #include <ctime>
+ #include <fstream>
+ #include <iostream>
+ #include <string>
+ #include <vector>
+
+ // Summary lines printed by PrintRunStats() (http-stats.h) and
+ // HttpCounters::Print() (http-counters.h)
+ struct HttpRunSummary {
+   double avgPageTimeMs;
+   uint32_t completedPages;
+   uint32_t totalPages;
+   double avgRequestTime;
+   uint32_t completedRequests;
+   uint64_t simulatorEvents;
+
+   HttpRunSummary() : avgPageTimeMs(0.0), completedPages(0), totalPages(0),
+                      avgRequestTime(0.0), completedRequests(0), simulatorEvents(0) {}
+ };
+
+ class HttpProcess {
+ public:
+   // Every HTTP mode runs in the one simulation driver, selected with
+   // --mode=<mode> (http-trace-simulation.cc)
+   static std::string GetProgram() {
+     return "http-trace-simulation";
+   }
+
+   static const std::vector<std::string>& GetModes() {
+     static const std::vector<std::string> modes = {
+       "serial", "parallel", "persistent", "pipelined", "sst"
+     };
+     return modes;
+   }
+
+   static bool IsMode(const std::string& mode) {
+     return std::find(GetModes().begin(), GetModes().end(), mode) != GetModes().end();
+   }
+
+   // The simulation program is built next to the driver, e.g. self
+   // "http-sweep" maps build/scratch/ns3.44-http-sweep-default to
+   // ns3.44-http-trace-simulation-default
+   static std::string ProgramPath(const std::string& self, const std::string& program) {
+     char exe[PATH_MAX];
+     ssize_t n = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+     if (n <= 0) {
+       return program;
+     }
+     std::string path(exe, n);
+     size_t pos = path.rfind(self);
+     if (pos == std::string::npos || path.find('/', pos) != std::string::npos) {
+       return path.substr(0, path.rfind('/') + 1) + program;
+     }
+     return path.replace(pos, self.size(), program);
+   }
+
+   static bool MakeDirectory(const std::string& dir) {
+     return mkdir(dir.c_str(), 0755) == 0 || errno == EEXIST;
+   }
+
+   static std::string AbsolutePath(const std::string& path) {
+     char resolved[PATH_MAX];
+     if (!path.empty() && realpath(path.c_str(), resolved)) {
+       return resolved;
+     }
+     return path;
+   }
+
+   static double WallClock() {
+     struct timespec ts;
+     clock_gettime(CLOCK_MONOTONIC, &ts);
+     return ts.tv_sec + ts.tv_nsec * 1e-9;
+   }
+
+   // Fork and exec args[0] in dir with its stdout/stderr in <dir>/run.log;
+   // returns the child's pid, or -1 if the fork failed
+   static pid_t Launch(std::vector<std::string> args, const std::string& dir) {
+     std::vector<char*> argv;
+     for (std::string& arg : args) {
+       argv.push_back(&arg[0]);
+     }
+     argv.push_back(nullptr);
+
+     pid_t pid = fork();
+     if (pid != 0) {
+       return pid;
+     }
+
+     // Child
+     std::string log = dir + "/run.log";
+     int fd = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+     if (fd < 0 || chdir(dir.c_str()) != 0) {
+       _exit(126);
+     }
+     dup2(fd, STDOUT_FILENO);
+     dup2(fd, STDERR_FILENO);
+     close(fd);
+     execv(argv[0], argv.data());
+     std::cerr << "Error: could not run " << argv[0] << ": " << strerror(errno) << std::endl;
+     _exit(127);
+   }
+
+   static HttpRunSummary ParseRunLog(const std::string& log) {
+     HttpRunSummary summary;
+     std::ifstream in(log);
+     std::string line;
+     bool pageTotals = false;
+     while (std::getline(in, line)) {
+       if (sscanf(line.c_str(), "Average page load time: %lf ms", &summary.avgPageTimeMs) == 1) {
+         continue;
+       }
+       if (!pageTotals &&
+           sscanf(line.c_str(), "Completed %u out of %u pages", &summary.completedPages,
+                  &summary.totalPages) == 2) {
+         pageTotals = true;
+         continue;
+       }
+       if (sscanf(line.c_str(), "Average request time: %lf seconds", &summary.avgRequestTime) == 1) {
+         continue;
+       }
+       unsigned long long events;
+       if (sscanf(line.c_str(), " simulator events: %llu", &events) == 1) {
+         summary.simulatorEvents = events;
+         continue;
+       }
+       sscanf(line.c_str(), "Completed %u requests", &summary.completedRequests);
+     }
+     return summary;
+   }
+ };
+
+ #endif /* HTTP_PROCESS_H */
@@ -0,0 +1,172 @@
+/* http-profile.h
+ *
+ * Optional wall-clock profile of where a run's time goes. HTTP_PROFILE_SCOPE
+ * times the rest of the enclosing block and charges it to one of the
+ * scopes below: the trace load and the simulation run of the driver, and
+ * the application callbacks of every mode. Callback scopes nest, e.g. the
+ * SST congestion control inside ProcessSstPacket inside HandleRead; each
+ * one's time includes the scopes inside it, and only the outermost one
+ * counts towards the time spent in application code, so the rest of the
+ * simulation's time is ns-3 itself (TCP, queues, devices, the scheduler).
+ *
+ * The counters are per thread, so nothing is shared or locked. The driver
+ * prints and zeroes them from a Simulator::ScheduleDestroy event, i.e. at
+ * Simulator::Destroy() after each mode. Next to them it prints the
+ * simulator's event count and how many of those events called into the
+ * applications; ns-3 events carry no type, so that split (and the time
+ * spent outside the callbacks) is the breakdown it offers.
+ *
+ * Profiling is compiled out unless HTTP_PROFILE is 1, e.g.
+ *   CXXFLAGS="-DHTTP_PROFILE=1" ./ns3 configure ...
+ * Without it every HTTP_PROFILE_* macro expands to nothing.
+ */
+
+ #ifndef HTTP_PROFILE_H
+ #define HTTP_PROFILE_H
+
+ #include "ns3/simulator.h"
+ #include <chrono>
+ #include <cstdint>
+ #include <iostream>
+ #include <string>
+
+ #ifndef HTTP_PROFILE
+ #define HTTP_PROFILE 0
+ #endif
+
+ enum HttpProfileScope {
+   // Driver phases
+   HTTP_PROFILE_TRACE_LOAD,            // Counted towards the first mode
+   HTTP_PROFILE_RUN,                   // Simulator::Run
+   // Application callbacks
+   HTTP_PROFILE_CLIENT_READ,           // Client HandleRead
+   HTTP_PROFILE_SERVER_READ,           // Server HandleRead
+   HTTP_PROFILE_PROCESS_NEXT_PAGE,
+   HTTP_PROFILE_SEND_RESPONSE,         // TCP SendResponse, SST SendPendingData
+   HTTP_PROFILE_SEND_QUEUE,            // HttpSendQueue draining into a socket
+   HTTP_PROFILE_PROCESS_SST_PACKET,
+   HTTP_PROFILE_CREATE_SST_PACKET,
+   HTTP_PROFILE_CONGESTION_CONTROL,    // SST UpdateCongestionControl
+   HTTP_PROFILE_RETRANSMISSION_TIMEOUT,
+   HTTP_PROFILE_SCOPE_COUNT
+ };
+
+ class HttpProfile {
+ public:
+   static const uint32_t FIRST_CALLBACK = HTTP_PROFILE_CLIENT_READ;
+
+   static HttpProfile& Get() {
+     thread_local HttpProfile profile;
+     return profile;
+   }
+
+   // Callback scopes report their entry so that only the outermost one
+   // counts as application time
+   bool Enter(HttpProfileScope scope) {
+     return scope >= FIRST_CALLBACK && m_depth++ == 0;
+   }
+
+   void Leave(HttpProfileScope scope, bool outermost, uint64_t nanoseconds) {
+     m_calls[scope]++;
+     m_nanoseconds[scope] += nanoseconds;
+     if (scope >= FIRST_CALLBACK) {
+       m_depth--;
+     }
+     if (outermost) {
+       m_outermostCalls++;
+       m_callbackNanoseconds += nanoseconds;
+     }
+   }
+
+   void Print(std::ostream& os, const std::string& label, uint64_t simulatorEvents) const {
+     static const char* const names[HTTP_PROFILE_SCOPE_COUNT] = {
+       "trace load", "simulation",
+       "client HandleRead", "server HandleRead", "ProcessNextPage", "SendResponse/SendPendingData",
+       "send queue", "ProcessSstPacket", "CreateSstPacket", "UpdateCongestionControl",
+       "retransmission timeout"
+     };
+
+     os << "\nProfile" << label << " (wall clock):" << std::endl;
+     for (uint32_t i = 0; i < HTTP_PROFILE_SCOPE_COUNT; i++) {
+       if (m_calls[i] == 0) {
+         continue;
+       }
+       if (i == FIRST_CALLBACK) {
+         os << "Application callbacks:" << std::endl;
+       }
+       os << "  " << names[i] << ": " << Milliseconds(m_nanoseconds[i]) << " ms";
+       if (i >= FIRST_CALLBACK) {
+         os << " in " << m_calls[i] << " calls, " << (double) m_nanoseconds[i] / m_calls[i] << " ns each";
+       }
+       os << std::endl;
+     }
+
+     // What the simulation spent outside the outermost callbacks was ns-3's
+     os << "Simulator events: " << simulatorEvents << ", " << m_outermostCalls
+        << " of them into application code" << std::endl;
+     if (m_calls[HTTP_PROFILE_RUN] > 0) {
+       uint64_t run = m_nanoseconds[HTTP_PROFILE_RUN];
+       uint64_t ns3 = run > m_callbackNanoseconds ? run - m_callbackNanoseconds : 0;
+       os << "  application: " << Milliseconds(m_callbackNanoseconds) << " ms, ns-3: "
+          << Milliseconds(ns3) << " ms" << std::endl;
+     }
+   }
+
+   void Reset() {
+     *this = HttpProfile();
+   }
+
+ private:
+   HttpProfile() : m_calls(), m_nanoseconds(), m_depth(0), m_outermostCalls(0), m_callbackNanoseconds(0) {}
+
+   static double Milliseconds(uint64_t nanoseconds) {
+     return nanoseconds / 1e6;
+   }
+
+   uint64_t m_calls[HTTP_PROFILE_SCOPE_COUNT];
+   uint64_t m_nanoseconds[HTTP_PROFILE_SCOPE_COUNT];
+   uint32_t m_depth;                   // Callback scopes currently entered
+   uint64_t m_outermostCalls;
+   uint64_t m_callbackNanoseconds;     // Time in the outermost callback scopes
+ };
+
+ // Times its lifetime into the profile
+ class HttpProfileTimer {
+ public:
+   explicit HttpProfileTimer(HttpProfileScope scope)
+     : m_scope(scope), m_outermost(HttpProfile::Get().Enter(scope)),
+       m_start(std::chrono::steady_clock::now()) {}
+
+   ~HttpProfileTimer() {
+     auto elapsed = std::chrono::steady_clock::now() - m_start;
+     HttpProfile::Get().Leave(m_scope, m_outermost,
+                              std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+   }
+
+   HttpProfileTimer(const HttpProfileTimer&) = delete;
+   HttpProfileTimer& operator=(const HttpProfileTimer&) = delete;
+
+ private:
+   HttpProfileScope m_scope;
+   bool m_outermost;
+   std::chrono::steady_clock::time_point m_start;
+ };
+
+ // Print this thread's profile (label e.g. " of rank 1") and start over
+ inline void HttpProfileDump(std::string label) {
+   HttpProfile::Get().Print(std::cout, label, ns3::Simulator::GetEventCount());
+   HttpProfile::Get().Reset();
+ }
+
+ #if HTTP_PROFILE
+ #define HTTP_PROFILE_CONCAT_(a, b) a##b
+ #define HTTP_PROFILE_CONCAT(a, b) HTTP_PROFILE_CONCAT_(a, b)
+ #define HTTP_PROFILE_SCOPE(scope) HttpProfileTimer HTTP_PROFILE_CONCAT(httpProfileTimer, __LINE__)(scope)
+ // Dump the profile when the simulator is destroyed
+ #define HTTP_PROFILE_DUMP_AT_DESTROY(label) ns3::Simulator::ScheduleDestroy(&HttpProfileDump, label)
+ #else
+ #define HTTP_PROFILE_SCOPE(scope)
+ #define HTTP_PROFILE_DUMP_AT_DESTROY(label)
+ #endif
+
+ #endif /* HTTP_PROFILE_H */
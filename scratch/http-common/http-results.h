@@ -0,0 +1,290 @@
+/* http-results.h
+ *
+ * Per-page and per-request results of an HTTP simulation, streamed to a
+ * file (--results) as each client finishes a page, so nothing has to be
+ * walked or formatted at the end of the run. With --sampleInterval the
+ * transport samples of the connections (http-sampler.h) go to the same
+ * file as they are taken. new_graphing.py reads both formats.
+ *
+ * Binary layout (host byte order):
+ *   [HttpResultsFileHeader]
+ *   [params]                                  paramsSize bytes, "mode=<mode> <options>"
+ *   ([HttpResultsRecordHeader][record])*
+ *
+ * where a record is, by type,
+ *   HTTP_RESULTS_RECORD_PAGE      [HttpResultsPageRecord][HttpResultsRequestRecord x requestCount]
+ *   HTTP_RESULTS_RECORD_SAMPLES   [HttpResultsSampleRecord]*
+ * Readers skip record types they do not know by their size. Version 1
+ * files have no record headers, only page records.
+ *
+ * CSV has the params as a leading "# ..." line, then one "page" row per
+ * page followed by one "request" row per request, and "sample" or
+ * "server_sample" rows in between, all with the columns of
+ * HTTP_RESULTS_CSV_COLUMNS. Columns a row has no value for are empty.
+ *
+ * Times are simulation microseconds; 0 means the request was never
+ * started (or completed), the same convention WebRequest uses.
+ */
+
+ #ifndef HTTP_RESULTS_H
+ #define HTTP_RESULTS_H
+
+ #include "ns3/core-module.h"
+ #include "http-stats.h"
+ #include "http-trace.h"
+ #include <algorithm>
+ #include <cstdint>
+ #include <cstdio>
+ #include <cstring>
+ #include <string>
+ #include <vector>
+
+ using namespace ns3;
+
+ #define HTTP_RESULTS_MAGIC "SSTRSLTS"
+ #define HTTP_RESULTS_VERSION 2
+
+ // Record types
+ #define HTTP_RESULTS_RECORD_PAGE 1
+ #define HTTP_RESULTS_RECORD_SAMPLES 2
+
+ // Request flags
+ #define HTTP_RESULTS_PRIMARY 0x1
+ #define HTTP_RESULTS_COMPLETED 0x2
+ #define HTTP_RESULTS_NOT_MODIFIED 0x4    // Conditional request answered with a 304
+
+ // Sample flags
+ #define HTTP_RESULTS_SAMPLE_SERVER 0x1   // Taken by the server; clientId is unknown (0)
+ #define HTTP_RESULTS_SAMPLE_PACKETS 0x2  // cwnd, ssthresh and inFlight count packets, not bytes
+
+ #define HTTP_RESULTS_CSV_COLUMNS "record,client,page,request,requests,primary,size,start_us,end_us,completed," \
+                                  "connection,time_us,cwnd,ssthresh,inflight,queue,rtt_us,rto_us"
+
+ struct HttpResultsFileHeader {
+   char magic[8];               // HTTP_RESULTS_MAGIC, not NUL-terminated
+   uint32_t version;            // HTTP_RESULTS_VERSION
+   uint32_t headerSize;         // sizeof(HttpResultsFileHeader)
+   uint32_t pageRecordSize;     // sizeof(HttpResultsPageRecord)
+   uint32_t requestRecordSize;  // sizeof(HttpResultsRequestRecord)
+   uint32_t paramsSize;         // Bytes of the params string after the header
+   uint32_t sampleRecordSize;   // sizeof(HttpResultsSampleRecord); reserved in version 1
+ };
+
+ struct HttpResultsRecordHeader {
+   uint32_t type;               // HTTP_RESULTS_RECORD_*
+   uint32_t size;               // Bytes of the record after this header
+ };
+
+ struct HttpResultsPageRecord {
+   uint32_t clientId;           // Client node index
+   uint32_t pageIndex;          // Page index within the client's share of the trace
+   uint32_t requestCount;
+   uint32_t completedRequests;
+   uint32_t totalSize;          // Sum of the response sizes
+   uint32_t completedSize;      // Sum of the completed response sizes
+   int64_t startUs;             // Earliest request start
+   int64_t endUs;               // Latest request completion
+ };
+
+ struct HttpResultsRequestRecord {
+   int64_t startUs;
+   int64_t completeUs;
+   uint32_t size;               // Response body size in bytes (0 for a 304)
+   uint32_t flags;              // HTTP_RESULTS_* flags
+ };
+
+ // One connection's transport state at one time
+ struct HttpResultsSampleRecord {
+   int64_t timeUs;
+   uint32_t clientId;           // Client node index
+   uint32_t connection;         // Connection index of the client, or the server's channel number
+   uint32_t cwnd;               // Congestion window
+   uint32_t ssthresh;           // Slow start threshold
+   uint32_t inFlight;           // Sent and not yet acknowledged
+   uint32_t queue;              // Requests (client) or responses (server) not yet complete
+   uint32_t rttUs;              // Smoothed round-trip time
+   uint32_t rtoUs;              // Retransmission timeout
+   uint32_t flags;              // HTTP_RESULTS_SAMPLE_* flags
+   uint32_t reserved;
+ };
+
+ static_assert(sizeof(HttpResultsFileHeader) == 32, "unexpected results header layout");
+ static_assert(sizeof(HttpResultsPageRecord) == 40, "unexpected results page layout");
+ static_assert(sizeof(HttpResultsRequestRecord) == 24, "unexpected results request layout");
+ static_assert(sizeof(HttpResultsSampleRecord) == 48, "unexpected results sample layout");
+
+ // Collects the run statistics from finished pages and, when a file is
+ // open, streams their records to it
+ class HttpResults {
+ public:
+   HttpResults() : m_file(nullptr), m_csv(false), m_printPages(true) {}
+   ~HttpResults() {
+     Close();
+   }
+
+   // format is "binary" or "csv"; the mode and command line options are
+   // stored with the records
+   bool Open(const std::string& filename, const std::string& format, const std::string& mode,
+             int argc, char** argv, std::string& error) {
+     Close();
+     if (format != "binary" && format != "csv") {
+       error = "unknown results format " + format + " (use binary or csv)";
+       return false;
+     }
+     m_csv = (format == "csv");
+
+     m_file = fopen(filename.c_str(), m_csv ? "w" : "wb");
+     if (!m_file) {
+       error = "cannot open results file " + filename;
+       return false;
+     }
+     setvbuf(m_file, nullptr, _IOFBF, 1 << 20);
+
+     std::string params = "mode=" + mode;
+     for (int i = 1; i < argc; i++) {
+       params += " ";
+       params += argv[i];
+     }
+     if (m_csv) {
+       fprintf(m_file, "# %s\n%s\n", params.c_str(), HTTP_RESULTS_CSV_COLUMNS);
+       return true;
+     }
+
+     HttpResultsFileHeader header;
+     memset(&header, 0, sizeof(header));
+     memcpy(header.magic, HTTP_RESULTS_MAGIC, sizeof(header.magic));
+     header.version = HTTP_RESULTS_VERSION;
+     header.headerSize = sizeof(HttpResultsFileHeader);
+     header.pageRecordSize = sizeof(HttpResultsPageRecord);
+     header.requestRecordSize = sizeof(HttpResultsRequestRecord);
+     header.paramsSize = params.size();
+     header.sampleRecordSize = sizeof(HttpResultsSampleRecord);
+     fwrite(&header, sizeof(header), 1, m_file);
+     fwrite(params.data(), 1, params.size(), m_file);
+     return true;
+   }
+
+   bool Close() {
+     if (!m_file) {
+       return false;
+     }
+     bool ok = !ferror(m_file);
+     ok = (fclose(m_file) == 0) && ok;
+     m_file = nullptr;
+     return ok;
+   }
+
+   // Print the "Page N (...)" line of every completed page to stdout
+   void SetPrintPages(bool print) {
+     m_printPages = print;
+   }
+
+   // How often the applications sample their connections; zero (the
+   // default) turns the samplers off
+   void SetSampleInterval(Time interval) {
+     m_sampleInterval = interval;
+   }
+
+   Time GetSampleInterval() const {
+     return m_sampleInterval;
+   }
+
+   // A client is done with a page, or the run ended before it was
+   void AddPage(const WebPage& page, uint32_t clientId, uint32_t pageIndex) {
+     AccumulatePageStats(page, m_stats, m_printPages);
+     if (!m_file) {
+       return;
+     }
+
+     HttpResultsPageRecord pageRecord;
+     memset(&pageRecord, 0, sizeof(pageRecord));
+     pageRecord.clientId = clientId;
+     pageRecord.pageIndex = pageIndex;
+     pageRecord.requestCount = page.requests.size();
+
+     m_requests.clear();
+     for (const auto& req : page.requests) {
+       HttpResultsRequestRecord record;
+       record.startUs = req.startTime.GetMicroSeconds();
+       record.completeUs = req.completeTime.GetMicroSeconds();
+       record.size = req.GetBodySize();
+       record.flags = req.isPrimary ? HTTP_RESULTS_PRIMARY : 0;
+       if (req.IsNotModified()) {
+         record.flags |= HTTP_RESULTS_NOT_MODIFIED;
+       }
+       m_requests.push_back(record);
+
+       pageRecord.totalSize += record.size;
+       if (record.startUs > 0 && (pageRecord.startUs == 0 || record.startUs < pageRecord.startUs)) {
+         pageRecord.startUs = record.startUs;
+       }
+       if (record.completeUs > 0) {
+         m_requests.back().flags |= HTTP_RESULTS_COMPLETED;
+         pageRecord.completedRequests++;
+         pageRecord.completedSize += record.size;
+         pageRecord.endUs = std::max(pageRecord.endUs, record.completeUs);
+       }
+     }
+
+     if (m_csv) {
+       WriteCsv(pageRecord);
+     } else {
+       HttpResultsRecordHeader header;
+       header.type = HTTP_RESULTS_RECORD_PAGE;
+       header.size = sizeof(pageRecord) + m_requests.size() * sizeof(HttpResultsRequestRecord);
+       fwrite(&header, sizeof(header), 1, m_file);
+       fwrite(&pageRecord, sizeof(pageRecord), 1, m_file);
+       fwrite(m_requests.data(), sizeof(HttpResultsRequestRecord), m_requests.size(), m_file);
+     }
+   }
+
+   // Samples an application took at one time, as one record
+   void AddSamples(const std::vector<HttpResultsSampleRecord>& samples) {
+     if (!m_file || samples.empty()) {
+       return;
+     }
+     if (!m_csv) {
+       HttpResultsRecordHeader header;
+       header.type = HTTP_RESULTS_RECORD_SAMPLES;
+       header.size = samples.size() * sizeof(HttpResultsSampleRecord);
+       fwrite(&header, sizeof(header), 1, m_file);
+       fwrite(samples.data(), sizeof(HttpResultsSampleRecord), samples.size(), m_file);
+       return;
+     }
+     for (const HttpResultsSampleRecord& sample : samples) {
+       if (sample.flags & HTTP_RESULTS_SAMPLE_SERVER) {
+         fprintf(m_file, "server_sample,,,,,,,,,,");
+       } else {
+         fprintf(m_file, "sample,%u,,,,,,,,,", sample.clientId);
+       }
+       fprintf(m_file, "%u,%lld,%u,%u,%u,%u,%u,%u\n", sample.connection, (long long) sample.timeUs,
+               sample.cwnd, sample.ssthresh, sample.inFlight, sample.queue, sample.rttUs, sample.rtoUs);
+     }
+   }
+
+   HttpRunStats& GetStats() {
+     return m_stats;
+   }
+
+ private:
+   void WriteCsv(const HttpResultsPageRecord& page) {
+     fprintf(m_file, "page,%u,%u,,%u,,%u,%lld,%lld,%u,,,,,,,,\n", page.clientId, page.pageIndex,
+             page.requestCount, page.totalSize, (long long) page.startUs, (long long) page.endUs,
+             page.completedRequests);
+     for (size_t i = 0; i < m_requests.size(); i++) {
+       const HttpResultsRequestRecord& req = m_requests[i];
+       fprintf(m_file, "request,%u,%u,%zu,,%d,%u,%lld,%lld,%d,,,,,,,,\n", page.clientId, page.pageIndex, i,
+               (req.flags & HTTP_RESULTS_PRIMARY) ? 1 : 0, req.size, (long long) req.startUs,
+               (long long) req.completeUs, (req.flags & HTTP_RESULTS_COMPLETED) ? 1 : 0);
+     }
+   }
+
+   FILE* m_file;
+   bool m_csv;
+   bool m_printPages;
+   Time m_sampleInterval;
+   HttpRunStats m_stats;
+   std::vector<HttpResultsRequestRecord> m_requests;  // Records of the page being written
+ };
+
+ #endif /* HTTP_RESULTS_H */
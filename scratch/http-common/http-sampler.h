@@ -0,0 +1,225 @@
+/* http-sampler.h
+ *
+ * Transport state of the HTTP connections over time. Each SstChannel is an
+ * Object with cwnd, ssthresh, rtt, rto and packetsInFlight as trace sources,
+ * and each TCP connection wrapper mirrors its socket's congestion control
+ * trace sources into an HttpTcpTransport object, so a trace sink can follow
+ * one connection change by change: the clients hand out their connections'
+ * objects (GetTransport, GetChannel) and the SST server announces each
+ * channel it opens through its "ChannelOpened" trace source.
+ *
+ * For whole runs the applications sample them instead: every
+ * --sampleInterval an HttpTransportSampler records each connection of its
+ * application, drops the ones that have not changed since their previous
+ * sample, and hands the rest to the results file and to the application's
+ * "TransportSample" trace source. That costs one event per application and
+ * interval however busy the connections are, and nothing when sampling is
+ * off.
+ */
+
+ #ifndef HTTP_SAMPLER_H
+ #define HTTP_SAMPLER_H
+
+ #include "ns3/core-module.h"
+ #include "ns3/network-module.h"
+ #include "http-results.h"
+ #include <functional>
+ #include <unordered_map>
+ #include <vector>
+
+ using namespace ns3;
+
+ // A TCP connection's view of its socket, kept across reconnects so that
+ // sinks stay connected
+ class HttpTcpTransport : public Object {
+ public:
+   static TypeId GetTypeId() {
+     static TypeId tid = TypeId("ns3::HttpTcpTransport")
+       .SetParent<Object>()
+       .SetGroupName("Applications")
+       .AddConstructor<HttpTcpTransport>()
+       .AddTraceSource("CongestionWindow", "The socket's congestion window in bytes, 0 while closed",
+                       MakeTraceSourceAccessor(&HttpTcpTransport::cwnd),
+                       "ns3::TracedValueCallback::Uint32")
+       .AddTraceSource("SlowStartThreshold", "The socket's slow start threshold in bytes",
+                       MakeTraceSourceAccessor(&HttpTcpTransport::ssthresh),
+                       "ns3::TracedValueCallback::Uint32")
+       .AddTraceSource("BytesInFlight", "The socket's bytes in flight",
+                       MakeTraceSourceAccessor(&HttpTcpTransport::bytesInFlight),
+                       "ns3::TracedValueCallback::Uint32")
+       .AddTraceSource("RTT", "The socket's smoothed round-trip time",
+                       MakeTraceSourceAccessor(&HttpTcpTransport::rtt),
+                       "ns3::TracedValueCallback::Time")
+       .AddTraceSource("RTO", "The socket's retransmission timeout",
+                       MakeTraceSourceAccessor(&HttpTcpTransport::rto),
+                       "ns3::TracedValueCallback::Time")
+       .AddTraceSource("Queue", "Requests on the connection without a complete response",
+                       MakeTraceSourceAccessor(&HttpTcpTransport::queue),
+                       "ns3::TracedValueCallback::Uint32");
+     return tid;
+   }
+
+   HttpTcpTransport() {}
+
+   // The socket callbacks are bound to this object
+   HttpTcpTransport(const HttpTcpTransport&) = delete;
+   HttpTcpTransport& operator=(const HttpTcpTransport&) = delete;
+
+   TracedValue<uint32_t> cwnd;            // Congestion window in bytes
+   TracedValue<uint32_t> ssthresh;        // Slow start threshold in bytes
+   TracedValue<uint32_t> bytesInFlight;
+   TracedValue<Time> rtt;                 // Smoothed round-trip time
+   TracedValue<Time> rto;
+   TracedValue<uint32_t> queue;           // Requests on the connection without a complete response,
+                                          // kept by the client
+
+   // Follow socket from now on, in place of the previous one
+   void Watch(Ptr<Socket> socket) {
+     Unwatch();
+     m_socket = socket;
+     socket->TraceConnectWithoutContext("CongestionWindow", MakeCallback(&HttpTcpTransport::SetCwnd, this));
+     socket->TraceConnectWithoutContext("SlowStartThreshold", MakeCallback(&HttpTcpTransport::SetSsthresh, this));
+     socket->TraceConnectWithoutContext("BytesInFlight", MakeCallback(&HttpTcpTransport::SetBytesInFlight, this));
+     socket->TraceConnectWithoutContext("RTT", MakeCallback(&HttpTcpTransport::SetRtt, this));
+     socket->TraceConnectWithoutContext("RTO", MakeCallback(&HttpTcpTransport::SetRto, this));
+   }
+
+   // The connection closed: stop following its socket and forget its
+   // state (but not the queue)
+   void Unwatch() {
+     if (m_socket) {
+       m_socket->TraceDisconnectWithoutContext("CongestionWindow", MakeCallback(&HttpTcpTransport::SetCwnd, this));
+       m_socket->TraceDisconnectWithoutContext("SlowStartThreshold", MakeCallback(&HttpTcpTransport::SetSsthresh, this));
+       m_socket->TraceDisconnectWithoutContext("BytesInFlight", MakeCallback(&HttpTcpTransport::SetBytesInFlight, this));
+       m_socket->TraceDisconnectWithoutContext("RTT", MakeCallback(&HttpTcpTransport::SetRtt, this));
+       m_socket->TraceDisconnectWithoutContext("RTO", MakeCallback(&HttpTcpTransport::SetRto, this));
+       m_socket = nullptr;
+     }
+     cwnd = 0;
+     ssthresh = 0;
+     bytesInFlight = 0;
+     rtt = Time(0);
+     rto = Time(0);
+   }
+
+ protected:
+   virtual void DoDispose() {
+     Unwatch();
+     Object::DoDispose();
+   }
+
+ private:
+   void SetCwnd(uint32_t oldValue, uint32_t newValue) {
+     cwnd = newValue;
+   }
+
+   void SetSsthresh(uint32_t oldValue, uint32_t newValue) {
+     ssthresh = newValue;
+   }
+
+   void SetBytesInFlight(uint32_t oldValue, uint32_t newValue) {
+     bytesInFlight = newValue;
+   }
+
+   void SetRtt(Time oldValue, Time newValue) {
+     rtt = newValue;
+   }
+
+   void SetRto(Time oldValue, Time newValue) {
+     rto = newValue;
+   }
+
+   Ptr<Socket> m_socket;
+ };
+
+ class HttpTransportSampler {
+ public:
+   // Signature of the applications' "TransportSample" trace source
+   typedef void (*SampleTracedCallback)(const HttpResultsSampleRecord& sample);
+
+   HttpTransportSampler() : m_results(nullptr), m_trace(nullptr), m_clientId(0), m_flags(0) {}
+
+   // Where the samples go; flags (HTTP_RESULTS_SAMPLE_*) are set on all of them
+   void SetResults(HttpResults* results, uint32_t clientId, uint32_t flags) {
+     m_results = results;
+     m_clientId = clientId;
+     m_flags = flags;
+   }
+
+   void SetTrace(TracedCallback<const HttpResultsSampleRecord&>* trace) {
+     m_trace = trace;
+   }
+
+   // Sample now and then every interval of the results until Stop. collect
+   // calls Add once for every connection worth recording.
+   void Start(std::function<void()> collect) {
+     Stop();
+     if (!m_results || !m_results->GetSampleInterval().IsStrictlyPositive()) {
+       return;
+     }
+     m_collect = collect;
+     m_last.clear();
+     m_event = Simulator::ScheduleNow(&HttpTransportSampler::Sample, this);
+   }
+
+   void Stop() {
+     Simulator::Cancel(m_event);
+   }
+
+   void Add(uint32_t connection, uint32_t cwnd, uint32_t ssthresh, uint32_t inFlight, uint32_t queue,
+            Time rtt, Time rto) {
+     HttpResultsSampleRecord sample;
+     sample.timeUs = Simulator::Now().GetMicroSeconds();
+     sample.clientId = m_clientId;
+     sample.connection = connection;
+     sample.cwnd = cwnd;
+     sample.ssthresh = ssthresh;
+     sample.inFlight = inFlight;
+     sample.queue = queue;
+     sample.rttUs = rtt.GetMicroSeconds();
+     sample.rtoUs = rto.GetMicroSeconds();
+     sample.flags = m_flags;
+     sample.reserved = 0;
+
+     auto it = m_last.find(connection);
+     if (it != m_last.end() && SameState(it->second, sample)) {
+       return;
+     }
+     m_last[connection] = sample;
+     m_samples.push_back(sample);
+   }
+
+   void Add(uint32_t connection, Ptr<const HttpTcpTransport> transport) {
+     Add(connection, transport->cwnd, transport->ssthresh, transport->bytesInFlight, transport->queue,
+         transport->rtt, transport->rto);
+   }
+
+ private:
+   static bool SameState(const HttpResultsSampleRecord& a, const HttpResultsSampleRecord& b) {
+     return a.cwnd == b.cwnd && a.ssthresh == b.ssthresh && a.inFlight == b.inFlight &&
+            a.queue == b.queue && a.rttUs == b.rttUs && a.rtoUs == b.rtoUs;
+   }
+
+   void Sample() {
+     m_samples.clear();
+     m_collect();
+     m_results->AddSamples(m_samples);
+     if (m_trace) {
+       for (const HttpResultsSampleRecord& sample : m_samples) {
+         (*m_trace)(sample);
+       }
+     }
+     m_event = Simulator::Schedule(m_results->GetSampleInterval(), &HttpTransportSampler::Sample, this);
+   }
+
+   HttpResults* m_results;
+   TracedCallback<const HttpResultsSampleRecord&>* m_trace;
+   uint32_t m_clientId;
+   uint32_t m_flags;
+   std::function<void()> m_collect;
+   EventId m_event;
+   std::unordered_map<uint32_t, HttpResultsSampleRecord> m_last;   // Latest sample of each connection
+   std::vector<HttpResultsSampleRecord> m_samples;                 // Samples of the current tick
+ };
+
+ #endif /* HTTP_SAMPLER_H */
@@ -0,0 +1,127 @@
+/* http-send-queue.h
+ *
+ * Event-driven response sending for the TCP servers. Each accepted socket
+ * has a queue of responses (header bytes, then a body of virtual bytes)
+ * that is written into the socket's TX buffer as far as it has room, once
+ * when a response is queued and again from the socket's send callback
+ * whenever acknowledged data frees space. A full buffer costs no events
+ * at all, responses on one connection go out strictly in order, and the
+ * sockets are found by a hash lookup. The servers Remove a socket from
+ * their close callbacks, so only open connections are held.
+ */
+
+ #ifndef HTTP_SEND_QUEUE_H
+ #define HTTP_SEND_QUEUE_H
+
+ #include "ns3/core-module.h"
+ #include "ns3/network-module.h"
+ #include <algorithm>
+ #include <deque>
+ #include <string>
+ #include <unordered_map>
+ #include "http-profile.h"
+
+ using namespace ns3;
+
+ class HttpSendQueue {
+ public:
+   // Start tracking an accepted socket; takes over its send callback
+   void Add(Ptr<Socket> socket) {
+     m_sockets[PeekPointer(socket)].socket = socket;
+     socket->SetSendCallback(MakeCallback(&HttpSendQueue::HandleSend, this));
+   }
+
+   // Stop tracking a socket whose connection closed or failed, dropping
+   // what it had left to send
+   void Remove(Ptr<Socket> socket) {
+     auto it = m_sockets.find(PeekPointer(socket));
+     if (it != m_sockets.end()) {
+       socket->SetSendCallback(MakeNullCallback<void, Ptr<Socket>, uint32_t>());
+       m_sockets.erase(it);
+     }
+   }
+
+   bool Contains(Ptr<Socket> socket) const {
+     return m_sockets.find(PeekPointer(socket)) != m_sockets.end();
+   }
+
+   // Queue one response behind whatever the connection is still sending
+   // and push as much of it as fits now
+   void Send(Ptr<Socket> socket, const std::string& header, uint32_t bodySize) {
+     auto it = m_sockets.find(PeekPointer(socket));
+     if (it == m_sockets.end()) {
+       return;
+     }
+     PendingResponse response;
+     response.header = header;
+     response.headerSent = 0;
+     response.bodyRemaining = bodySize;
+     it->second.responses.push_back(response);
+     Drain(it->second, socket->GetTxAvailable());
+   }
+
+   // Close every socket and drop what they had left to send
+   void CloseAll() {
+     for (auto& entry : m_sockets) {
+       entry.second.socket->SetSendCallback(MakeNullCallback<void, Ptr<Socket>, uint32_t>());
+       entry.second.socket->Close();
+     }
+     m_sockets.clear();
+   }
+
+ private:
+   struct PendingResponse {
+     std::string header;
+     uint32_t headerSent;       // Header bytes already in the TX buffer
+     uint32_t bodyRemaining;    // Body bytes not yet in the TX buffer
+   };
+
+   struct SocketState {
+     Ptr<Socket> socket;
+     std::deque<PendingResponse> responses;
+   };
+
+   void HandleSend(Ptr<Socket> socket, uint32_t available) {
+     HTTP_PROFILE_SCOPE(HTTP_PROFILE_SEND_QUEUE);
+     auto it = m_sockets.find(PeekPointer(socket));
+     if (it != m_sockets.end()) {
+       Drain(it->second, available);
+     }
+   }
+
+   // Fill the available room of the TX buffer from the front of the queue;
+   // stops when it is full and carries on from the next send callback
+   void Drain(SocketState& state, uint32_t available) {
+     while (!state.responses.empty() && available > 0) {
+       PendingResponse& response = state.responses.front();
+
+       Ptr<Packet> packet;
+       uint32_t headerLeft = response.header.size() - response.headerSent;
+       if (headerLeft > 0) {
+         uint32_t n = std::min(headerLeft, available);
+         packet = Create<Packet>((const uint8_t*) response.header.data() + response.headerSent, n);
+       } else {
+         packet = Create<Packet>(std::min(response.bodyRemaining, available));
+       }
+
+       if (packet->GetSize() > 0 && state.socket->Send(packet) < 0) {
+         // The connection is gone; nothing queued on it can be delivered
+         state.responses.clear();
+         return;
+       }
+       available -= packet->GetSize();
+       if (headerLeft > 0) {
+         response.headerSent += packet->GetSize();
+       } else {
+         response.bodyRemaining -= packet->GetSize();
+       }
+       if (response.headerSent == response.header.size() && response.bodyRemaining == 0) {
+         state.responses.pop_front();
+       }
+     }
+   }
+
+   std::unordered_map<Socket*, SocketState> m_sockets;   // Keyed by the socket itself
+ };
+
+ #endif /* HTTP_SEND_QUEUE_H */
@@ -0,0 +1,181 @@
+/* http-sketch.h
+ *
+ * Streaming quantile sketch (DDSketch, Masson et al., VLDB 2019) for the
+ * page and request times. A value goes into the logarithmic bin i with
+ * gamma^(i-1) < value <= gamma^i, gamma = (1 + a) / (1 - a), so every
+ * quantile read back is within the relative accuracy a of a value that
+ * was added, whatever the distribution. The bins are a fixed array: adding
+ * is one log and an increment, and merging two sketches (across MPI ranks
+ * or sweep runs) is adding their bins, which leaves the same sketch as if
+ * every value had been added to one.
+ *
+ * Sketches travel between processes as text lines
+ *   <mode> <name> <bin>:<count>,<bin>:<count>,...
+ * with only the non-empty bins, "-" if there are none.
+ *
+ * No ns-3 dependency, so the process drivers can merge sketches too.
+ */
+
+ #ifndef HTTP_SKETCH_H
+ #define HTTP_SKETCH_H
+
+ #include <algorithm>
+ #include <cmath>
+ #include <cstdint>
+ #include <cstdlib>
+ #include <fstream>
+ #include <iostream>
+ #include <map>
+ #include <sstream>
+ #include <string>
+ #include <utility>
+
+ class HttpQuantileSketch {
+ public:
+   // Relative accuracy of every quantile
+   static constexpr double ACCURACY = 0.01;
+
+   // Enough bins to cover 1 to about 1.3e11 (36 hours in microseconds);
+   // smaller values share the first bin and larger ones the last
+   static const uint32_t BINS = 1280;
+
+   HttpQuantileSketch() : m_bins() {}
+
+   void Add(double value) {
+     m_bins[Index(value)]++;
+   }
+
+   void Merge(const HttpQuantileSketch& other) {
+     for (uint32_t i = 0; i < BINS; i++) {
+       m_bins[i] += other.m_bins[i];
+     }
+   }
+
+   uint64_t GetCount() const {
+     uint64_t count = 0;
+     for (uint32_t i = 0; i < BINS; i++) {
+       count += m_bins[i];
+     }
+     return count;
+   }
+
+   // Value at quantile q in [0, 1]; 0 for an empty sketch
+   double GetQuantile(double q) const {
+     uint64_t count = GetCount();
+     if (count == 0) {
+       return 0.0;
+     }
+     uint64_t rank = (uint64_t) (std::min(std::max(q, 0.0), 1.0) * (count - 1));
+     uint64_t seen = 0;
+     for (uint32_t i = 0; i < BINS; i++) {
+       seen += m_bins[i];
+       if (seen > rank) {
+         return Value(i);
+       }
+     }
+     return Value(BINS - 1);
+   }
+
+   // The bins, BINS of them, for reductions
+   uint64_t* GetData() {
+     return m_bins;
+   }
+
+   std::string Encode() const {
+     std::ostringstream os;
+     for (uint32_t i = 0; i < BINS; i++) {
+       if (m_bins[i] > 0) {
+         os << (os.tellp() > 0 ? "," : "") << i << ":" << m_bins[i];
+       }
+     }
+     return os.tellp() > 0 ? os.str() : "-";
+   }
+
+   // Replace the contents with an Encode()d sketch; false, leaving the
+   // sketch empty, if text is not one
+   bool Decode(const std::string& text) {
+     *this = HttpQuantileSketch();
+     if (text == "-") {
+       return true;
+     }
+     const char* p = text.c_str();
+     while (*p) {
+       char* end;
+       unsigned long bin = strtoul(p, &end, 10);
+       if (end == p || *end != ':' || bin >= BINS) {
+         *this = HttpQuantileSketch();
+         return false;
+       }
+       p = end + 1;
+       unsigned long long count = strtoull(p, &end, 10);
+       if (end == p || (*end != ',' && *end != '\0')) {
+         *this = HttpQuantileSketch();
+         return false;
+       }
+       m_bins[bin] += count;
+       p = *end ? end + 1 : end;
+     }
+     return true;
+   }
+
+ private:
+   static double Gamma() {
+     return (1.0 + ACCURACY) / (1.0 - ACCURACY);
+   }
+
+   static uint32_t Index(double value) {
+     static const double logGamma = std::log(Gamma());
+     if (!(value > 1.0)) {
+       return 0;
+     }
+     return (uint32_t) std::min(std::ceil(std::log(value) / logGamma), (double) (BINS - 1));
+   }
+
+   // The estimate for bin i, within ACCURACY of both its ends
+   static double Value(uint32_t i) {
+     return i == 0 ? 1.0 : 2.0 * std::pow(Gamma(), i) / (Gamma() + 1.0);
+   }
+
+   uint64_t m_bins[BINS];
+ };
+
+ // One line of the standard quantiles, values divided by scale, e.g.
+ //   "  3-4 requests: 812 p50=1520 p90=3301 p99=8017 p99.9=15230"
+ inline void PrintSketchQuantiles(std::ostream& os, const std::string& label,
+                                  const HttpQuantileSketch& sketch, double scale) {
+   os << "  " << label << ": " << sketch.GetCount()
+      << " p50=" << sketch.GetQuantile(0.5) / scale
+      << " p90=" << sketch.GetQuantile(0.9) / scale
+      << " p99=" << sketch.GetQuantile(0.99) / scale
+      << " p99.9=" << sketch.GetQuantile(0.999) / scale << std::endl;
+ }
+
+ // Sketches by (mode, name)
+ typedef std::map<std::pair<std::string, std::string>, HttpQuantileSketch> HttpSketchMap;
+
+ inline void WriteSketchLine(std::ostream& os, const std::string& mode, const std::string& name,
+                             const HttpQuantileSketch& sketch) {
+   os << mode << " " << name << " " << sketch.Encode() << "\n";
+ }
+
+ // Merge every sketch of a sketch file into sketches; false if the file
+ // cannot be read or has a malformed line
+ inline bool ReadSketchFile(const std::string& filename, HttpSketchMap& sketches) {
+   std::ifstream in(filename);
+   if (!in.is_open()) {
+     return false;
+   }
+   std::string line;
+   while (std::getline(in, line)) {
+     std::istringstream fields(line);
+     std::string mode, name, bins;
+     HttpQuantileSketch sketch;
+     if (!(fields >> mode >> name >> bins) || !sketch.Decode(bins)) {
+       return false;
+     }
+     sketches[std::make_pair(mode, name)].Merge(sketch);
+   }
+   return true;
+ }
+
+ #endif /* HTTP_SKETCH_H */
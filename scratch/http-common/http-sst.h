@@ -0,0 +1,2448 @@
+/* http-sst.h
+ *
+ * HTTP/1.0 SST mode client and server applications for replaying UCB web trace data
+ * Implements SST protocol as described in Ford's SIGCOMM'07 paper
+ * 
+ * SST PROTOCOL IMPLEMENTATION:
+ * - Channel Protocol: UDP-based with packet sequencing, ACKs, congestion control
+ * - Stream Protocol: Reliable streams multiplexed over channels
+ * - Packet Format: [Channel Header]([Stream Header][Payload])+[Authenticator]
+ * - Shared congestion control across all streams (TCP-friendly)
+ * - HTTP/1.0 semantics: one transaction per stream
+ *
+ * Logs through the log component of the program that includes it, which
+ * must NS_LOG_COMPONENT_DEFINE one before the include.
+ */
+
+ #ifndef HTTP_SST_H
+ #define HTTP_SST_H
+
+ #include "ns3/applications-module.h"
+ #include "ns3/core-module.h"
+ #include "ns3/internet-module.h"
+ #include "ns3/network-module.h"
+ #include "ns3/point-to-point-module.h"
+ #include "ns3/simulator.h"
+ #include "ns3/inet-socket-address.h"
+ #include <fstream>
+ #include <string>
+ #include <vector>
+ #include <iostream>
+ #include <sstream>
+ #include <map>
+ #include <queue>
+ #include <deque>
+ #include <algorithm>
+ #include <cstring>
+ #include <functional>
+ #include "http-cache.h"
+ #include "http-counters.h"
+ #include "http-log.h"
+ #include "http-page-source.h"
+ #include "http-profile.h"
+ #include "http-results.h"
+ #include "http-sampler.h"
+ #include "http-trace.h"
+ #include "http-mode.h"
+
+ using namespace ns3;
+ 
+ // SST Packet Format (from paper Section 4.1, Figure 3)
+ //   [SstChannelHeader] record* [SstAuthenticator]
+ //   record = [SstStreamHeader][SstRequestHeader, INIT only][payload]
+ // One packet can carry records of several streams, so small requests and
+ // responses share packets; a pure ACK has no records. Payload bytes are
+ // virtual: only their count matters to the simulation.
+ //
+ // A pure ACK that acknowledges nothing is a RESET: its sender has no state
+ // for the channel, e.g. the server expired it, and the receiver drops its
+ // own. The client then starts over under the next channel ID.
+ class SstChannelHeader : public Header {
+ public:
+   SstChannelHeader() : channelId(1), packetSeqNum(0), ackSeqNum(0), ackCount(0) {}
+ 
+   static TypeId GetTypeId() {
+     static TypeId tid = TypeId("ns3::SstChannelHeader")
+       .SetParent<Header>()
+       .SetGroupName("Applications")
+       .AddConstructor<SstChannelHeader>();
+     return tid;
+   }
+ 
+   virtual TypeId GetInstanceTypeId() const {
+     return GetTypeId();
+   }
+ 
+   virtual uint32_t GetSerializedSize() const {
+     return 8;
+   }
+ 
+   virtual void Serialize(Buffer::Iterator start) const {
+     start.WriteHtonU32((uint32_t) channelId << 24 | (packetSeqNum & 0xFFFFFF));
+     start.WriteHtonU32((uint32_t) ackCount << 24 | (ackSeqNum & 0xFFFFFF));
+   }
+ 
+   virtual uint32_t Deserialize(Buffer::Iterator start) {
+     uint32_t word = start.ReadNtohU32();
+     channelId = word >> 24;
+     packetSeqNum = word & 0xFFFFFF;
+     word = start.ReadNtohU32();
+     ackCount = word >> 24;
+     ackSeqNum = word & 0xFFFFFF;
+     return GetSerializedSize();
+   }
+ 
+   virtual void Print(std::ostream& os) const {
+     os << "channel=" << (uint32_t) channelId << " seq=" << packetSeqNum
+        << " ack=" << ackSeqNum << "/" << (uint32_t) ackCount;
+   }
+ 
+   // Real pure ACKs only go out once a data packet has arrived, so they
+   // always acknowledge at least one
+   bool IsReset() const {
+     return packetSeqNum == 0 && ackCount == 0;
+   }
+ 
+   // The sequence numbers are 32-bit in the channels but 24-bit on the
+   // wire; a receiver widens them with SstChannel::Widen
+   uint8_t channelId;              // 8-bit channel ID
+   uint32_t packetSeqNum;          // 24-bit packet sequence number
+   uint32_t ackSeqNum;             // 24-bit highest packet sequence acknowledged
+   uint8_t ackCount;               // Packets acknowledged, ending at ackSeqNum (0 = none)
+ };
+ 
+ class SstStreamHeader : public Header {
+ public:
+   SstStreamHeader() : localStreamId(0), byteSeqNum(0), window(31), flags(0), length(0) {}
+ 
+   static TypeId GetTypeId() {
+     static TypeId tid = TypeId("ns3::SstStreamHeader")
+       .SetParent<Header>()
+       .SetGroupName("Applications")
+       .AddConstructor<SstStreamHeader>();
+     return tid;
+   }
+ 
+   virtual TypeId GetInstanceTypeId() const {
+     return GetTypeId();
+   }
+ 
+   virtual uint32_t GetSerializedSize() const {
+     return 9;
+   }
+ 
+   virtual void Serialize(Buffer::Iterator start) const {
+     start.WriteHtonU16(localStreamId);
+     start.WriteHtonU32(byteSeqNum);
+     start.WriteU8((window & 0x1F) << 3 | (flags & 0x7));
+     start.WriteHtonU16(length);
+   }
+ 
+   virtual uint32_t Deserialize(Buffer::Iterator start) {
+     localStreamId = start.ReadNtohU16();
+     byteSeqNum = start.ReadNtohU32();
+     uint8_t bits = start.ReadU8();
+     window = bits >> 3;
+     flags = bits & 0x7;
+     length = start.ReadNtohU16();
+     return GetSerializedSize();
+   }
+ 
+   virtual void Print(std::ostream& os) const {
+     os << "lsid=" << localStreamId << " byteSeq=" << byteSeqNum
+        << " window=" << (uint32_t) window << " flags=" << (uint32_t) flags
+        << " length=" << length;
+   }
+ 
+   uint16_t localStreamId;         // 16-bit LSID
+   uint32_t byteSeqNum;            // 32-bit byte sequence number within stream
+   uint8_t window;                 // 5-bit window (exponential encoding)
+   uint8_t flags;                  // 3-bit SST_FLAG_* flags
+   uint16_t length;                // Bytes of this record after the header
+ };
+ 
+ // Compact form of the HTTP/1.0 GET carried by a stream's INIT packet; the
+ // rest of the request line and headers are virtual payload bytes
+ class SstRequestHeader : public Header {
+ public:
+   SstRequestHeader() : responseSize(0), flags(0), lastModified(0), ifModifiedSince(0) {}
+ 
+   static TypeId GetTypeId() {
+     static TypeId tid = TypeId("ns3::SstRequestHeader")
+       .SetParent<Header>()
+       .SetGroupName("Applications")
+       .AddConstructor<SstRequestHeader>();
+     return tid;
+   }
+ 
+   virtual TypeId GetInstanceTypeId() const {
+     return GetTypeId();
+   }
+ 
+   virtual uint32_t GetSerializedSize() const {
+     return 13;
+   }
+ 
+   virtual void Serialize(Buffer::Iterator start) const {
+     start.WriteHtonU32(responseSize);
+     start.WriteU8(flags);
+     start.WriteHtonU32(lastModified);
+     start.WriteHtonU32(ifModifiedSince);
+   }
+ 
+   virtual uint32_t Deserialize(Buffer::Iterator start) {
+     responseSize = start.ReadNtohU32();
+     flags = start.ReadU8();
+     lastModified = start.ReadNtohU32();
+     ifModifiedSince = start.ReadNtohU32();
+     return GetSerializedSize();
+   }
+ 
+   virtual void Print(std::ostream& os) const {
+     os << "size=" << responseSize << " flags=" << (uint32_t) flags;
+     if (ifModifiedSince != 0) {
+       os << " lm=" << lastModified << " ims=" << ifModifiedSince;
+     }
+   }
+ 
+   uint32_t responseSize;          // Response body size from the trace
+   uint8_t flags;                  // SST_REQUEST_* flags
+   uint32_t lastModified;          // Object's Last-Modified, for conditional requests
+   uint32_t ifModifiedSince;       // The client's cached copy, 0 for a plain GET
+ };
+ 
+ class SstAuthenticator : public Trailer {
+ public:
+   SstAuthenticator() : checksum(0x12345678) {}
+ 
+   static TypeId GetTypeId() {
+     static TypeId tid = TypeId("ns3::SstAuthenticator")
+       .SetParent<Trailer>()
+       .SetGroupName("Applications")
+       .AddConstructor<SstAuthenticator>();
+     return tid;
+   }
+ 
+   virtual TypeId GetInstanceTypeId() const {
+     return GetTypeId();
+   }
+ 
+   virtual uint32_t GetSerializedSize() const {
+     return 4;
+   }
+ 
+   virtual void Serialize(Buffer::Iterator start) const {
+     start.Prev(GetSerializedSize());
+     start.WriteHtonU32(checksum);
+   }
+ 
+   virtual uint32_t Deserialize(Buffer::Iterator start) {
+     start.Prev(GetSerializedSize());
+     checksum = start.ReadNtohU32();
+     return GetSerializedSize();
+   }
+ 
+   virtual void Print(std::ostream& os) const {
+     os << "auth=" << checksum;
+   }
+ 
+   uint32_t checksum;              // 32-bit lightweight authenticator
+ };
+ 
+ NS_OBJECT_ENSURE_REGISTERED(SstChannelHeader);
+ NS_OBJECT_ENSURE_REGISTERED(SstStreamHeader);
+ NS_OBJECT_ENSURE_REGISTERED(SstRequestHeader);
+ NS_OBJECT_ENSURE_REGISTERED(SstAuthenticator);
+ 
+ // One stream's share of a packet
+ struct SstRecordRef {
+   uint16_t streamId;
+   uint32_t length;                // Record payload bytes
+ };
+ 
+ // SST Pending Packet (for retransmission)
+ struct SstPendingPacket {
+   uint32_t packetSeqNum;
+   Ptr<Packet> body;               // Serialized stream records, reused on retransmission
+   std::vector<SstRecordRef> records;
+   Time sentTime;
+   Time deadline;                  // Retransmit if still unacknowledged by then
+   uint32_t retransmitCount;
+   
+   SstPendingPacket() : packetSeqNum(0), retransmitCount(0) {}
+   
+   // Ready a pooled record for reuse; keeps the records capacity
+   void Reset() {
+     packetSeqNum = 0;
+     body = nullptr;
+     records.clear();
+     retransmitCount = 0;
+   }
+ };
+ 
+ // Unacknowledged packets of a channel, indexed by packet sequence number
+ // modulo a power-of-two capacity. Slots hold only a handle into a pool of
+ // SstPendingPacket records, so a retransmission (which SST sends under a
+ // new sequence number) moves the handle and leaves the record in place.
+ // The ring doubles when the live sequence span outgrows it.
+ class SstPendingRing {
+ public:
+   SstPendingRing() : m_slots(64), m_mask(63), m_count(0) {}
+   
+   SstPendingPacket* Find(uint32_t seq) {
+     Slot& slot = m_slots[seq & m_mask];
+     return slot.seq == seq ? &m_entries[slot.entry] : nullptr;
+   }
+   
+   // Reference is valid until the next Insert
+   SstPendingPacket& Insert(uint32_t seq) {
+     uint32_t entry;
+     if (m_freeEntries.empty()) {
+       entry = m_entries.size();
+       m_entries.emplace_back();
+     } else {
+       entry = m_freeEntries.back();
+       m_freeEntries.pop_back();
+       m_entries[entry].Reset();
+     }
+     Place(seq, entry);
+     m_count++;
+     return m_entries[entry];
+   }
+   
+   SstPendingPacket& Move(uint32_t oldSeq, uint32_t newSeq) {
+     Slot& slot = m_slots[oldSeq & m_mask];
+     uint32_t entry = slot.entry;
+     slot.seq = 0;
+     Place(newSeq, entry);
+     return m_entries[entry];
+   }
+   
+   void Erase(uint32_t seq) {
+     Slot& slot = m_slots[seq & m_mask];
+     if (slot.seq != seq) {
+       return;
+     }
+     m_entries[slot.entry].body = nullptr;
+     m_freeEntries.push_back(slot.entry);
+     slot.seq = 0;
+     m_count--;
+   }
+   
+   template <typename F>
+   void ForEach(F f) {
+     for (const Slot& slot : m_slots) {
+       if (slot.seq != 0) {
+         f(m_entries[slot.entry]);
+       }
+     }
+   }
+   
+   void Clear() {
+     *this = SstPendingRing();
+   }
+   
+   uint32_t Size() const {
+     return m_count;
+   }
+   
+ private:
+   struct Slot {
+     uint32_t seq;                 // 0 = free; sequence numbers start at 1
+     uint32_t entry;               // Index into m_entries
+     Slot() : seq(0), entry(0) {}
+   };
+   
+   void Place(uint32_t seq, uint32_t entry) {
+     while (m_slots[seq & m_mask].seq != 0) {
+       Grow();
+     }
+     Slot& slot = m_slots[seq & m_mask];
+     slot.seq = seq;
+     slot.entry = entry;
+   }
+   
+   void Grow() {
+     std::vector<Slot> old;
+     old.swap(m_slots);
+     m_slots.resize(old.size() * 2);
+     m_mask = m_slots.size() - 1;
+     for (const Slot& slot : old) {
+       if (slot.seq != 0) {
+         m_slots[slot.seq & m_mask] = slot;
+       }
+     }
+   }
+   
+   std::vector<Slot> m_slots;
+   uint32_t m_mask;
+   uint32_t m_count;
+   std::vector<SstPendingPacket> m_entries;
+   std::vector<uint32_t> m_freeEntries;
+ };
+ 
+ // Payload bytes per SST data segment, the same chunk size the TCP servers write
+ static const uint32_t SST_SEGMENT_SIZE = 1400;
+ 
+ // Delayed ACKs: acknowledge every SST_ACK_EVERY data packets, or after
+ // SST_ACK_DELAY_US if no data packet carries the ACK back first
+ static const uint32_t SST_ACK_EVERY = 2;
+ static const uint32_t SST_ACK_DELAY_US = 10000;
+ 
+ // An outstanding packet is lost once this many later packets are acknowledged
+ static const uint32_t SST_FAST_RETRANSMIT_GAP = 3;
+ 
+ // Stream header flags
+ static const uint8_t SST_FLAG_PUSH = 0x1;   // End of a write, deliver now
+ static const uint8_t SST_FLAG_CLOSE = 0x2;  // Last segment of the stream
+ static const uint8_t SST_FLAG_INIT = 0x4;   // Opens the stream; an SstRequestHeader follows
+ 
+ // Request header flags
+ static const uint8_t SST_REQUEST_PRIMARY = 0x1;  // The page's primary object
+ 
+ // The 5-bit stream window advertises 2^window bytes; 31 means unlimited
+ static uint32_t SstWindowBytes(uint8_t window) {
+   return window >= 31 ? 0xFFFFFFFF : (1u << window);
+ }
+ 
+ // A record's window is counted from its byte sequence number: the
+ // receiver has consumed the stream up to there and accepts 2^window more
+ static uint32_t SstWindowEnd(uint32_t byteSeq, uint8_t window) {
+   if (window >= 31) {
+     return 0xFFFFFFFF;
+   }
+   return (uint32_t) std::min<uint64_t>((uint64_t) byteSeq + SstWindowBytes(window), 0xFFFFFFFF);
+ }
+ 
+ // Order in which the server sends segments of concurrent responses
+ enum SstScheduler {
+   SST_SCHED_FIFO,                // Finish each response in request order
+   SST_SCHED_RR,                  // One segment per response in turn
+   SST_SCHED_PRIMARY,             // Primary object first, the rest round-robin
+   SST_SCHED_SRPT                 // Fewest remaining bytes first
+ };
+ 
+ static bool ParseSstScheduler(const std::string& name, SstScheduler& scheduler) {
+   if (name == "fifo") {
+     scheduler = SST_SCHED_FIFO;
+   } else if (name == "rr") {
+     scheduler = SST_SCHED_RR;
+   } else if (name == "primary") {
+     scheduler = SST_SCHED_PRIMARY;
+   } else if (name == "srpt") {
+     scheduler = SST_SCHED_SRPT;
+   } else {
+     return false;
+   }
+   return true;
+ }
+ 
+ // SST Packet Types
+ enum SstPacketType {
+   SST_DATA = 0,
+   SST_ACK = 1,
+   SST_INIT = 2,
+   SST_REPLY = 3
+ };
+ 
+ // Web request structure
+ 
+ // SST Stream state
+ struct SstStream {
+   uint16_t streamId;
+   WebRequest* request;
+   bool isActive;
+   uint32_t nextByteSeq;           // Next byte sequence number to send
+   uint32_t expectedByteSeq;       // Expected next byte sequence to receive
+   uint32_t sentBytes;
+   uint32_t ackedBytes;
+   uint32_t sendLength;            // Bytes to send on this stream
+   std::map<uint32_t, uint32_t> outOfOrder;  // Received ranges past expectedByteSeq (start -> end)
+   uint32_t responseLength;        // Stream length, 0 until the CLOSE segment arrives
+   uint32_t initPacketSeq;         // Packet carrying the request
+   bool isPrimary;
+   uint32_t windowEnd;             // Sender: the peer accepts bytes below this offset
+   uint32_t advertisedByteSeq;     // Receiver: where the last window advertised starts
+   bool windowUpdatePending;       // Receiver: queued for a window update
+   bool isComplete;
+   
+   SstStream() : streamId(0), request(nullptr), isActive(false), 
+                nextByteSeq(0), expectedByteSeq(0), sentBytes(0), 
+                ackedBytes(0), sendLength(0), responseLength(0), initPacketSeq(0),
+                isPrimary(false), windowEnd(0xFFFFFFFF), advertisedByteSeq(0),
+                windowUpdatePending(false), isComplete(false) {}
+ };
+ 
+ // SST Channel state (implements congestion control + retransmission). An
+ // Object so that trace sinks can follow its congestion control state.
+ struct SstChannel : public Object {
+   static TypeId GetTypeId() {
+     static TypeId tid = TypeId("ns3::SstChannel")
+       .SetParent<Object>()
+       .SetGroupName("Applications")
+       .AddConstructor<SstChannel>()
+       .AddTraceSource("CongestionWindow", "The congestion window in packets",
+                       MakeTraceSourceAccessor(&SstChannel::cwnd),
+                       "ns3::TracedValueCallback::Uint32")
+       .AddTraceSource("SlowStartThreshold", "The slow start threshold in packets",
+                       MakeTraceSourceAccessor(&SstChannel::ssthresh),
+                       "ns3::TracedValueCallback::Uint32")
+       .AddTraceSource("RTT", "The smoothed round-trip time in microseconds",
+                       MakeTraceSourceAccessor(&SstChannel::rtt),
+                       "ns3::TracedValueCallback::Uint32")
+       .AddTraceSource("RTO", "The retransmission timeout in microseconds",
+                       MakeTraceSourceAccessor(&SstChannel::rto),
+                       "ns3::TracedValueCallback::Uint32")
+       .AddTraceSource("PacketsInFlight", "Packets sent and not yet acknowledged",
+                       MakeTraceSourceAccessor(&SstChannel::packetsInFlight),
+                       "ns3::TracedValueCallback::Uint32");
+     return tid;
+   }
+   
+   uint32_t nextPacketSeq;         // Next packet sequence number
+   uint32_t lastAckedPacketSeq;    // Highest acknowledged packet sequence
+   uint32_t lossScanSeq;           // Packets below this were checked for fast retransmit
+   uint32_t recoverySeq;           // Losses up to this sequence are already in cwnd
+   TracedValue<uint32_t> cwnd;     // Congestion window (in packets)
+   TracedValue<uint32_t> ssthresh; // Slow start threshold
+   TracedValue<uint32_t> rtt;      // Round-trip time estimate (in microseconds)
+   TracedValue<uint32_t> rto;      // Retransmission timeout (in microseconds)
+   SstPendingRing pendingPackets;  // Unacknowledged packets
+   EventId retransmitTimer;        // One timer for the whole channel
+   
+   // Receive side: the ACK range owed to the peer
+   uint32_t ackHighest;            // Highest data packet sequence received
+   uint8_t ackRun;                 // Consecutive packets received, ending at ackHighest
+   uint32_t ackPending;            // Data packets received since the last ACK went out
+   EventId ackTimer;
+   TracedValue<uint32_t> packetsInFlight;   // Number of unacknowledged packets
+   bool inSlowStart;               // Congestion control state
+   uint32_t ackedInWindow;         // Packets acknowledged in congestion avoidance since cwnd last grew
+   
+   SstChannel() {
+     Reset();
+   }
+   
+   // The timers are bound to the channel's owner, not to the channel
+   SstChannel(const SstChannel&) = delete;
+   SstChannel& operator=(const SstChannel&) = delete;
+   
+   // Start over as a new channel; trace sinks stay connected
+   void Reset() {
+     Simulator::Cancel(retransmitTimer);
+     Simulator::Cancel(ackTimer);
+     pendingPackets.Clear();
+     nextPacketSeq = 1;
+     lastAckedPacketSeq = 0;
+     lossScanSeq = 1;
+     recoverySeq = 0;
+     cwnd = 1;
+     ssthresh = 65535;
+     rtt = 100000;
+     rto = 1000000;
+     ackHighest = 0;
+     ackRun = 0;
+     ackPending = 0;
+     packetsInFlight = 0;
+     inSlowStart = true;
+     ackedInWindow = 0;
+   }
+   
+   bool CanSend() const {
+     return packetsInFlight < cwnd;
+   }
+   
+   // The 32-bit sequence number within 2^23 of reference whose low 24 bits
+   // are wire. Sequence numbers start at 1, so none is widened below 0.
+   static uint32_t WidenSeq(uint32_t wire, uint32_t reference) {
+     uint32_t seq = (reference & ~0xFFFFFFu) | (wire & 0xFFFFFF);
+     if (seq > reference && seq - reference > 0x800000 && seq >= 0x1000000) {
+       seq -= 0x1000000;
+     } else if (seq < reference && reference - seq > 0x800000) {
+       seq += 0x1000000;
+     }
+     return seq;
+   }
+   
+   // Widen a received header's sequence numbers: data packets are near the
+   // next one expected, ACKs near the newest packet sent
+   void Widen(SstChannelHeader& hdr) const {
+     hdr.packetSeqNum = WidenSeq(hdr.packetSeqNum, ackHighest + 1);
+     hdr.ackSeqNum = WidenSeq(hdr.ackSeqNum, nextPacketSeq - 1);
+   }
+   
+   // Remember a sent packet until it is acknowledged; the caller arms the
+   // channel timer and fills in the packet's records
+   SstPendingPacket& Track(uint32_t packetSeq, Ptr<Packet> body) {
+     SstPendingPacket& pending = pendingPackets.Insert(packetSeq);
+     pending.packetSeqNum = packetSeq;
+     pending.body = body;
+     pending.sentTime = Simulator::Now();
+     pending.deadline = pending.sentTime + MicroSeconds(rto.Get());
+     pending.retransmitCount = 0;
+     packetsInFlight++;
+     return pending;
+   }
+   
+   // Move an outstanding packet to the new sequence number it is resent
+   // under (SST never reuses packet sequence numbers)
+   SstPendingPacket& Resend(uint32_t oldSeq, uint32_t newSeq) {
+     SstPendingPacket& pending = pendingPackets.Move(oldSeq, newSeq);
+     pending.packetSeqNum = newSeq;
+     pending.sentTime = Simulator::Now();
+     pending.deadline = pending.sentTime + MicroSeconds(rto.Get());
+     return pending;
+   }
+   
+   // Acknowledge packets ackSeq-count+1 .. ackSeq and grow the window.
+   // onAcked sees each newly acknowledged packet before it is released.
+   // Returns the number of packets that were still outstanding.
+   uint32_t Acknowledge(uint32_t ackSeq, uint32_t count,
+                        const std::function<void(const SstPendingPacket&)>& onAcked = nullptr) {
+     uint32_t newlyAcked = 0;
+     uint32_t srtt = rtt;
+     for (uint32_t i = 0; i < count && i < ackSeq; i++) {
+       SstPendingPacket* pending = pendingPackets.Find(ackSeq - i);
+       if (!pending) {
+         continue;
+       }
+       Time sample = Simulator::Now() - pending->sentTime;
+       uint32_t rttMicros = sample.GetMicroSeconds();
+       
+       // RTT estimation (RFC 6298 style)
+       if (srtt == 100000) { // First RTT measurement
+         srtt = rttMicros;
+       } else {
+         // SRTT = (1 - alpha) * SRTT + alpha * RTT, alpha = 1/8
+         srtt = (7 * srtt + rttMicros) / 8;
+       }
+       
+       if (onAcked) {
+         onAcked(*pending);
+       }
+       pendingPackets.Erase(ackSeq - i);
+       newlyAcked++;
+     }
+     
+     if (ackSeq > lastAckedPacketSeq) {
+       lastAckedPacketSeq = ackSeq;
+     }
+     if (newlyAcked == 0) {
+       return 0;
+     }
+     
+     // The traced values change once per ACK, not once per packet it covers
+     rtt = srtt;
+     // RTO = SRTT + max(G, K * RTTVAR), simplified to RTO = 4 * SRTT
+     rto = std::min(std::max(4 * srtt, 200000u), 64000000u);   // Min 200ms, max 64s
+     packetsInFlight -= newlyAcked;
+     
+     // Otherwise the timer stays armed. If it fires early, the owner
+     // re-arms it for the next deadline.
+     if (pendingPackets.Size() == 0) {
+       Simulator::Cancel(retransmitTimer);
+     }
+     
+     // Congestion control (TCP-like)
+     if (inSlowStart) {
+       cwnd += newlyAcked; // Slow start: exponential growth
+       if (cwnd >= ssthresh) {
+         inSlowStart = false;
+       }
+     } else {
+       // Congestion avoidance: one packet per window acknowledged, i.e.
+       // about one per round trip
+       ackedInWindow += newlyAcked;
+       if (ackedInWindow >= cwnd) {
+         ackedInWindow -= cwnd;
+         cwnd += 1;
+       }
+     }
+     return newlyAcked;
+   }
+   
+   // Delay until the earliest deadline, or -1 if nothing is outstanding
+   Time NextTimeout() {
+     Time earliest = Time(-1);
+     pendingPackets.ForEach([&earliest](SstPendingPacket& pending) {
+       if (earliest.IsNegative() || pending.deadline < earliest) {
+         earliest = pending.deadline;
+       }
+     });
+     if (earliest.IsNegative()) {
+       return earliest;
+     }
+     return std::max(earliest - Simulator::Now(), Time(0));
+   }
+   
+   // Sequence numbers of the packets whose deadline has passed
+   std::vector<uint32_t> CollectExpired() {
+     std::vector<uint32_t> expired;
+     Time now = Simulator::Now();
+     pendingPackets.ForEach([&expired, now](SstPendingPacket& pending) {
+       if (pending.deadline <= now) {
+         expired.push_back(pending.packetSeqNum);
+       }
+     });
+     return expired;
+   }
+   
+   // Outstanding packets that SST_FAST_RETRANSMIT_GAP later acknowledged
+   // packets have overtaken. Each sequence number is checked once.
+   std::vector<uint32_t> CollectLost() {
+     std::vector<uint32_t> lost;
+     while (lossScanSeq + SST_FAST_RETRANSMIT_GAP <= lastAckedPacketSeq) {
+       if (pendingPackets.Find(lossScanSeq)) {
+         lost.push_back(lossScanSeq);
+       }
+       lossScanSeq++;
+     }
+     return lost;
+   }
+   
+   // Fast retransmit halves the window once per loss event; packets sent
+   // before the first loss was detected belong to the same event
+   void OnFastRetransmit(uint32_t lostSeq) {
+     if (lostSeq <= recoverySeq) {
+       return;
+     }
+     ssthresh = std::max(cwnd.Get() / 2, 2u);
+     cwnd = ssthresh.Get();
+     inSlowStart = false;
+     ackedInWindow = 0;
+     recoverySeq = nextPacketSeq - 1;
+   }
+   
+   // Record a received data packet. Returns true if the ACK should go out
+   // now rather than wait: every SST_ACK_EVERY packets, and on a gap so
+   // the sender can recover quickly. A packet older than the current run
+   // (reordered) is left to the sender's loss recovery.
+   bool RecordReceived(uint32_t seq) {
+     ackPending++;
+     if (seq == ackHighest + 1) {
+       ackHighest = seq;
+       ackRun = std::min(ackRun + 1, 255);
+       return ackPending >= SST_ACK_EVERY;
+     }
+     if (seq > ackHighest) {
+       ackHighest = seq;
+       ackRun = 1;
+     }
+     return true;
+   }
+   
+   // Put the owed ACK range on an outgoing packet
+   void FillAck(SstChannelHeader& hdr) {
+     hdr.ackSeqNum = ackHighest;
+     hdr.ackCount = ackRun;
+     ackPending = 0;
+     Simulator::Cancel(ackTimer);
+   }
+   
+   // Congestion control: timeout indicates packet loss
+   void OnTimeout() {
+     ssthresh = std::max(cwnd.Get() / 2, 2u);
+     cwnd = 1;  // Reset to 1 (slow start)
+     inSlowStart = true;
+     ackedInWindow = 0;
+     
+     // Exponential backoff for RTO
+     rto = std::min(rto.Get() * 2, 64000000u); // Max 64 seconds
+   }
+   
+ protected:
+   virtual void DoDispose() {
+     Simulator::Cancel(retransmitTimer);
+     Simulator::Cancel(ackTimer);
+     pendingPackets.Clear();
+     Object::DoDispose();
+   }
+ };
+ 
+ // Append a stream record to a packet body under construction
+ inline void AppendSstRecord(Ptr<Packet> body, SstStreamHeader streamHdr, Ptr<const Packet> payload) {
+   Ptr<Packet> record = payload->Copy();
+   streamHdr.length = payload->GetSize();
+   record->AddHeader(streamHdr);
+   body->AddAtEnd(record);
+ }
+ 
+ // Create SST packet with proper headers. The body (stream records) is
+ // copy-on-write, so the same body can be resent.
+ inline Ptr<Packet> CreateSstPacket(const SstChannelHeader& chanHdr, Ptr<const Packet> body) {
+   HTTP_PROFILE_SCOPE(HTTP_PROFILE_CREATE_SST_PACKET);
+   Ptr<Packet> packet = body ? body->Copy() : Create<Packet>();
+   packet->AddHeader(chanHdr);
+   packet->AddTrailer(SstAuthenticator());
+   return packet;
+ }
+ 
+ // Parse SST packet, leaving the stream records in the packet
+ inline bool ParseSstPacket(Ptr<Packet> packet, SstChannelHeader& chanHdr) {
+   uint32_t minimumSize = chanHdr.GetSerializedSize() + SstAuthenticator().GetSerializedSize();
+   if (packet->GetSize() < minimumSize) {
+     return false;
+   }
+   
+   packet->RemoveHeader(chanHdr);
+   SstAuthenticator auth;
+   packet->RemoveTrailer(auth);
+   return true;
+ }
+ 
+ // Take the next stream record off a parsed packet; false when none is left
+ inline bool NextSstRecord(Ptr<Packet> packet, SstStreamHeader& streamHdr, Ptr<Packet>& payload) {
+   if (packet->GetSize() < streamHdr.GetSerializedSize()) {
+     return false;
+   }
+   packet->RemoveHeader(streamHdr);
+   if (streamHdr.length > packet->GetSize()) {
+     return false;
+   }
+   payload = packet->CreateFragment(0, streamHdr.length);
+   packet->RemoveAtStart(streamHdr.length);
+   return true;
+ }
+ 
+ // Bytes of the HTTP/1.0 request and response headers the streams model
+ static uint32_t HttpRequestLength(const WebRequest& request, const std::string& path) {
+   static const uint32_t fixed = strlen("GET ?size= HTTP/1.0\r\n"
+                                        "Host: example.com\r\n"
+                                        "User-Agent: ns3-http-sst-client\r\n"
+                                        "\r\n");
+   return fixed + path.size() + std::to_string(request.size).size() +
+          HttpCacheQuery(request).size() + HttpCacheHeaders(request).size();
+ }
+ 
+ static uint32_t HttpResponseHeaderLength(uint32_t size) {
+   static const uint32_t fixed = strlen("HTTP/1.0 200 OK\r\n"
+                                        "Content-Type: text/html\r\n"
+                                        "Content-Length: \r\n"
+                                        "\r\n");
+   return fixed + std::to_string(size).size();
+ }
+ 
+ // HTTP/1.0 SST Client Application
+ class HttpSstClient : public Application {
+ public:
+   HttpSstClient() : m_running(false), m_currentPageIndex(0), m_waitingForPrimary(true),
+                    m_socket(nullptr), m_connected(false), m_channel(CreateObject<SstChannel>()),
+                    m_channelId(1), m_nextStreamId(1), m_streamWindow(16),
+                    m_batchRequests(true), m_pageGap(Seconds(0)) {
+     m_sampler.SetTrace(&m_transportTrace);
+   }
+   virtual ~HttpSstClient() {}
+ 
+   static TypeId GetTypeId() {
+     static TypeId tid = TypeId("ns3::HttpSstClient")
+       .SetParent<Application>()
+       .SetGroupName("Applications")
+       .AddConstructor<HttpSstClient>()
+       .AddTraceSource("TransportSample", "The channel's congestion control state, every sample interval it changed",
+                       MakeTraceSourceAccessor(&HttpSstClient::m_transportTrace),
+                       "ns3::HttpTransportSampler::SampleTracedCallback");
+     return tid;
+   }
+ 
+   // Pages are pulled from the source as the client gets to them
+   void SetPageSource(Ptr<HttpPageSource> source) {
+     m_feed.SetSource(source);
+   }
+ 
+   void SetServer(Address address) {
+     m_serverAddress = address;
+   }
+ 
+   // Receive window advertised for each response, as a 5-bit exponent
+   void SetStreamWindow(uint8_t window) {
+     m_streamWindow = window;
+   }
+ 
+   // Pack as many queued requests into each INIT packet as fit
+   void SetBatchRequests(bool batch) {
+     m_batchRequests = batch;
+   }
+   
+   // Wait this long after a page before starting the next, e.g. to let
+   // the server expire the channel in between
+   void SetPageGap(Time gap) {
+     m_pageGap = gap;
+   }
+ 
+   void SetResults(HttpResults* results, uint32_t clientId) {
+     m_feed.SetResults(results, clientId);
+     m_sampler.SetResults(results, clientId, HTTP_RESULTS_SAMPLE_PACKETS);
+   }
+ 
+   // The channel's congestion control state, for trace sinks; the object
+   // lasts as long as the client
+   Ptr<SstChannel> GetChannel() const {
+     return m_channel;
+   }
+   
+   // Report the pages the run ended before this client finished
+   void ReportRemainingPages() {
+     m_feed.FinishAll();
+   }
+ 
+ protected:
+   virtual void DoDispose() {
+     CleanupSocket();
+     Application::DoDispose();
+   }
+ 
+   virtual void StartApplication() {
+     HTTP_LOG_FUNCTION(this);
+     m_running = true;
+     
+     // Initialize SST channel
+     m_channel->Reset();
+     m_channelId = 1;
+     m_sampler.Start([this]() { SampleTransport(); });
+     
+     ProcessNextPage();
+   }
+ 
+   virtual void StopApplication() {
+     HTTP_LOG_FUNCTION(this);
+     m_running = false;
+     m_sampler.Stop();
+     CleanupSocket();
+   }
+ 
+ private:
+   // The client has one channel; its queue is every request not yet answered
+   void SampleTransport() {
+     m_sampler.Add(0, m_channel->cwnd, m_channel->ssthresh, m_channel->packetsInFlight,
+                   m_pendingRequests.size() + m_activeStreams.size(),
+                   MicroSeconds(m_channel->rtt.Get()), MicroSeconds(m_channel->rto.Get()));
+   }
+   
+   void CleanupSocket() {
+     if (m_socket) {
+       m_socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+       m_socket->Close();
+       m_socket = nullptr;
+     }
+     
+     Simulator::Cancel(m_channel->retransmitTimer);
+     Simulator::Cancel(m_channel->ackTimer);
+     
+     m_connected = false;
+     m_activeStreams.clear();
+     m_windowUpdates.clear();
+     m_channel->pendingPackets.Clear();
+     m_channel->packetsInFlight = 0;
+     while (!m_pendingRequests.empty()) {
+       m_pendingRequests.pop();
+     }
+   }
+ 
+   void ProcessNextPage() {
+     HTTP_PROFILE_SCOPE(HTTP_PROFILE_PROCESS_NEXT_PAGE);
+     if (!m_running || !m_feed.Next()) {
+       HTTP_LOG_INFO("All pages processed");
+       return;
+     }
+     
+     WebPage& page = m_feed.Current();
+     
+     if (page.requests.empty()) {
+       NS_LOG_WARN("Empty page found at index " << m_currentPageIndex);
+       page.isComplete = true;
+       FinishPage();
+       Simulator::Schedule(MicroSeconds(1), &HttpSstClient::ProcessNextPage, this);
+       return;
+     }
+     
+     // Ensure primary request is first
+     for (size_t i = 0; i < page.requests.size(); i++) {
+       if (page.requests[i].isPrimary) {
+         if (i != 0) {
+           std::swap(page.requests[0], page.requests[i]);
+         }
+         page.primaryRequestId = page.requests[0].id;
+         break;
+       }
+     }
+     
+     // Reset page state
+     page.primaryCompleted = false;
+     page.isComplete = false;
+     m_waitingForPrimary = true;
+     
+     // Clear pending requests
+     while (!m_pendingRequests.empty()) {
+       m_pendingRequests.pop();
+     }
+     
+     HTTP_LOG_INFO("Starting page " << m_currentPageIndex << " with " << page.requests.size() << " requests");
+     
+     // Set a timeout for the entire page
+     Simulator::Schedule(Seconds(30), &HttpSstClient::HandlePageTimeout, this, m_currentPageIndex);
+     
+     StartPrimaryRequest();
+   }
+ 
+   void StartPrimaryRequest() {
+     if (!m_running || !m_feed.HasPage()) {
+       return;
+     }
+     
+     WebPage& page = m_feed.Current();
+     if (page.requests.empty()) return;
+     
+     HTTP_LOG_INFO("Starting primary request for page " << m_currentPageIndex);
+     
+     // Queue primary request
+     m_pendingRequests.push(&page.requests[0]);
+     
+     // Establish SST channel if needed
+     if (!m_connected) {
+       EstablishSstChannel();
+     } else {
+       ProcessPendingRequests();
+     }
+   }
+ 
+   void StartSecondaryRequests() {
+     if (!m_running || !m_feed.HasPage()) {
+       return;
+     }
+     
+     WebPage& page = m_feed.Current();
+     if (page.requests.size() <= 1) return;
+     
+     HTTP_LOG_INFO("Starting " << (page.requests.size() - 1) << " secondary requests for page " << m_currentPageIndex);
+     
+     // Queue all secondary requests - SST supports unlimited parallel streams
+     for (size_t i = 1; i < page.requests.size(); i++) {
+       m_pendingRequests.push(&page.requests[i]);
+     }
+     
+     ProcessPendingRequests();
+   }
+ 
+   void EstablishSstChannel() {
+     HTTP_LOG_FUNCTION(this);
+     
+     if (m_socket) {
+       CleanupSocket();
+     }
+     
+     // Create UDP socket for SST channel
+     m_socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+     m_socket->Bind();
+     m_socket->Connect(m_serverAddress);
+     
+     m_socket->SetRecvCallback(MakeCallback(&HttpSstClient::HandleRead, this));
+     
+     m_connected = true;
+     
+     HTTP_LOG_INFO("SST channel established over UDP");
+     
+     ProcessPendingRequests();
+   }
+ 
+   void ProcessPendingRequests() {
+     if (!m_running || !m_connected) return;
+     
+     // Each packet takes one slot of the congestion window however many
+     // requests it carries
+     while (!m_pendingRequests.empty() && 
+            m_channel->CanSend()) {
+       SendRequests();
+     }
+   }
+ 
+   // Open streams for queued requests and send their INIT records in one
+   // packet. With batching, small requests share the packet as ephemeral
+   // streams: no INIT packet, ACK or timer of their own.
+   void SendRequests() {
+     if (!m_connected) {
+       NS_LOG_ERROR("Cannot create stream - SST channel not established");
+       return;
+     }
+     
+     SstChannelHeader chanHdr;
+     chanHdr.channelId = m_channelId;
+     chanHdr.packetSeqNum = m_channel->nextPacketSeq++;
+     m_channel->FillAck(chanHdr);
+     uint32_t packetSeq = chanHdr.packetSeqNum;
+     
+     Ptr<Packet> body = Create<Packet>();
+     std::vector<uint16_t> opened;
+     uint32_t room = SST_SEGMENT_SIZE;
+     while (!m_pendingRequests.empty()) {
+       WebRequest* request = m_pendingRequests.front();
+       uint32_t length = HttpRequestLength(*request, RequestPath(request));
+       uint32_t recordSize = length;
+       if (!opened.empty()) {
+         // Extra records pay for their own stream header
+         recordSize += SstStreamHeader().GetSerializedSize();
+         if (!m_batchRequests || recordSize > room) {
+           break;
+         }
+       }
+       m_pendingRequests.pop();
+       room -= std::min(room, recordSize);
+       
+       SstStream& stream = CreateStream(request, length);
+       AppendInitRecord(body, stream);
+       opened.push_back(stream.streamId);
+     }
+     
+     int result = m_socket->Send(CreateSstPacket(chanHdr, body));
+     if (result == -1) {
+       NS_LOG_ERROR("Failed to send SST INIT packet");
+       return;
+     }
+     
+     // Track packet for retransmission
+     SstPendingPacket& pending = m_channel->Track(packetSeq, body);
+     for (uint16_t streamId : opened) {
+       SstStream& stream = m_activeStreams[streamId];
+       stream.initPacketSeq = packetSeq;
+       stream.sentBytes = stream.sendLength;
+       pending.records.push_back({streamId, stream.sendLength});
+     }
+     HttpCounters::Get().Add(HTTP_COUNTER_REQUESTS_SENT, opened.size());
+     ArmRetransmitTimer();
+     
+     HTTP_LOG_INFO("Sent SST INIT packet for " << opened.size() << " stream(s) starting at "
+                 << opened.front() << " (packet seq=" << packetSeq << ", RTO=" << m_channel->rto << "us)");
+   }
+ 
+   static std::string RequestPath(const WebRequest* request) {
+     std::string path = request->url;
+     std::istringstream iss(request->url);
+     std::string method, extractedPath, version;
+     if (iss >> method >> extractedPath >> version) {
+       path = extractedPath;
+     }
+     return path;
+   }
+ 
+   SstStream& CreateStream(WebRequest* request, uint32_t requestLength) {
+     uint16_t streamId = m_nextStreamId++;
+     SstStream& stream = m_activeStreams[streamId];
+     
+     stream.streamId = streamId;
+     stream.request = request;
+     stream.isActive = true;
+     stream.nextByteSeq = 0;
+     stream.expectedByteSeq = 0;
+     stream.sendLength = requestLength;
+     
+     // A request sent again on a new channel keeps its first start
+     if (request->startTime.IsZero()) {
+       request->startTime = Simulator::Now();
+     }
+     
+     HTTP_LOG_INFO("Created SST stream " << streamId << " for request " 
+                 << (request->isPrimary ? "[PRIMARY]" : "[SECONDARY]") 
+                 << " URL: " << request->url << " (size=" << request->size << ")");
+     return stream;
+   }
+ 
+   void AppendInitRecord(Ptr<Packet> body, const SstStream& stream) {
+     SstStreamHeader streamHdr;
+     streamHdr.localStreamId = stream.streamId;
+     streamHdr.byteSeqNum = 0;
+     streamHdr.window = m_streamWindow;
+     streamHdr.flags = SST_FLAG_INIT | SST_FLAG_PUSH;  // The whole request is in one record
+     
+     // The request header stands in for the start of the GET; the rest is virtual
+     SstRequestHeader requestHdr;
+     requestHdr.responseSize = stream.request->size;
+     requestHdr.flags = stream.request->isPrimary ? SST_REQUEST_PRIMARY : 0;
+     if (stream.request->validator != 0) {
+       requestHdr.lastModified = stream.request->lastModified;
+       requestHdr.ifModifiedSince = stream.request->validator;
+     }
+     Ptr<Packet> payload = Create<Packet>(stream.sendLength - requestHdr.GetSerializedSize());
+     payload->AddHeader(requestHdr);
+     
+     AppendSstRecord(body, streamHdr, payload);
+   }
+ 
+   void HandleRead(Ptr<Socket> socket) {
+     HTTP_PROFILE_SCOPE(HTTP_PROFILE_CLIENT_READ);
+     HTTP_LOG_FUNCTION(this);
+     
+     if (!m_running) return;
+     
+     Ptr<Packet> packet;
+     Address from;
+     
+     while ((packet = socket->RecvFrom(from))) {
+       ProcessSstPacket(packet);
+     }
+   }
+ 
+   void ProcessSstPacket(Ptr<Packet> packet) {
+     HTTP_PROFILE_SCOPE(HTTP_PROFILE_PROCESS_SST_PACKET);
+     SstChannelHeader chanHdr;
+     
+     if (!ParseSstPacket(packet, chanHdr)) {
+       NS_LOG_WARN("Failed to parse SST packet");
+       return;
+     }
+     
+     // A packet of an earlier channel is answered with a RESET so the
+     // server lets go of it; a RESET for one needs nothing more
+     if (chanHdr.channelId != m_channelId) {
+       if (!chanHdr.IsReset()) {
+         SendReset(chanHdr.channelId);
+       }
+       return;
+     }
+     if (chanHdr.IsReset()) {
+       RestartChannel();
+       return;
+     }
+     m_channel->Widen(chanHdr);
+     
+     // Update congestion control based on ACK
+     if (chanHdr.ackCount > 0) {
+       UpdateCongestionControl(chanHdr.ackSeqNum, chanHdr.ackCount);
+     }
+     
+     // Pure ACKs are not acknowledged themselves
+     if (packet->GetSize() == 0) {
+       return;
+     }
+     if (m_channel->RecordReceived(chanHdr.packetSeqNum)) {
+       SendAck();
+     } else if (!m_channel->ackTimer.IsPending()) {
+       m_channel->ackTimer = Simulator::Schedule(MicroSeconds(SST_ACK_DELAY_US),
+         &HttpSstClient::SendAck, this);
+     }
+     
+     // The server may have coalesced segments of several responses
+     SstStreamHeader streamHdr;
+     Ptr<Packet> payload;
+     while (NextSstRecord(packet, streamHdr, payload)) {
+       auto it = m_activeStreams.find(streamHdr.localStreamId);
+       if (it != m_activeStreams.end()) {
+         ReceiveSegment(it->second, streamHdr.byteSeqNum, payload->GetSize(),
+                        (streamHdr.flags & SST_FLAG_CLOSE) != 0);
+       }
+     }
+     SendWindowUpdates();
+   }
+   
+   // Pure ACKs carry packet sequence 0: they take no sequence space and
+   // are never acknowledged
+   void SendAck() {
+     if (!m_socket) return;
+     
+     SstChannelHeader chanHdr;
+     chanHdr.channelId = m_channelId;
+     chanHdr.packetSeqNum = 0;
+     m_channel->FillAck(chanHdr);
+     
+     m_socket->Send(CreateSstPacket(chanHdr, nullptr));
+   }
+   
+   void SendReset(uint8_t channelId) {
+     if (!m_socket) return;
+     
+     SstChannelHeader chanHdr;
+     chanHdr.channelId = channelId;
+     m_socket->Send(CreateSstPacket(chanHdr, nullptr));
+     HttpCount(HTTP_COUNTER_SST_RESETS);
+   }
+   
+   // The server has no state for the channel: start a new one under the
+   // next channel ID and send the unanswered requests again, in the order
+   // they went out, ahead of the ones still queued
+   void RestartChannel() {
+     HTTP_LOG_INFO("SST channel " << (uint32_t) m_channelId << " reset by the server, resending "
+                 << m_activeStreams.size() << " request(s)");
+     
+     std::queue<WebRequest*> unanswered;
+     for (const auto& entry : m_activeStreams) {
+       if (entry.second.request) {
+         unanswered.push(entry.second.request);
+       }
+     }
+     while (!m_pendingRequests.empty()) {
+       unanswered.push(m_pendingRequests.front());
+       m_pendingRequests.pop();
+     }
+     m_pendingRequests.swap(unanswered);
+     m_activeStreams.clear();
+     m_windowUpdates.clear();
+     
+     m_channel->Reset();
+     m_channelId = m_channelId == 255 ? 1 : m_channelId + 1;
+     ProcessPendingRequests();
+   }
+   
+   // Track the response in byte order; segments can arrive out of order
+   // after a loss because retransmissions go out under new packet sequence
+   // numbers. Only byte ranges are kept, the payload itself is virtual.
+   void ReceiveSegment(SstStream& stream, uint32_t byteSeq, uint32_t length, bool close) {
+     // Any response data means the request arrived, even if its ACK was lost
+     if (stream.initPacketSeq != 0) {
+       UpdateCongestionControl(stream.initPacketSeq, 1);
+       stream.initPacketSeq = 0;
+     }
+     
+     uint32_t end = byteSeq + length;
+     if (close) {
+       stream.responseLength = end;
+     }
+     
+     if (byteSeq > stream.expectedByteSeq) {
+       uint32_t& bufferedEnd = stream.outOfOrder[byteSeq];
+       bufferedEnd = std::max(bufferedEnd, end);
+       return;
+     }
+     if (end <= stream.expectedByteSeq) {
+       return; // Duplicate
+     }
+     stream.expectedByteSeq = end;
+     
+     // Pull in any buffered ranges that are now contiguous
+     auto next = stream.outOfOrder.begin();
+     while (next != stream.outOfOrder.end() && next->first <= stream.expectedByteSeq) {
+       stream.expectedByteSeq = std::max(stream.expectedByteSeq, next->second);
+       next = stream.outOfOrder.erase(next);
+     }
+     
+     // The application consumes in-order data as it arrives; once half of
+     // the window is used, advertise it again from the new offset
+     bool finished = stream.responseLength != 0 && stream.expectedByteSeq >= stream.responseLength;
+     if (m_streamWindow < 31 && !finished && !stream.windowUpdatePending &&
+         stream.expectedByteSeq - stream.advertisedByteSeq >= std::max(SstWindowBytes(m_streamWindow) / 2, 1u)) {
+       stream.windowUpdatePending = true;
+       m_windowUpdates.push_back(stream.streamId);
+     }
+     
+     CheckStreamComplete(stream);
+   }
+   
+   // Send the queued window updates. They go in sequenced packets of their
+   // own, acknowledged and retransmitted like requests, so a lost update
+   // cannot stall its stream.
+   void SendWindowUpdates() {
+     uint32_t recordSize = SstStreamHeader().GetSerializedSize();
+     while (m_running && m_connected && !m_windowUpdates.empty() && m_channel->CanSend()) {
+       Ptr<Packet> body = Create<Packet>();
+       uint32_t room = SST_SEGMENT_SIZE;
+       while (!m_windowUpdates.empty() && room >= recordSize) {
+         auto it = m_activeStreams.find(m_windowUpdates.front());
+         m_windowUpdates.pop_front();
+         if (it == m_activeStreams.end()) {
+           continue;   // Completed since it was queued
+         }
+         SstStream& stream = it->second;
+         stream.windowUpdatePending = false;
+         stream.advertisedByteSeq = stream.expectedByteSeq;
+         
+         SstStreamHeader streamHdr;
+         streamHdr.localStreamId = stream.streamId;
+         streamHdr.byteSeqNum = stream.expectedByteSeq;
+         streamHdr.window = m_streamWindow;
+         streamHdr.flags = 0;
+         AppendSstRecord(body, streamHdr, Create<Packet>(0));
+         room -= recordSize;
+       }
+       if (body->GetSize() == 0) {
+         return;
+       }
+       
+       SstChannelHeader chanHdr;
+       chanHdr.channelId = m_channelId;
+       chanHdr.packetSeqNum = m_channel->nextPacketSeq++;
+       m_channel->FillAck(chanHdr);
+       if (m_socket->Send(CreateSstPacket(chanHdr, body)) == -1) {
+         NS_LOG_ERROR("Failed to send SST window update");
+         return;
+       }
+       m_channel->Track(chanHdr.packetSeqNum, body);
+       ArmRetransmitTimer();
+     }
+   }
+ 
+   void ArmRetransmitTimer() {
+     if (m_channel->retransmitTimer.IsPending()) {
+       return;
+     }
+     Time delay = m_channel->NextTimeout();
+     if (!delay.IsNegative()) {
+       m_channel->retransmitTimer = Simulator::Schedule(delay,
+         &HttpSstClient::HandleRetransmissionTimeout, this);
+     }
+   }
+   
+   void HandleRetransmissionTimeout() {
+     HTTP_PROFILE_SCOPE(HTTP_PROFILE_RETRANSMISSION_TIMEOUT);
+     if (!m_running) return;
+     
+     std::vector<uint32_t> expired = m_channel->CollectExpired();
+     if (!expired.empty()) {
+       m_channel->OnTimeout();
+       HttpCount(HTTP_COUNTER_RTO_EXPIRIES);
+       NS_LOG_WARN(expired.size() << " packet(s) timed out, cwnd reset to 1, RTO="
+                   << m_channel->rto << "us");
+     }
+     
+     for (uint32_t packetSeqNum : expired) {
+       SstPendingPacket* pending = m_channel->pendingPackets.Find(packetSeqNum);
+       if (!pending) {
+         continue;
+       }
+       pending->retransmitCount++;
+       
+       // Give up after 5 retransmission attempts
+       if (pending->retransmitCount >= 5) {
+         NS_LOG_ERROR("Giving up on packet " << packetSeqNum << " after 5 retransmissions");
+         HttpCount(HTTP_COUNTER_GIVE_UPS);
+         m_channel->packetsInFlight--;
+         m_channel->pendingPackets.Erase(packetSeqNum);
+         continue;
+       }
+       
+       // Retransmit with new sequence number (SST requirement)
+       HttpCount(HTTP_COUNTER_RETRANSMITS);
+       RetransmitPacket(*pending);
+     }
+     
+     ArmRetransmitTimer();
+   }
+   
+   void RetransmitPacket(SstPendingPacket& pending) {
+     // Create new packet with new sequence number
+     SstChannelHeader chanHdr;
+     chanHdr.channelId = m_channelId;
+     chanHdr.packetSeqNum = m_channel->nextPacketSeq++;  // NEW sequence number
+     m_channel->FillAck(chanHdr);
+     
+     uint32_t packetSeq = chanHdr.packetSeqNum;
+     
+     // Create and send SST packet
+     Ptr<Packet> packet = CreateSstPacket(chanHdr, pending.body);
+     
+     int result = m_socket->Send(packet);
+     if (result == -1) {
+       NS_LOG_ERROR("Failed to retransmit packet");
+       return;
+     }
+     
+     // Track under the new sequence number
+     uint32_t oldSeqNum = pending.packetSeqNum;
+     SstPendingPacket& newPending = m_channel->Resend(oldSeqNum, packetSeq);
+     
+     for (const SstRecordRef& record : newPending.records) {
+       auto stream = m_activeStreams.find(record.streamId);
+       if (stream != m_activeStreams.end() && stream->second.initPacketSeq == oldSeqNum) {
+         stream->second.initPacketSeq = packetSeq;
+       }
+     }
+     
+     HTTP_LOG_INFO("Retransmitted packet " << oldSeqNum << " as " << packetSeq);
+   }
+   
+   void UpdateCongestionControl(uint32_t ackSeqNum, uint32_t ackCount) {
+     HTTP_PROFILE_SCOPE(HTTP_PROFILE_CONGESTION_CONTROL);
+     uint32_t newlyAcked = m_channel->Acknowledge(ackSeqNum, ackCount);
+     
+     // Resend packets the ACKs have skipped over instead of waiting for the RTO
+     for (uint32_t lostSeq : m_channel->CollectLost()) {
+       SstPendingPacket* pending = m_channel->pendingPackets.Find(lostSeq);
+       m_channel->OnFastRetransmit(lostSeq);
+       HttpCount(HTTP_COUNTER_FAST_RETRANSMITS);
+       HTTP_LOG_INFO("Fast retransmit of packet " << lostSeq << ", cwnd=" << m_channel->cwnd);
+       RetransmitPacket(*pending);
+     }
+     
+     if (newlyAcked == 0) {
+       return;
+     }
+     
+     HTTP_LOG_DEBUG("ACK " << ackSeqNum << ": cwnd=" << m_channel->cwnd 
+                  << " ssthresh=" << m_channel->ssthresh 
+                  << " rtt=" << m_channel->rtt << "us rto=" << m_channel->rto << "us");
+     
+     // Window updates first: they unblock responses already under way
+     SendWindowUpdates();
+     ProcessPendingRequests();
+   }
+ 
+   void CheckStreamComplete(SstStream& stream) {
+     if (!stream.request) return;
+     
+     // The response is complete once everything up to the CLOSE segment is in
+     if (stream.responseLength == 0) {
+       return;
+     }
+     
+     if (stream.expectedByteSeq >= stream.responseLength) {
+       stream.request->completeTime = Simulator::Now();
+       stream.request->isComplete = true;
+       Time responseTime = stream.request->completeTime - stream.request->startTime;
+       HttpCounters::Get().AddResponse(responseTime);
+       
+       bool isPrimary = stream.request->isPrimary;
+       
+       HTTP_LOG_INFO("SST stream " << stream.streamId << " completed in " 
+                   << responseTime.GetSeconds() << " seconds"
+                   << (isPrimary ? " [PRIMARY]" : " [SECONDARY]"));
+       
+       if (isPrimary) {
+         HandlePrimaryRequestComplete();
+       }
+       
+       // Remove completed stream
+       m_activeStreams.erase(stream.streamId);
+       
+       // Check if page is complete
+       CheckPageComplete();
+     }
+   }
+ 
+   void HandlePrimaryRequestComplete() {
+     if (!m_feed.HasPage()) return;
+     
+     WebPage& page = m_feed.Current();
+     page.primaryCompleted = true;
+     m_waitingForPrimary = false;
+     
+     HTTP_LOG_INFO("Primary request completed for page " << m_currentPageIndex << " - starting secondary requests");
+     
+     StartSecondaryRequests();
+   }
+ 
+   void CheckPageComplete() {
+     if (!m_feed.HasPage()) return;
+     
+     WebPage& page = m_feed.Current();
+     
+     // Count completed requests
+     uint32_t completedRequests = 0;
+     for (const auto& req : page.requests) {
+       if (!req.completeTime.IsZero()) {
+         completedRequests++;
+       }
+     }
+     
+     // Check if all requests are complete
+     if (completedRequests >= page.requests.size()) {
+       page.isComplete = true;
+       
+       // Calculate page load time
+       Time pageStartTime = Seconds(0);
+       Time pageEndTime = Seconds(0);
+       
+       // Find primary request start time
+       for (const auto& req : page.requests) {
+         if (req.isPrimary && !req.startTime.IsZero()) {
+           pageStartTime = req.startTime;
+           break;
+         }
+       }
+       
+       // Find latest completion time
+       for (const auto& req : page.requests) {
+         if (!req.completeTime.IsZero() && 
+             (pageEndTime.IsZero() || req.completeTime > pageEndTime)) {
+           pageEndTime = req.completeTime;
+         }
+       }
+       
+       if (!pageStartTime.IsZero() && !pageEndTime.IsZero()) {
+         double pageTime = (pageEndTime - pageStartTime).GetSeconds();
+         HTTP_LOG_INFO("Page " << m_currentPageIndex << " completed in " 
+                     << pageTime << " seconds (all " << completedRequests << " requests done)");
+       }
+       
+       FinishPage();
+       Simulator::Schedule(m_pageGap + MicroSeconds(10), &HttpSstClient::ProcessNextPage, this);
+     }
+   }
+ 
+   // The page is done: drop every pointer still held into it and hand it
+   // to the results, which frees it
+   void FinishPage() {
+     while (!m_pendingRequests.empty()) {
+       m_pendingRequests.pop();
+     }
+     m_activeStreams.clear();
+     m_windowUpdates.clear();
+     m_feed.Finish();
+     m_currentPageIndex++;
+   }
+ 
+   void HandlePageTimeout(uint32_t pageIndex) {
+     if (!m_running || pageIndex != m_currentPageIndex) {
+       return;
+     }
+     
+     WebPage& page = m_feed.Current();
+     
+     uint32_t completedRequests = 0;
+     for (const auto& req : page.requests) {
+       if (!req.completeTime.IsZero()) {
+         completedRequests++;
+       }
+     }
+     
+     NS_LOG_WARN("Page " << m_currentPageIndex << " timeout - only " << completedRequests 
+                 << "/" << page.requests.size() << " requests completed. Moving to next page.");
+     
+     // Mark incomplete requests as completed (for statistics)
+     for (auto& req : page.requests) {
+       if (req.completeTime.IsZero()) {
+         req.completeTime = Simulator::Now();
+         HttpCount(HTTP_COUNTER_REQUEST_TIMEOUTS);
+       }
+     }
+     
+     // Clear active streams for this page
+     m_activeStreams.clear();
+     
+     page.isComplete = true;
+     FinishPage();
+     Simulator::Schedule(m_pageGap + MicroSeconds(10), &HttpSstClient::ProcessNextPage, this);
+   }
+ 
+   bool m_running;
+   Address m_serverAddress;
+   HttpPageFeed m_feed;                        // Page being replayed, pulled from the source
+   uint32_t m_currentPageIndex;
+   bool m_waitingForPrimary;
+   
+   // SST state
+   Ptr<Socket> m_socket;
+   bool m_connected;
+   Ptr<SstChannel> m_channel;                 // Shared congestion control
+   uint8_t m_channelId;                       // Bumped each time the server resets the channel
+   std::map<uint16_t, SstStream> m_activeStreams;
+   uint16_t m_nextStreamId;
+   uint8_t m_streamWindow;                    // Advertised receive window exponent
+   std::deque<uint16_t> m_windowUpdates;      // Streams whose window is due to be advertised again
+   bool m_batchRequests;
+   Time m_pageGap;                            // Wait between pages
+   std::queue<WebRequest*> m_pendingRequests;
+   HttpTransportSampler m_sampler;
+   TracedCallback<const HttpResultsSampleRecord&> m_transportTrace;
+ };
+ 
+ // A client's channel as the server sees it: where it comes from and the
+ // channel ID in its header
+ struct SstChannelKey {
+   uint32_t address;               // Client IPv4 address
+   uint16_t port;                  // Client UDP port
+   uint8_t channelId;
+   
+   SstChannelKey() : address(0), port(0), channelId(0) {}
+   SstChannelKey(const InetSocketAddress& from, uint8_t id)
+     : address(from.GetIpv4().Get()), port(from.GetPort()), channelId(id) {}
+   
+   bool operator==(const SstChannelKey& other) const {
+     return address == other.address && port == other.port && channelId == other.channelId;
+   }
+   
+   // Fibonacci hashing of the packed key; the high bits are the best mixed
+   uint32_t Hash() const {
+     uint64_t packed = (uint64_t) address << 24 | (uint64_t) port << 8 | channelId;
+     return (uint32_t) ((packed * 0x9E3779B97F4A7C15ULL) >> 32);
+   }
+ };
+ 
+ inline std::ostream& operator<<(std::ostream& os, const SstChannelKey& key) {
+   return os << Ipv4Address(key.address) << ":" << key.port << "/" << (uint32_t) key.channelId;
+ }
+ 
+ // Server side of one client's SST channel
+ struct SstServerChannel {
+   SstChannelKey key;
+   Address clientAddr;
+   Ptr<SstChannel> channel;                   // Congestion control for the responses
+   std::map<uint16_t, SstStream> streams;     // Responses not yet fully acknowledged
+   std::deque<uint16_t> sendQueue;            // Streams with unsent bytes, in scheduling order
+   Time lastActivity;                         // Last packet from the client
+   uint32_t number;                           // Order of the channel's first packet, from 1
+   std::vector<uint64_t> finished;            // Bitmap of the stream IDs answered in full
+   
+   SstServerChannel() : channel(CreateObject<SstChannel>()), number(0) {}
+   
+   // A late duplicate INIT must not reopen a stream that was answered and
+   // erased. 16-bit IDs wrap, so opening a stream forgets the ID half the
+   // space ahead, which the client only reuses after another 32768 streams.
+   bool IsFinished(uint16_t streamId) const {
+     return !finished.empty() && (finished[streamId >> 6] >> (streamId & 63) & 1) != 0;
+   }
+   
+   void MarkFinished(uint16_t streamId) {
+     if (finished.empty()) {
+       finished.resize(65536 / 64);
+     }
+     finished[streamId >> 6] |= (uint64_t) 1 << (streamId & 63);
+   }
+   
+   void OpenStream(uint16_t streamId) {
+     uint16_t reused = streamId + 0x8000;
+     if (!finished.empty()) {
+       finished[reused >> 6] &= ~((uint64_t) 1 << (reused & 63));
+     }
+   }
+   
+   // Nothing left to send, acknowledge or retransmit
+   bool IsIdle() const {
+     return streams.empty() && channel->packetsInFlight == 0 && channel->ackPending == 0;
+   }
+ };
+ 
+ // The server's channels in a flat open-addressing table (linear probing,
+ // power-of-two size, at most 3/4 full), so a packet costs one hash and a
+ // short probe however many clients there are. Slots only hold the key and
+ // an index; the channels themselves live in a deque, so references to
+ // them stay valid until that channel is erased.
+ class SstChannelTable {
+ public:
+   SstChannelTable() : m_slots(64), m_mask(63), m_count(0) {}
+   
+   SstServerChannel* Find(const SstChannelKey& key) {
+     uint32_t i = Probe(key);
+     return m_slots[i].used ? &m_entries[m_slots[i].entry] : nullptr;
+   }
+   
+   // The channel for key, created empty if it is new
+   SstServerChannel& FindOrInsert(const SstChannelKey& key) {
+     uint32_t i = Probe(key);
+     if (m_slots[i].used) {
+       return m_entries[m_slots[i].entry];
+     }
+     if ((m_count + 1) * 4 > m_slots.size() * 3) {
+       Grow();
+       i = Probe(key);
+     }
+     
+     uint32_t entry;
+     if (m_freeEntries.empty()) {
+       entry = m_entries.size();
+       m_entries.emplace_back();
+     } else {
+       entry = m_freeEntries.back();
+       m_freeEntries.pop_back();
+     }
+     m_slots[i].key = key;
+     m_slots[i].entry = entry;
+     m_slots[i].used = true;
+     m_count++;
+     
+     SstServerChannel& channel = m_entries[entry];
+     channel.key = key;
+     return channel;
+   }
+   
+   // Backward-shift deletion keeps every probe chain unbroken without
+   // tombstones
+   void Erase(const SstChannelKey& key) {
+     uint32_t i = Probe(key);
+     if (!m_slots[i].used) {
+       return;
+     }
+     m_entries[m_slots[i].entry] = SstServerChannel();
+     m_freeEntries.push_back(m_slots[i].entry);
+     m_count--;
+     
+     uint32_t j = i;
+     while (true) {
+       j = (j + 1) & m_mask;
+       if (!m_slots[j].used) {
+         break;
+       }
+       // Slot j may move into the hole unless its home lies in (i, j]
+       uint32_t home = m_slots[j].key.Hash() & m_mask;
+       bool stays = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+       if (!stays) {
+         m_slots[i] = m_slots[j];
+         i = j;
+       }
+     }
+     m_slots[i].used = false;
+   }
+   
+   template <typename F>
+   void ForEach(F f) {
+     for (const Slot& slot : m_slots) {
+       if (slot.used) {
+         f(m_entries[slot.entry]);
+       }
+     }
+   }
+   
+   void Clear() {
+     *this = SstChannelTable();
+   }
+   
+   uint32_t Size() const {
+     return m_count;
+   }
+   
+ private:
+   struct Slot {
+     SstChannelKey key;
+     uint32_t entry;               // Index into m_entries
+     bool used;
+     Slot() : entry(0), used(false) {}
+   };
+   
+   // The key's slot, or the free slot that ends its probe chain
+   uint32_t Probe(const SstChannelKey& key) const {
+     uint32_t i = key.Hash() & m_mask;
+     while (m_slots[i].used && !(m_slots[i].key == key)) {
+       i = (i + 1) & m_mask;
+     }
+     return i;
+   }
+   
+   void Grow() {
+     std::vector<Slot> old;
+     old.swap(m_slots);
+     m_slots.resize(old.size() * 2);
+     m_mask = m_slots.size() - 1;
+     for (const Slot& slot : old) {
+       if (slot.used) {
+         m_slots[Probe(slot.key)] = slot;
+       }
+     }
+   }
+   
+   std::vector<Slot> m_slots;
+   uint32_t m_mask;
+   uint32_t m_count;
+   std::deque<SstServerChannel> m_entries;
+   std::vector<uint32_t> m_freeEntries;
+ };
+ 
+ // HTTP SST Server Application
+ class HttpSstServer : public Application {
+ public:
+   HttpSstServer() : m_socket(nullptr), m_running(false), m_scheduler(SST_SCHED_FIFO),
+                    m_coalesce(true), m_channelIdleTimeout(Seconds(0)), m_channelCount(0) {
+     m_sampler.SetTrace(&m_transportTrace);
+   }
+   virtual ~HttpSstServer() {}
+ 
+   static TypeId GetTypeId() {
+     static TypeId tid = TypeId("ns3::HttpSstServer")
+       .SetParent<Application>()
+       .SetGroupName("Applications")
+       .AddConstructor<HttpSstServer>()
+       .AddTraceSource("TransportSample", "Each channel's congestion control state, every sample interval it changed",
+                       MakeTraceSourceAccessor(&HttpSstServer::m_transportTrace),
+                       "ns3::HttpTransportSampler::SampleTracedCallback")
+       .AddTraceSource("ChannelOpened", "A client's first packet opened a channel, for sinks to follow it",
+                       MakeTraceSourceAccessor(&HttpSstServer::m_channelOpenedTrace),
+                       "ns3::HttpSstServer::ChannelOpenedTracedCallback");
+     return tid;
+   }
+   
+   // Signature of the "ChannelOpened" trace source: the channel's number in
+   // the transport samples and its congestion control state
+   typedef void (*ChannelOpenedTracedCallback)(uint32_t number, Ptr<SstChannel> channel);
+ 
+   void SetPort(uint16_t port) {
+     m_port = port;
+   }
+ 
+   void SetScheduler(SstScheduler scheduler) {
+     m_scheduler = scheduler;
+   }
+ 
+   // Let segments of several responses share a packet
+   void SetCoalesce(bool coalesce) {
+     m_coalesce = coalesce;
+   }
+ 
+   // Forget channels that have been idle this long, checked every timeout;
+   // zero keeps them for the whole run
+   void SetChannelIdleTimeout(Time timeout) {
+     m_channelIdleTimeout = timeout;
+   }
+ 
+   // Where the channels' transport samples go
+   void SetResults(HttpResults* results) {
+     m_sampler.SetResults(results, 0, HTTP_RESULTS_SAMPLE_SERVER | HTTP_RESULTS_SAMPLE_PACKETS);
+   }
+ 
+ protected:
+   virtual void DoDispose() {
+     if (m_socket) {
+       m_socket->Close();
+       m_socket = nullptr;
+     }
+     
+     CancelTimers();
+     m_clientChannels.Clear();
+     Application::DoDispose();
+   }
+ 
+   virtual void StartApplication() {
+     HTTP_LOG_FUNCTION(this);
+     m_running = true;
+     
+     if (!m_socket) {
+       m_socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+       InetSocketAddress local = InetSocketAddress(Ipv4Address::GetAny(), m_port);
+       m_socket->Bind(local);
+       
+       m_socket->SetRecvCallback(MakeCallback(&HttpSstServer::HandleRead, this));
+     }
+     
+     if (m_channelIdleTimeout.IsStrictlyPositive()) {
+       m_expiryEvent = Simulator::Schedule(m_channelIdleTimeout,
+         &HttpSstServer::ExpireIdleChannels, this);
+     }
+     m_sampler.Start([this]() { SampleTransport(); });
+     
+     HTTP_LOG_INFO("HTTP SST server bound to UDP port " << m_port);
+   }
+ 
+   virtual void StopApplication() {
+     HTTP_LOG_FUNCTION(this);
+     m_running = false;
+     
+     if (m_socket) {
+       m_socket->Close();
+       m_socket = nullptr;
+     }
+     
+     CancelTimers();
+     m_clientChannels.Clear();
+   }
+ 
+ private:
+   void CancelTimers() {
+     Simulator::Cancel(m_expiryEvent);
+     m_sampler.Stop();
+     m_clientChannels.ForEach([](SstServerChannel& client) {
+       Simulator::Cancel(client.channel->retransmitTimer);
+       Simulator::Cancel(client.channel->ackTimer);
+     });
+   }
+   
+   // One sample per channel, queueing the responses not yet acknowledged
+   void SampleTransport() {
+     m_clientChannels.ForEach([this](SstServerChannel& client) {
+       m_sampler.Add(client.number, client.channel->cwnd, client.channel->ssthresh,
+                     client.channel->packetsInFlight, client.streams.size(),
+                     MicroSeconds(client.channel->rtt.Get()), MicroSeconds(client.channel->rto.Get()));
+     });
+   }
+   
+   // Drop the channels nobody has used for m_channelIdleTimeout. A client
+   // that comes back later still acknowledges the old channel's packets;
+   // it is answered with a RESET and starts over under a new channel ID.
+   void ExpireIdleChannels() {
+     Time cutoff = Simulator::Now() - m_channelIdleTimeout;
+     std::vector<SstChannelKey> expired;
+     m_clientChannels.ForEach([&expired, cutoff](SstServerChannel& client) {
+       if (client.IsIdle() && client.lastActivity <= cutoff) {
+         expired.push_back(client.key);
+       }
+     });
+     for (const SstChannelKey& key : expired) {
+       SstServerChannel* client = m_clientChannels.Find(key);
+       Simulator::Cancel(client->channel->retransmitTimer);
+       Simulator::Cancel(client->channel->ackTimer);
+       m_clientChannels.Erase(key);
+     }
+     if (!expired.empty()) {
+       HTTP_LOG_INFO("SST server expired " << expired.size() << " idle channel(s), "
+                   << m_clientChannels.Size() << " left");
+     }
+     m_expiryEvent = Simulator::Schedule(m_channelIdleTimeout,
+       &HttpSstServer::ExpireIdleChannels, this);
+   }
+ 
+   void HandleRead(Ptr<Socket> socket) {
+     HTTP_PROFILE_SCOPE(HTTP_PROFILE_SERVER_READ);
+     HTTP_LOG_FUNCTION(this << socket);
+     
+     Ptr<Packet> packet;
+     Address from;
+     
+     while ((packet = socket->RecvFrom(from))) {
+       ProcessSstPacket(packet, from);
+     }
+   }
+ 
+   void ProcessSstPacket(Ptr<Packet> packet, Address clientAddr) {
+     HTTP_PROFILE_SCOPE(HTTP_PROFILE_PROCESS_SST_PACKET);
+     SstChannelHeader chanHdr;
+     
+     if (!ParseSstPacket(packet, chanHdr)) {
+       NS_LOG_WARN("Failed to parse SST packet");
+       return;
+     }
+     
+     SstChannelKey clientKey(InetSocketAddress::ConvertFrom(clientAddr), chanHdr.channelId);
+     
+     // The client has let go of the channel
+     if (chanHdr.IsReset()) {
+       SstServerChannel* stale = m_clientChannels.Find(clientKey);
+       if (stale) {
+         Simulator::Cancel(stale->channel->retransmitTimer);
+         Simulator::Cancel(stale->channel->ackTimer);
+         m_clientChannels.Erase(clientKey);
+       }
+       return;
+     }
+     
+     // Get or create client channel state
+     SstServerChannel& client = m_clientChannels.FindOrInsert(clientKey);
+     if (client.number == 0) {
+       // A new channel's client has received nothing. One acknowledging
+       // packets is back on a channel that expired here; the fresh state
+       // could not answer it (its sequence space starts over), so it is
+       // told to start a new channel.
+       if (chanHdr.ackCount > 0) {
+         m_clientChannels.Erase(clientKey);
+         SendReset(clientAddr, chanHdr.channelId);
+         return;
+       }
+       client.number = ++m_channelCount;
+       m_channelOpenedTrace(client.number, client.channel);
+     }
+     client.clientAddr = clientAddr;
+     client.lastActivity = Simulator::Now();
+     client.channel->Widen(chanHdr);
+     
+     HTTP_LOG_INFO("SST server processing packet from " << clientKey 
+                 << " (seq=" << chanHdr.packetSeqNum << ")");
+     
+     // ACKs for response data open the window for more segments
+     if (chanHdr.ackCount > 0) {
+       UpdateCongestionControl(clientKey, client, chanHdr.ackSeqNum, chanHdr.ackCount);
+     }
+     
+     // Pure ACKs are not acknowledged themselves
+     if (packet->GetSize() == 0) {
+       return;
+     }
+     bool ackNow = client.channel->RecordReceived(chanHdr.packetSeqNum);
+     
+     // Every record refreshes its stream's receive window, and each INIT
+     // record carries one request
+     SstStreamHeader streamHdr;
+     Ptr<Packet> payload;
+     while (NextSstRecord(packet, streamHdr, payload)) {
+       auto stream = client.streams.find(streamHdr.localStreamId);
+       if (stream != client.streams.end()) {
+         // Updates can arrive out of order; the window only moves forward
+         stream->second.windowEnd = std::max(stream->second.windowEnd,
+                                             SstWindowEnd(streamHdr.byteSeqNum, streamHdr.window));
+       }
+       
+       SstRequestHeader requestHdr;
+       if ((streamHdr.flags & SST_FLAG_INIT) != 0 &&
+           payload->GetSize() >= requestHdr.GetSerializedSize()) {
+         payload->RemoveHeader(requestHdr);
+         ProcessHttpRequest(requestHdr, streamHdr, client);
+       }
+     }
+     
+     // Response segments carry the ACK back if the windows let them go
+     // right away
+     SendPendingData(clientKey, client);
+     if (client.channel->ackPending == 0) {
+       return;
+     }
+     if (ackNow) {
+       SendAck(client);
+     } else if (!client.channel->ackTimer.IsPending()) {
+       client.channel->ackTimer = Simulator::Schedule(MicroSeconds(SST_ACK_DELAY_US),
+         &HttpSstServer::HandleAckTimeout, this, clientKey);
+     }
+   }
+ 
+   void ProcessHttpRequest(const SstRequestHeader& request, const SstStreamHeader& streamHdr,
+                          SstServerChannel& client) {
+     // A retransmitted request for a response still being sent, or already
+     // sent in full, is a duplicate
+     if (client.streams.find(streamHdr.localStreamId) != client.streams.end() ||
+         client.IsFinished(streamHdr.localStreamId)) {
+       return;
+     }
+     
+     client.OpenStream(streamHdr.localStreamId);
+     QueueHttpResponse(request, streamHdr, client);
+   }
+ 
+   // The caller sends once every request in the packet is queued, so
+   // small responses can share segments
+   void QueueHttpResponse(const SstRequestHeader& request, const SstStreamHeader& streamHdr,
+                         SstServerChannel& client) {
+     // HTTP/1.0 response header and body, both as virtual bytes
+     uint16_t streamId = streamHdr.localStreamId;
+     SstStream& stream = client.streams[streamId];
+     stream.streamId = streamId;
+     stream.isActive = true;
+     stream.isPrimary = (request.flags & SST_REQUEST_PRIMARY) != 0;
+     stream.windowEnd = SstWindowEnd(0, streamHdr.window);
+     stream.sendLength = HttpResponseHeaderLength(request.responseSize) + request.responseSize;
+     stream.nextByteSeq = 0;
+     client.sendQueue.push_back(streamId);
+     
+     // The client's cached copy is still good: a 304 without a body
+     if (HttpNotModified(request.lastModified, request.ifModifiedSince)) {
+       HttpCount(HTTP_COUNTER_NOT_MODIFIED);
+       stream.sendLength = HttpNotModifiedResponse("HTTP/1.0", "close").size();
+       return;
+     }
+     
+     HTTP_LOG_INFO("SST server queued response of " << request.responseSize 
+                 << " bytes for stream " << streamId);
+   }
+ 
+   // Index into sendQueue of the stream the scheduler sends from next, or
+   // sendQueue.size() if every stream is waiting for its receive window
+   size_t PickStream(SstServerChannel& client) {
+     size_t best = client.sendQueue.size();
+     for (size_t i = 0; i < client.sendQueue.size(); i++) {
+       const SstStream& stream = client.streams[client.sendQueue[i]];
+       if (stream.nextByteSeq >= stream.windowEnd) {
+         continue;
+       }
+       
+       if (m_scheduler == SST_SCHED_FIFO || m_scheduler == SST_SCHED_RR) {
+         return i;
+       }
+       if (m_scheduler == SST_SCHED_PRIMARY) {
+         if (stream.isPrimary) {
+           return i;
+         }
+         if (best == client.sendQueue.size()) {
+           best = i;
+         }
+         continue;
+       }
+       
+       // SST_SCHED_SRPT
+       if (best == client.sendQueue.size() ||
+           UnsentBytes(stream) < UnsentBytes(client.streams[client.sendQueue[best]])) {
+         best = i;
+       }
+     }
+     return best;
+   }
+   
+   static uint32_t UnsentBytes(const SstStream& stream) {
+     return stream.sendLength - stream.nextByteSeq;
+   }
+   
+   // Send segments of the queued responses while cwnd and the streams'
+   // receive windows allow, in the order the scheduler picks. With
+   // coalescing, a segment that does not fill the packet leaves room for
+   // records of the next streams.
+   void SendPendingData(const SstChannelKey& clientKey, SstServerChannel& client) {
+     HTTP_PROFILE_SCOPE(HTTP_PROFILE_SEND_RESPONSE);
+     while (m_running && client.channel->CanSend()) {
+       Ptr<Packet> body = Create<Packet>();
+       std::vector<SstRecordRef> records;
+       uint32_t room = SST_SEGMENT_SIZE;
+       while (room > 0) {
+         size_t index = PickStream(client);
+         if (index == client.sendQueue.size()) {
+           break;
+         }
+         if (!records.empty()) {
+           uint32_t headerSize = SstStreamHeader().GetSerializedSize();
+           if (!m_coalesce || room <= headerSize) {
+             break;
+           }
+           room -= headerSize;
+         }
+         
+         uint16_t streamId = client.sendQueue[index];
+         uint32_t segmentSize = AppendSegment(client.streams[streamId], room, body);
+         records.push_back({streamId, segmentSize});
+         room -= segmentSize;
+         
+         // Round-robin policies move the stream behind the others; the stream
+         // itself stays until everything it sent is acknowledged
+         client.sendQueue.erase(client.sendQueue.begin() + index);
+         if (UnsentBytes(client.streams[streamId]) == 0) {
+           HTTP_LOG_INFO("SST server sent last segment of stream " << streamId);
+         } else if (m_scheduler == SST_SCHED_RR || m_scheduler == SST_SCHED_PRIMARY) {
+           client.sendQueue.push_back(streamId);
+         } else {
+           client.sendQueue.insert(client.sendQueue.begin() + index, streamId);
+         }
+       }
+       if (records.empty()) {
+         return;
+       }
+       
+       SstChannelHeader chanHdr;
+       chanHdr.channelId = client.key.channelId;
+       chanHdr.packetSeqNum = client.channel->nextPacketSeq++;
+       client.channel->FillAck(chanHdr);
+       uint32_t packetSeq = chanHdr.packetSeqNum;
+       
+       // The records are already taken from their streams, so a failed send
+       // is left to the retransmission timer
+       int result = m_socket->SendTo(CreateSstPacket(chanHdr, body), 0, client.clientAddr);
+       if (result == -1) {
+         NS_LOG_ERROR("Failed to send SST segment " << packetSeq);
+       }
+       
+       SstPendingPacket& pending = client.channel->Track(packetSeq, body);
+       pending.records = records;
+       ArmRetransmitTimer(clientKey, *client.channel);
+     }
+   }
+   
+   // Append the stream's next segment, at most room bytes, to body; returns
+   // the segment size
+   uint32_t AppendSegment(SstStream& stream, uint32_t room, Ptr<Packet> body) {
+     uint32_t remaining = UnsentBytes(stream);
+     uint32_t windowLeft = stream.windowEnd - stream.nextByteSeq;
+     uint32_t segmentSize = std::min(std::min(remaining, room), windowLeft);
+     bool last = (segmentSize == remaining);
+     
+     SstStreamHeader streamHdr;
+     streamHdr.localStreamId = stream.streamId;
+     streamHdr.byteSeqNum = stream.nextByteSeq;
+     streamHdr.window = 31;
+     streamHdr.flags = last ? (SST_FLAG_PUSH | SST_FLAG_CLOSE) : 0;
+     AppendSstRecord(body, streamHdr, Create<Packet>(segmentSize));
+     
+     stream.nextByteSeq += segmentSize;
+     stream.sentBytes = stream.nextByteSeq;
+     return segmentSize;
+   }
+   
+   // An acknowledged (or abandoned) segment frees its streams' windows; a
+   // stream is done once all of it is acknowledged
+   void RetireSegment(SstServerChannel& client, const SstPendingPacket& pending) {
+     for (const SstRecordRef& record : pending.records) {
+       auto it = client.streams.find(record.streamId);
+       if (it == client.streams.end()) {
+         continue;
+       }
+       it->second.ackedBytes += record.length;
+       if (it->second.ackedBytes >= it->second.sendLength) {
+         client.MarkFinished(record.streamId);
+         client.streams.erase(it);
+       }
+     }
+   }
+ 
+   void UpdateCongestionControl(const SstChannelKey& clientKey, SstServerChannel& client,
+                                uint32_t ackSeqNum, uint32_t ackCount) {
+     HTTP_PROFILE_SCOPE(HTTP_PROFILE_CONGESTION_CONTROL);
+     uint32_t newlyAcked = client.channel->Acknowledge(ackSeqNum, ackCount,
+       [this, &client](const SstPendingPacket& pending) { RetireSegment(client, pending); });
+     
+     // Resend segments the ACKs have skipped over instead of waiting for the RTO
+     for (uint32_t lostSeq : client.channel->CollectLost()) {
+       client.channel->OnFastRetransmit(lostSeq);
+       HttpCount(HTTP_COUNTER_FAST_RETRANSMITS);
+       HTTP_LOG_INFO("Fast retransmit of segment " << lostSeq << " to " << clientKey
+                   << ", cwnd=" << client.channel->cwnd);
+       RetransmitSegment(client, lostSeq);
+     }
+     
+     if (newlyAcked == 0) {
+       return;
+     }
+     
+     HTTP_LOG_DEBUG("ACK " << ackSeqNum << " from " << clientKey << ": cwnd=" << client.channel->cwnd
+                  << " rtt=" << client.channel->rtt << "us rto=" << client.channel->rto << "us");
+     
+     SendPendingData(clientKey, client);
+   }
+ 
+   void ArmRetransmitTimer(const SstChannelKey& clientKey, SstChannel& channel) {
+     if (channel.retransmitTimer.IsPending()) {
+       return;
+     }
+     Time delay = channel.NextTimeout();
+     if (!delay.IsNegative()) {
+       channel.retransmitTimer = Simulator::Schedule(delay,
+         &HttpSstServer::HandleRetransmissionTimeout, this, clientKey);
+     }
+   }
+   
+   void HandleRetransmissionTimeout(SstChannelKey clientKey) {
+     HTTP_PROFILE_SCOPE(HTTP_PROFILE_RETRANSMISSION_TIMEOUT);
+     if (!m_running) return;
+     
+     SstServerChannel* client = m_clientChannels.Find(clientKey);
+     if (!client) {
+       return;
+     }
+     SstChannel& channel = *client->channel;
+     
+     std::vector<uint32_t> expired = channel.CollectExpired();
+     if (!expired.empty()) {
+       channel.OnTimeout();
+       HttpCount(HTTP_COUNTER_RTO_EXPIRIES);
+       NS_LOG_WARN(expired.size() << " segment(s) to " << clientKey
+                   << " timed out, cwnd reset to 1, RTO=" << channel.rto << "us");
+     }
+     
+     for (uint32_t packetSeqNum : expired) {
+       SstPendingPacket* pending = channel.pendingPackets.Find(packetSeqNum);
+       if (!pending) {
+         continue;
+       }
+       pending->retransmitCount++;
+       
+       // Give up after 5 retransmission attempts
+       if (pending->retransmitCount >= 5) {
+         NS_LOG_ERROR("Giving up on segment " << packetSeqNum << " after 5 retransmissions");
+         HttpCount(HTTP_COUNTER_GIVE_UPS);
+         RetireSegment(*client, *pending);
+         channel.packetsInFlight--;
+         channel.pendingPackets.Erase(packetSeqNum);
+         continue;
+       }
+       
+       HttpCount(HTTP_COUNTER_RETRANSMITS);
+       RetransmitSegment(*client, packetSeqNum);
+     }
+     
+     ArmRetransmitTimer(clientKey, channel);
+   }
+ 
+   // Resend an outstanding segment under a new sequence number (SST
+   // never reuses packet sequence numbers)
+   void RetransmitSegment(SstServerChannel& client, uint32_t packetSeqNum) {
+     SstChannel& channel = *client.channel;
+     SstPendingPacket* pending = channel.pendingPackets.Find(packetSeqNum);
+     if (!pending) {
+       return;
+     }
+     
+     SstChannelHeader chanHdr;
+     chanHdr.channelId = client.key.channelId;
+     chanHdr.packetSeqNum = channel.nextPacketSeq++;
+     channel.FillAck(chanHdr);
+     uint32_t packetSeq = chanHdr.packetSeqNum;
+     
+     Ptr<Packet> packet = CreateSstPacket(chanHdr, pending->body);
+     if (m_socket->SendTo(packet, 0, client.clientAddr) == -1) {
+       NS_LOG_ERROR("Failed to retransmit segment");
+       return;
+     }
+     
+     channel.Resend(packetSeqNum, packetSeq);
+     HTTP_LOG_INFO("Retransmitted segment " << packetSeqNum << " as " << packetSeq);
+   }
+   
+   void HandleAckTimeout(SstChannelKey clientKey) {
+     SstServerChannel* client = m_clientChannels.Find(clientKey);
+     if (m_running && client) {
+       SendAck(*client);
+     }
+   }
+   
+   // Pure ACKs carry packet sequence 0: they take no sequence space and
+   // are never acknowledged
+   void SendAck(SstServerChannel& client) {
+     SstChannelHeader chanHdr;
+     chanHdr.channelId = client.key.channelId;
+     chanHdr.packetSeqNum = 0;
+     client.channel->FillAck(chanHdr);
+     
+     Ptr<Packet> packet = CreateSstPacket(chanHdr, nullptr);
+     m_socket->SendTo(packet, 0, client.clientAddr);
+   }
+   
+   void SendReset(const Address& clientAddr, uint8_t channelId) {
+     SstChannelHeader chanHdr;
+     chanHdr.channelId = channelId;
+     m_socket->SendTo(CreateSstPacket(chanHdr, nullptr), 0, clientAddr);
+     HttpCount(HTTP_COUNTER_SST_RESETS);
+   }
+ 
+   Ptr<Socket> m_socket;
+   SstChannelTable m_clientChannels;    // Per-client channel state
+   uint16_t m_port;
+   bool m_running;
+   SstScheduler m_scheduler;
+   bool m_coalesce;
+   Time m_channelIdleTimeout;
+   EventId m_expiryEvent;
+   uint32_t m_channelCount;             // Channels the server has seen
+   HttpTransportSampler m_sampler;
+   TracedCallback<const HttpResultsSampleRecord&> m_transportTrace;
+   TracedCallback<uint32_t, Ptr<SstChannel>> m_channelOpenedTrace;
+ };
+
+ // Streams multiplexed over one SST channel
+ class HttpSstMode : public HttpModeOf<HttpSstClient, HttpSstServer> {
+ public:
+   HttpSstMode() : m_schedulerName("fifo"), m_scheduler(SST_SCHED_FIFO), m_streamWindow(16),
+                   m_batch(true), m_channelIdleTimeout(0.0), m_pageGap(0.0) {}
+ 
+   virtual std::string GetDescription() const {
+     return "HTTP/1.0 SST";
+   }
+ 
+   virtual void AddOptions(CommandLine& cmd) {
+     cmd.AddValue("scheduler", "SST server stream scheduler (fifo, rr, primary, srpt)", m_schedulerName);
+     cmd.AddValue("streamWindow", "SST per-stream receive window as a power of two (0-31, 31 = unlimited)", m_streamWindow);
+     cmd.AddValue("batch", "SST: batch small requests and coalesce small responses into shared packets", m_batch);
+     cmd.AddValue("channelIdleTimeout", "SST: seconds before the server forgets an idle channel (0 = never)", m_channelIdleTimeout);
+     cmd.AddValue("pageGap", "SST: seconds a client waits after each page before the next", m_pageGap);
+   }
+ 
+   virtual bool Configure(std::string& error) {
+     if (!ParseSstScheduler(m_schedulerName, m_scheduler)) {
+       error = "unknown scheduler " + m_schedulerName + " (use fifo, rr, primary or srpt)";
+       return false;
+     }
+     if (m_streamWindow > 31) {
+       error = "--streamWindow must be between 0 and 31";
+       return false;
+     }
+     if (m_channelIdleTimeout < 0.0) {
+       error = "--channelIdleTimeout must not be negative";
+       return false;
+     }
+     if (m_pageGap < 0.0) {
+       error = "--pageGap must not be negative";
+       return false;
+     }
+     return true;
+   }
+ 
+ protected:
+   virtual void ConfigureServer(Ptr<HttpSstServer> server) {
+     server->SetScheduler(m_scheduler);
+     server->SetCoalesce(m_batch);
+     server->SetChannelIdleTimeout(Seconds(m_channelIdleTimeout));
+   }
+ 
+   virtual void ConfigureServerResults(Ptr<HttpSstServer> server, HttpResults* results) {
+     server->SetResults(results);
+   }
+ 
+   virtual void ConfigureClient(Ptr<HttpSstClient> client) {
+     client->SetStreamWindow(m_streamWindow);
+     client->SetBatchRequests(m_batch);
+     client->SetPageGap(Seconds(m_pageGap));
+   }
+ 
+ private:
+   std::string m_schedulerName;
+   SstScheduler m_scheduler;
+   uint32_t m_streamWindow;
+   bool m_batch;
+   double m_channelIdleTimeout;
+   double m_pageGap;
+ };
+ 
+ HTTP_MODE_REGISTER("sst", HttpSstMode);
+
+ #endif /* HTTP_SST_H */
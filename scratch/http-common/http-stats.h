@@ -0,0 +1,226 @@
+/* http-stats.h
+ *
+ * Page/request statistics and flow monitor summary printed at the end of
+ * every HTTP simulation. The per-page line format is what new_graphing.py
+ * parses from logs of runs without --results, so keep it stable.
+ *
+ * Besides the averages, page load and request times go into quantile
+ * sketches (http-sketch.h) as each page is reported: all pages, pages by
+ * request count (the groups of Figure 8) and pages by total size.
+ */
+
+ #ifndef HTTP_STATS_H
+ #define HTTP_STATS_H
+
+ #include "ns3/core-module.h"
+ #include "ns3/flow-monitor-module.h"
+ #include "http-sketch.h"
+ #include "http-trace.h"
+ #include <iostream>
+ #include <string>
+ #include <vector>
+
+ using namespace ns3;
+
+ struct HttpRunStats {
+   uint32_t pageCount;               // Pages handed to the clients
+   uint32_t completedPageCount;      // Pages with valid load times
+   double totalPageTime;             // Seconds
+   uint32_t totalCompletedRequests;
+   double totalRequestTime;          // Seconds
+
+   // Group boundaries: 1, 2, 3-4, 5-8 and 9+ requests; pages below 8 KB,
+   // 32 KB, 128 KB and the rest
+   static const uint32_t REQUEST_GROUPS = 5;
+   static const uint32_t SIZE_GROUPS = 4;
+
+   // Load times of the completed pages and their requests, in microseconds
+   HttpQuantileSketch pageTimes;
+   HttpQuantileSketch pageTimesByRequests[REQUEST_GROUPS];
+   HttpQuantileSketch pageTimesBySize[SIZE_GROUPS];
+   HttpQuantileSketch requestTimes;
+
+   HttpRunStats() : pageCount(0), completedPageCount(0), totalPageTime(0.0),
+                    totalCompletedRequests(0), totalRequestTime(0.0) {}
+
+   static uint32_t RequestGroup(size_t requests) {
+     if (requests <= 2) {
+       return requests == 2 ? 1 : 0;
+     }
+     return requests <= 4 ? 2 : requests <= 8 ? 3 : 4;
+   }
+
+   static uint32_t SizeGroup(uint32_t bytes) {
+     return bytes < 8192 ? 0 : bytes < 32768 ? 1 : bytes < 131072 ? 2 : 3;
+   }
+
+   static const char* RequestGroupName(uint32_t group) {
+     static const char* const names[REQUEST_GROUPS] = {
+       "1 request", "2 requests", "3-4 requests", "5-8 requests", "9+ requests"
+     };
+     return names[group];
+   }
+
+   static const char* SizeGroupName(uint32_t group) {
+     static const char* const names[SIZE_GROUPS] = {"< 8 KB", "8-32 KB", "32-128 KB", ">= 128 KB"};
+     return names[group];
+   }
+
+   // Every sketch with its name in sketch files, always in the same order
+   template <typename F>
+   void ForEachSketch(F f) {
+     f(std::string("page"), pageTimes);
+     for (uint32_t g = 0; g < REQUEST_GROUPS; g++) {
+       f("page_requests_" + std::to_string(g), pageTimesByRequests[g]);
+     }
+     for (uint32_t g = 0; g < SIZE_GROUPS; g++) {
+       f("page_size_" + std::to_string(g), pageTimesBySize[g]);
+     }
+     f(std::string("request"), requestTimes);
+   }
+ };
+
+ // Add a page to the run totals, printing a line for it if it completed
+ // and printLine is set. A page's load time runs from its earliest request
+ // start to its latest request completion.
+ inline void AccumulatePageStats(const WebPage& page, HttpRunStats& stats, bool printLine) {
+   stats.pageCount++;
+
+   bool pageHasEndTime = false;
+   Time pageStartTime = Seconds(0);
+   Time pageEndTime = Seconds(0);
+   uint32_t pageCompletedRequests = 0;
+   uint32_t totalPageSize = 0;
+   uint32_t completedPageSize = 0;
+
+   Time earliestStartTime = Seconds(0);
+   bool foundStartTime = false;
+
+   for (const auto& req : page.requests) {
+     totalPageSize += req.GetBodySize();
+
+     if (!req.startTime.IsZero()) {
+       if (!foundStartTime || req.startTime < earliestStartTime) {
+         earliestStartTime = req.startTime;
+         foundStartTime = true;
+       }
+     }
+
+     if (!req.completeTime.IsZero() && req.completeTime > Seconds(0)) {
+       pageCompletedRequests++;
+       completedPageSize += req.GetBodySize();
+
+       if (!req.startTime.IsZero()) {
+         Time requestTime = req.completeTime - req.startTime;
+         if (requestTime.GetSeconds() > 0) {
+           stats.totalRequestTime += requestTime.GetSeconds();
+           stats.requestTimes.Add(requestTime.GetMicroSeconds());
+         }
+       }
+
+       if (pageEndTime.IsZero() || req.completeTime > pageEndTime) {
+         pageEndTime = req.completeTime;
+         pageHasEndTime = true;
+       }
+     }
+   }
+
+   if (foundStartTime) {
+     pageStartTime = earliestStartTime;
+   }
+
+   if (foundStartTime && pageHasEndTime && pageEndTime > pageStartTime && pageCompletedRequests > 0) {
+     double pageTime = (pageEndTime - pageStartTime).GetSeconds();
+
+     if (pageTime > 0) {
+       stats.totalPageTime += pageTime;
+       stats.completedPageCount++;
+
+       double pageTimeUs = (pageEndTime - pageStartTime).GetMicroSeconds();
+       stats.pageTimes.Add(pageTimeUs);
+       stats.pageTimesByRequests[HttpRunStats::RequestGroup(page.requests.size())].Add(pageTimeUs);
+       stats.pageTimesBySize[HttpRunStats::SizeGroup(totalPageSize)].Add(pageTimeUs);
+
+       double pageTimeMs = pageTime * 1000.0;
+
+       if (printLine) {
+         std::cout << "Page " << stats.completedPageCount << " (" << page.requests.size()
+                   << " requests): " << pageTimeMs << " ms ("
+                   << pageCompletedRequests << "/" << page.requests.size()
+                   << " requests completed)"
+                   << " - Total size: " << totalPageSize << " bytes"
+                   << " - Completed size: " << completedPageSize << " bytes"
+                   << std::endl;
+       }
+     }
+   }
+
+   stats.totalCompletedRequests += pageCompletedRequests;
+ }
+
+ // Page and request time quantiles in ms, then the non-empty page groups
+ inline void PrintQuantiles(const HttpRunStats& stats, std::ostream& os) {
+   os << "\nPage load time quantiles (ms):" << std::endl;
+   PrintSketchQuantiles(os, "all pages", stats.pageTimes, 1000.0);
+   for (uint32_t g = 0; g < HttpRunStats::REQUEST_GROUPS; g++) {
+     if (stats.pageTimesByRequests[g].GetCount() > 0) {
+       PrintSketchQuantiles(os, HttpRunStats::RequestGroupName(g), stats.pageTimesByRequests[g], 1000.0);
+     }
+   }
+   for (uint32_t g = 0; g < HttpRunStats::SIZE_GROUPS; g++) {
+     if (stats.pageTimesBySize[g].GetCount() > 0) {
+       PrintSketchQuantiles(os, HttpRunStats::SizeGroupName(g), stats.pageTimesBySize[g], 1000.0);
+     }
+   }
+   os << "Request time quantiles (ms):" << std::endl;
+   PrintSketchQuantiles(os, "all requests", stats.requestTimes, 1000.0);
+ }
+
+ inline void PrintRunStats(const HttpRunStats& stats) {
+   if (stats.completedPageCount > 0) {
+     double avgPageTimeMs = (stats.totalPageTime / stats.completedPageCount) * 1000.0;
+     std::cout << "\nAverage page load time: " << avgPageTimeMs << " ms" << std::endl;
+     std::cout << "Completed " << stats.completedPageCount << " out of "
+               << stats.pageCount << " pages ("
+               << (stats.completedPageCount * 100.0 / stats.pageCount) << "%)" << std::endl;
+   } else {
+     std::cout << "No pages completed" << std::endl;
+   }
+
+   if (stats.totalCompletedRequests > 0) {
+     std::cout << "Average request time: " << (stats.totalRequestTime / stats.totalCompletedRequests)
+               << " seconds" << std::endl;
+     std::cout << "Completed " << stats.totalCompletedRequests << " requests" << std::endl;
+   }
+
+   if (stats.completedPageCount > 0) {
+     PrintQuantiles(stats, std::cout);
+   }
+ }
+
+ inline void PrintFlowStatistics(Ptr<FlowMonitor> flowMonitor, FlowMonitorHelper& flowHelper) {
+   flowMonitor->CheckForLostPackets();
+   Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(flowHelper.GetClassifier());
+   FlowMonitor::FlowStatsContainer stats = flowMonitor->GetFlowStats();
+
+   std::cout << "\nFlow statistics:" << std::endl;
+   std::cout << "------------------------------------" << std::endl;
+
+   for (auto i = stats.begin(); i != stats.end(); ++i) {
+     Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(i->first);
+
+     std::cout << "Flow " << i->first << " (" << t.sourceAddress << ":" << t.sourcePort
+               << " -> " << t.destinationAddress << ":" << t.destinationPort << ")" << std::endl;
+     std::cout << "  Tx Packets: " << i->second.txPackets << std::endl;
+     std::cout << "  Rx Packets: " << i->second.rxPackets << std::endl;
+
+     if (i->second.timeLastRxPacket > i->second.timeFirstTxPacket) {
+       double throughput = i->second.rxBytes * 8.0 /
+                          (i->second.timeLastRxPacket.GetSeconds() -
+                           i->second.timeFirstTxPacket.GetSeconds()) / 1000000;
+       std::cout << "  Throughput: " << throughput << " Mbps" << std::endl;
+     }
+   }
+ }
+
+ #endif /* HTTP_STATS_H */
@@ -0,0 +1,236 @@
+/* http-topology.h
+ *
+ * Network topologies shared by the HTTP simulations.
+ *
+ *   p2p       one client and the server on a single link (the original setup)
+ *   dumbbell  N clients -> router == bottleneck == router -> server
+ *   star      N clients -> hub == bottleneck -> server
+ *
+ * Client and server access links use accessBandwidth/accessDelay; the
+ * shared bottleneck uses bandwidth/delay.
+ *
+ * Distributed runs (systemCount > 1, dumbbell only) give every rank its own
+ * edge router and client block, each with a bottleneck link to the core
+ * router. The core router and the server live on rank 0, so the bottleneck
+ * links are the rank boundaries and their delay is the MPI lookahead.
+ */
+
+ #ifndef HTTP_TOPOLOGY_H
+ #define HTTP_TOPOLOGY_H
+
+ #include "ns3/core-module.h"
+ #include "ns3/internet-module.h"
+ #include "ns3/network-module.h"
+ #include "ns3/point-to-point-module.h"
+ #include <string>
+
+ using namespace ns3;
+
+ struct HttpTopologyConfig {
+   std::string topology;          // p2p, dumbbell or star
+   uint32_t clientCount;          // Number of client nodes
+   std::string bandwidth;         // Bottleneck data rate
+   std::string delay;             // Bottleneck one-way delay
+   std::string accessBandwidth;   // Access link data rate
+   std::string accessDelay;       // Access link one-way delay
+   uint32_t systemId;             // MPI rank of this process
+   uint32_t systemCount;          // Number of MPI ranks
+
+   HttpTopologyConfig() : topology("p2p"), clientCount(1), bandwidth("1.5Mbps"), delay("25ms"),
+                          accessBandwidth("100Mbps"), accessDelay("1ms"),
+                          systemId(0), systemCount(1) {}
+ };
+
+ class HttpTopology {
+ public:
+   HttpTopology() : m_systemId(0), m_systemCount(1) {}
+
+   bool Build(const HttpTopologyConfig& config, std::string& error) {
+     if (config.clientCount == 0) {
+       error = "at least one client is required";
+       return false;
+     }
+
+     m_systemId = config.systemId;
+     m_systemCount = config.systemCount;
+     if (m_systemCount > 1 && config.topology != "dumbbell") {
+       error = "distributed runs need --topology=dumbbell";
+       return false;
+     }
+     if (config.clientCount < m_systemCount) {
+       error = "distributed runs need at least one client per rank";
+       return false;
+     }
+
+     m_bottleneckLink.SetDeviceAttribute("DataRate", StringValue(config.bandwidth));
+     m_bottleneckLink.SetChannelAttribute("Delay", StringValue(config.delay));
+     m_accessLink.SetDeviceAttribute("DataRate", StringValue(config.accessBandwidth));
+     m_accessLink.SetChannelAttribute("Delay", StringValue(config.accessDelay));
+
+     if (config.topology == "p2p") {
+       if (config.clientCount != 1) {
+         error = "the p2p topology has a single client; use --topology=dumbbell or star";
+         return false;
+       }
+       return BuildPointToPoint();
+     }
+     if (config.topology == "dumbbell" || config.topology == "star") {
+       return BuildShared(config.clientCount, config.topology == "dumbbell");
+     }
+
+     error = "unknown topology " + config.topology;
+     return false;
+   }
+
+   Ptr<Node> GetServerNode() const {
+     return m_server;
+   }
+
+   Ipv4Address GetServerAddress() const {
+     return m_serverAddress;
+   }
+
+   uint32_t GetClientCount() const {
+     return m_clients.GetN();
+   }
+
+   Ptr<Node> GetClientNode(uint32_t i) const {
+     return m_clients.Get(i);
+   }
+
+   // Change the link parameters of the built network to those of config,
+   // e.g. in a forked sweep point (http-fork.h); the p2p topology has no
+   // access links
+   void SetLinks(const HttpTopologyConfig& config) {
+     SetLinks(m_bottleneckDevices, config.bandwidth, config.delay);
+     SetLinks(m_accessDevices, config.accessBandwidth, config.accessDelay);
+   }
+
+   // Both ends of every bottleneck link (one link per rank when distributed)
+   NetDeviceContainer GetBottleneckDevices() const {
+     return m_bottleneckDevices;
+   }
+
+   // Applications are only installed on nodes owned by this rank
+   bool IsLocal(Ptr<Node> node) const {
+     return node->GetSystemId() == m_systemId;
+   }
+
+   NodeContainer GetLocalNodes() const {
+     NodeContainer local;
+     for (auto it = NodeList::Begin(); it != NodeList::End(); ++it) {
+       if (IsLocal(*it)) {
+         local.Add(*it);
+       }
+     }
+     return local;
+   }
+
+   // ASCII and pcap traces of every p2p device; distributed ranks trace
+   // their own nodes into <prefix>-rank<N> files
+   void EnableTracing(const std::string& prefix) {
+     AsciiTraceHelper ascii;
+     if (m_systemCount == 1) {
+       m_bottleneckLink.EnableAsciiAll(ascii.CreateFileStream(prefix + ".tr"));
+       m_bottleneckLink.EnablePcapAll(prefix);
+       return;
+     }
+     std::string rankPrefix = prefix + "-rank" + std::to_string(m_systemId);
+     NodeContainer local = GetLocalNodes();
+     m_bottleneckLink.EnableAscii(ascii.CreateFileStream(rankPrefix + ".tr"), local);
+     m_bottleneckLink.EnablePcap(rankPrefix, local);
+   }
+
+ private:
+   static void SetLinks(const NetDeviceContainer& devices, const std::string& bandwidth,
+                        const std::string& delay) {
+     for (uint32_t i = 0; i < devices.GetN(); i++) {
+       devices.Get(i)->SetAttribute("DataRate", StringValue(bandwidth));
+       devices.Get(i)->GetChannel()->SetAttribute("Delay", StringValue(delay));
+     }
+   }
+
+   bool BuildPointToPoint() {
+     NodeContainer nodes;
+     nodes.Create(2);  // Node 0: client, Node 1: server
+     m_bottleneckDevices = m_bottleneckLink.Install(nodes);
+
+     InternetStackHelper internet;
+     internet.Install(nodes);
+
+     Ipv4AddressHelper address;
+     address.SetBase("10.1.1.0", "255.255.255.0");
+     Ipv4InterfaceContainer interfaces = address.Assign(m_bottleneckDevices);
+
+     m_clients.Add(nodes.Get(0));
+     m_server = nodes.Get(1);
+     m_serverAddress = interfaces.GetAddress(1);
+     return true;
+   }
+
+   bool BuildShared(uint32_t clientCount, bool dumbbell) {
+     // Clients are split into contiguous blocks, one per rank, each behind
+     // its rank's edge router
+     for (uint32_t r = 0; r < m_systemCount; r++) {
+       m_routers.Add(CreateObject<Node>(r));
+     }
+     for (uint32_t i = 0; i < clientCount; i++) {
+       m_clients.Add(CreateObject<Node>((uint64_t) i * m_systemCount / clientCount));
+     }
+     Ptr<Node> core = dumbbell ? CreateObject<Node>(0) : nullptr;
+     m_server = CreateObject<Node>(0);
+
+     InternetStackHelper internet;
+     internet.Install(m_clients);
+     internet.Install(m_routers);
+     if (core) {
+       internet.Install(core);
+     }
+     internet.Install(m_server);
+
+     // One /30 per link starting at 10.1.0.0
+     Ipv4AddressHelper address;
+     address.SetBase("10.1.0.0", "255.255.255.252");
+
+     for (uint32_t i = 0; i < clientCount; i++) {
+       Ptr<Node> edge = m_routers.Get(m_clients.Get(i)->GetSystemId());
+       NetDeviceContainer devices = m_accessLink.Install(m_clients.Get(i), edge);
+       m_accessDevices.Add(devices);
+       address.Assign(devices);
+       address.NewNetwork();
+     }
+
+     Ipv4InterfaceContainer serverInterfaces;
+     if (dumbbell) {
+       for (uint32_t r = 0; r < m_systemCount; r++) {
+         NetDeviceContainer devices = m_bottleneckLink.Install(m_routers.Get(r), core);
+         m_bottleneckDevices.Add(devices);
+         address.Assign(devices);
+         address.NewNetwork();
+       }
+       NetDeviceContainer devices = m_accessLink.Install(core, m_server);
+       m_accessDevices.Add(devices);
+       serverInterfaces = address.Assign(devices);
+     } else {
+       m_bottleneckDevices = m_bottleneckLink.Install(m_routers.Get(0), m_server);
+       serverInterfaces = address.Assign(m_bottleneckDevices);
+     }
+     m_serverAddress = serverInterfaces.GetAddress(1);
+
+     Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+     return true;
+   }
+
+   NodeContainer m_clients;
+   NodeContainer m_routers;
+   Ptr<Node> m_server;
+   Ipv4Address m_serverAddress;
+   NetDeviceContainer m_bottleneckDevices;
+   NetDeviceContainer m_accessDevices;
+   PointToPointHelper m_bottleneckLink;
+   PointToPointHelper m_accessLink;
+   uint32_t m_systemId;
+   uint32_t m_systemCount;
+ };
+
+ #endif /* HTTP_TOPOLOGY_H */
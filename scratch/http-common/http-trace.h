@@ -0,0 +1,518 @@
+/* http-trace.h
+ *
+ * Shared trace loader for the HTTP simulations.
+ *
+ * Binary traces (see trace-format.h) are memory-mapped and used in place:
+ * the page index makes slicing O(1), and a WebPage is only materialized for
+ * the pages a client actually replays. CSV traces in the ucb_trace_parser
+ * format are still accepted; they are parsed once into the same in-memory
+ * layout so the rest of the program does not care which one it got.
+ *
+ * Each request keeps the trace's cache headers; the browser cache model
+ * (http-cache.h) decides from them whether a request is sent at all and
+ * whether it is sent as a conditional GET.
+ */
+
+ #ifndef HTTP_TRACE_H
+ #define HTTP_TRACE_H
+
+ #include "ns3/nstime.h"
+ #include "trace-format.h"
+ #include <cstdlib>
+ #include <string>
+ #include <unordered_map>
+ #include <vector>
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+
+ using namespace ns3;
+
+ // The rule a server applies to a conditional GET: a 304 when the object
+ // is no newer than the client's copy. Either date 0 means there is nothing
+ // to compare, so the full object is sent.
+ inline bool HttpNotModified(uint32_t lastModified, uint32_t ifModifiedSince) {
+   return lastModified != 0 && ifModifiedSince != 0 && lastModified <= ifModifiedSince;
+ }
+
+ // Define a structure to hold web request data
+ struct WebRequest {
+   uint32_t id;           // Request ID
+   std::string url;       // Request URL
+   uint32_t size;         // Response size in bytes
+   bool isPrimary;        // Is this a primary (HTML) request
+   Time startTime;        // When the request was started
+   Time completeTime;     // When the request was completed
+   bool isComplete = false; // The whole response arrived; timeouts set completeTime too
+
+   // Cache headers from the trace (HTTP_TRACE_CACHE_FLAGS bits and the
+   // dates they validate, in trace seconds)
+   uint32_t traceTime = 0;        // Client request time in the trace
+   uint32_t cacheFlags = 0;
+   uint32_t ifModifiedSince = 0;  // The traced client's If-Modified-Since
+   uint32_t expires = 0;
+   uint32_t lastModified = 0;     // The object's Last-Modified at the server
+
+   // If-Modified-Since this request is sent with, set by the browser
+   // cache; 0 sends a plain GET
+   uint32_t validator = 0;
+
+   // A conditional GET for an object that has not changed since the
+   // cached copy is answered with a 304 and no body
+   bool IsNotModified() const {
+     return HttpNotModified(lastModified, validator);
+   }
+
+   // Body bytes the server sends back
+   uint32_t GetBodySize() const {
+     return IsNotModified() ? 0 : size;
+   }
+ };
+
+ // Define a structure to hold a web page with its requests
+ struct WebPage {
+   std::vector<WebRequest> requests;
+   bool isComplete;
+   uint32_t primaryRequestId;
+   bool primaryCompleted;
+
+   WebPage() : isComplete(false), primaryRequestId(0), primaryCompleted(false) {}
+ };
+
+ class HttpTrace {
+ public:
+   HttpTrace() : m_map(nullptr), m_mapSize(0), m_pages(nullptr), m_requests(nullptr),
+                 m_strings(nullptr), m_pageCount(0), m_requestCount(0), m_stringSize(0),
+                 m_skippedLines(0) {}
+   ~HttpTrace() {
+     Close();
+   }
+
+   HttpTrace(const HttpTrace&) = delete;
+   HttpTrace& operator=(const HttpTrace&) = delete;
+
+   // Open a binary or CSV trace; the format is detected from the magic
+   bool Open(const std::string& filename) {
+     Close();
+     m_error.clear();
+     m_skippedLines = 0;
+
+     int fd = open(filename.c_str(), O_RDONLY);
+     if (fd < 0) {
+       m_error = "could not open " + filename;
+       return false;
+     }
+
+     struct stat st;
+     if (fstat(fd, &st) != 0 || st.st_size == 0) {
+       m_error = "empty trace file " + filename;
+       close(fd);
+       return false;
+     }
+
+     void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+     close(fd);
+     if (map == MAP_FAILED) {
+       m_error = "could not map " + filename;
+       return false;
+     }
+     m_map = static_cast<const char*>(map);
+     m_mapSize = st.st_size;
+
+     bool ok;
+     if (m_mapSize >= sizeof(HttpTraceFileHeader) &&
+         memcmp(m_map, HTTP_TRACE_MAGIC, 8) == 0) {
+       ok = MapBinary();
+     } else {
+       madvise(map, m_mapSize, MADV_SEQUENTIAL);
+       ok = ParseCsv();
+       // The CSV text is not needed once it has been converted
+       munmap(map, m_mapSize);
+       m_map = nullptr;
+       m_mapSize = 0;
+     }
+
+     if (!ok) {
+       Close();
+     }
+     return ok;
+   }
+
+   void Close() {
+     if (m_map) {
+       munmap(const_cast<char*>(m_map), m_mapSize);
+     }
+     m_map = nullptr;
+     m_mapSize = 0;
+     m_pages = nullptr;
+     m_requests = nullptr;
+     m_strings = nullptr;
+     m_pageCount = 0;
+     m_requestCount = 0;
+     m_stringSize = 0;
+     m_ownedPages.clear();
+     m_ownedRequests.clear();
+     m_ownedStrings.clear();
+   }
+
+   bool IsMapped() const {
+     return m_map != nullptr;
+   }
+
+   uint64_t GetPageCount() const {
+     return m_pageCount;
+   }
+
+   uint64_t GetRequestCount() const {
+     return m_requestCount;
+   }
+
+   // Malformed CSV lines that were skipped or patched while loading
+   uint64_t GetSkippedLines() const {
+     return m_skippedLines;
+   }
+
+   const std::string& GetError() const {
+     return m_error;
+   }
+
+   const HttpTracePageRecord& GetPageRecord(uint64_t index) const {
+     return m_pages[index];
+   }
+
+   const HttpTraceRequestRecord& GetRequestRecord(uint64_t index) const {
+     return m_requests[index];
+   }
+
+   // Materialize one page; request IDs are the global request indices
+   WebPage GetPage(uint64_t index) const {
+     const HttpTracePageRecord& rec = m_pages[index];
+     WebPage page;
+     page.requests.resize(rec.requestCount);
+     for (uint32_t i = 0; i < rec.requestCount; i++) {
+       const HttpTraceRequestRecord& r = m_requests[rec.firstRequest + i];
+       WebRequest& req = page.requests[i];
+       req.id = rec.firstRequest + i;
+       req.url.assign(m_strings + r.urlOffset, r.urlLength);
+       req.size = r.size;
+       req.isPrimary = (r.flags & HTTP_TRACE_PRIMARY) != 0;
+       req.traceTime = r.requestTime;
+       req.cacheFlags = r.flags & HTTP_TRACE_CACHE_FLAGS;
+       req.ifModifiedSince = r.ifModifiedSince;
+       req.expires = r.expires;
+       req.lastModified = r.lastModified;
+     }
+     return page;
+   }
+
+   // Materialize pages [first, first + count), clamped to the trace
+   std::vector<WebPage> GetPages(uint64_t first, uint64_t count) const {
+     std::vector<WebPage> pages;
+     if (first >= m_pageCount) {
+       return pages;
+     }
+     if (count > m_pageCount - first) {
+       count = m_pageCount - first;
+     }
+     pages.reserve(count);
+     for (uint64_t i = first; i < first + count; i++) {
+       pages.push_back(GetPage(i));
+     }
+     return pages;
+   }
+
+   // Materialize the pages with the given indices, in that order
+   std::vector<WebPage> GetPages(const std::vector<uint64_t>& indices) const {
+     std::vector<WebPage> pages;
+     pages.reserve(indices.size());
+     for (uint64_t index : indices) {
+       pages.push_back(GetPage(index));
+     }
+     return pages;
+   }
+
+   // Split the first pageCount pages over shardCount clients. Every client
+   // IP from the trace goes to exactly one shard (round-robin in order of
+   // first appearance), so a simulated browser replays whole client
+   // histories. Traces without client IPs (CSV) are split page by page.
+   std::vector<std::vector<uint64_t>> GetClientShards(uint64_t pageCount, uint32_t shardCount) const {
+     std::vector<std::vector<uint64_t>> shards(shardCount);
+     if (shardCount == 0) {
+       return shards;
+     }
+     if (pageCount > m_pageCount) {
+       pageCount = m_pageCount;
+     }
+
+     std::unordered_map<uint32_t, uint32_t> clientShard;
+     uint32_t nextShard = 0;
+     for (uint64_t i = 0; i < pageCount; i++) {
+       uint32_t clientId = m_pages[i].clientId;
+       uint32_t shard;
+       if (clientId == 0) {
+         shard = i % shardCount;
+       } else {
+         auto it = clientShard.find(clientId);
+         if (it == clientShard.end()) {
+           it = clientShard.emplace(clientId, nextShard).first;
+           nextShard = (nextShard + 1) % shardCount;
+         }
+         shard = it->second;
+       }
+       shards[shard].push_back(i);
+     }
+     return shards;
+   }
+
+ private:
+   bool MapBinary() {
+     HttpTraceFileHeader header;
+     memcpy(&header, m_map, sizeof(header));
+
+     bool version1 = header.version == 1 &&
+                     header.requestRecordSize == sizeof(HttpTraceRequestRecordV1);
+     if ((header.version != HTTP_TRACE_VERSION && !version1) ||
+         header.headerSize != sizeof(HttpTraceFileHeader) ||
+         header.pageRecordSize != sizeof(HttpTracePageRecord) ||
+         (header.requestRecordSize != sizeof(HttpTraceRequestRecord) && !version1)) {
+       m_error = "unsupported binary trace version";
+       return false;
+     }
+
+     if (!SectionFits(header.pageOffset, header.pageCount, sizeof(HttpTracePageRecord)) ||
+         !SectionFits(header.requestOffset, header.requestCount, header.requestRecordSize) ||
+         !SectionFits(header.stringOffset, header.stringSize, 1)) {
+       m_error = "truncated binary trace";
+       return false;
+     }
+
+     m_pages = reinterpret_cast<const HttpTracePageRecord*>(m_map + header.pageOffset);
+     if (version1) {
+       WidenVersion1Requests(header.requestOffset, header.requestCount);
+       m_requests = m_ownedRequests.data();
+     } else {
+       m_requests = reinterpret_cast<const HttpTraceRequestRecord*>(m_map + header.requestOffset);
+     }
+     m_strings = m_map + header.stringOffset;
+     m_pageCount = header.pageCount;
+     m_requestCount = header.requestCount;
+     m_stringSize = header.stringSize;
+
+     // Pages are replayed from the front; let the kernel read ahead
+     madvise(const_cast<char*>(m_map), m_mapSize, MADV_WILLNEED);
+     return ValidateRecords();
+   }
+
+   // GetPage trusts the records, so check once that every page's requests
+   // and every URL lie inside their sections
+   bool ValidateRecords() {
+     for (uint64_t i = 0; i < m_pageCount; i++) {
+       const HttpTracePageRecord& page = m_pages[i];
+       if (page.firstRequest > m_requestCount || page.requestCount > m_requestCount - page.firstRequest) {
+         m_error = "corrupt binary trace: page " + std::to_string(i) + " has requests outside the request table";
+         return false;
+       }
+     }
+     for (uint64_t i = 0; i < m_requestCount; i++) {
+       const HttpTraceRequestRecord& request = m_requests[i];
+       if (request.urlOffset > m_stringSize || request.urlLength > m_stringSize - request.urlOffset) {
+         m_error = "corrupt binary trace: request " + std::to_string(i) + " has a URL outside the string table";
+         return false;
+       }
+     }
+     return true;
+   }
+
+   // Version 1 records lack the cache fields; copy them into the current
+   // layout once, the page index and strings stay mapped
+   void WidenVersion1Requests(uint64_t offset, uint64_t count) {
+     const HttpTraceRequestRecordV1* old =
+       reinterpret_cast<const HttpTraceRequestRecordV1*>(m_map + offset);
+     m_ownedRequests.resize(count);
+     for (uint64_t i = 0; i < count; i++) {
+       HttpTraceRequestRecord& rec = m_ownedRequests[i];
+       memset(&rec, 0, sizeof(rec));
+       rec.urlOffset = old[i].urlOffset;
+       rec.urlLength = old[i].urlLength;
+       rec.size = old[i].size;
+       rec.clientId = old[i].clientId;
+       rec.requestTime = old[i].requestTime;
+       rec.responseTime = old[i].responseTime;
+       rec.flags = old[i].flags & HTTP_TRACE_PRIMARY;
+     }
+   }
+
+   bool SectionFits(uint64_t offset, uint64_t count, uint64_t recordSize) const {
+     return offset <= m_mapSize && count <= (m_mapSize - offset) / recordSize;
+   }
+
+   // Expected format: URL,SIZE,ISPRIMARY[,REQUEST_TIME,RESPONSE_TIME
+   // [,CACHE_FLAGS,IF_MODIFIED_SINCE,EXPIRES,LAST_MODIFIED]]
+   // '#' lines are comments; "End of Page" comments close the current page.
+   bool ParseCsv() {
+     const char* p = m_map;
+     const char* end = m_map + m_mapSize;
+     size_t pageStart = 0;
+
+     while (p < end) {
+       const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+       if (!eol) {
+         eol = end;
+       }
+       const char* lineEnd = eol;
+       if (lineEnd > p && lineEnd[-1] == '\r') {
+         lineEnd--;
+       }
+
+       if (lineEnd == p || *p == '#') {
+         if (lineEnd - p > 11 && FindText(p, lineEnd, "End of Page")) {
+           EndCsvPage(pageStart);
+           pageStart = m_ownedRequests.size();
+         }
+       } else {
+         ParseCsvLine(p, lineEnd);
+       }
+       p = eol + 1;
+     }
+     EndCsvPage(pageStart);
+
+     if (m_ownedPages.empty()) {
+       m_error = "no pages in trace";
+       return false;
+     }
+
+     m_pages = m_ownedPages.data();
+     m_requests = m_ownedRequests.data();
+     m_strings = m_ownedStrings.data();
+     m_pageCount = m_ownedPages.size();
+     m_requestCount = m_ownedRequests.size();
+     m_stringSize = m_ownedStrings.size();
+     return true;
+   }
+
+   void ParseCsvLine(const char* p, const char* end) {
+     static const int MAX_FIELDS = 9;
+     const char* fields[MAX_FIELDS];
+     const char* fieldEnds[MAX_FIELDS];
+     int n = 0;
+     const char* start = p;
+     while (n < MAX_FIELDS) {
+       const char* comma = static_cast<const char*>(memchr(start, ',', end - start));
+       fields[n] = start;
+       // The last column takes the rest of the line
+       fieldEnds[n] = (comma && n < MAX_FIELDS - 1) ? comma : end;
+       n++;
+       if (!comma || n == MAX_FIELDS) {
+         break;
+       }
+       start = comma + 1;
+     }
+
+     if (n < 3) {
+       m_skippedLines++;
+       return;
+     }
+
+     HttpTraceRequestRecord rec;
+     memset(&rec, 0, sizeof(rec));
+     rec.urlOffset = m_ownedStrings.size();
+     rec.urlLength = fieldEnds[0] - fields[0];
+     m_ownedStrings.insert(m_ownedStrings.end(), fields[0], fieldEnds[0]);
+     m_ownedStrings.push_back('\0');
+
+     if (!ParseNumber(fields[1], fieldEnds[1], rec.size)) {
+       m_skippedLines++;
+       rec.size = 1024;
+     }
+
+     size_t primaryLength = fieldEnds[2] - fields[2];
+     if ((primaryLength == 1 && fields[2][0] == '1') ||
+         (primaryLength == 4 && memcmp(fields[2], "true", 4) == 0)) {
+       rec.flags |= HTTP_TRACE_PRIMARY;
+     }
+
+     if (n >= 5) {
+       ParseNumber(fields[3], fieldEnds[3], rec.requestTime);
+       ParseNumber(fields[4], fieldEnds[4], rec.responseTime);
+     }
+
+     // The dates only count when their flag is set, as in binary traces
+     uint32_t cacheFlags = 0;
+     if (n == MAX_FIELDS && ParseNumber(fields[5], fieldEnds[5], cacheFlags)) {
+       rec.flags |= cacheFlags & HTTP_TRACE_CACHE_FLAGS;
+       if (rec.flags & HTTP_TRACE_IF_MODIFIED_SINCE) {
+         ParseNumber(fields[6], fieldEnds[6], rec.ifModifiedSince);
+       }
+       if (rec.flags & HTTP_TRACE_EXPIRES) {
+         ParseNumber(fields[7], fieldEnds[7], rec.expires);
+       }
+       if (rec.flags & HTTP_TRACE_LAST_MODIFIED) {
+         ParseNumber(fields[8], fieldEnds[8], rec.lastModified);
+       }
+     }
+
+     m_ownedRequests.push_back(rec);
+   }
+
+   void EndCsvPage(size_t pageStart) {
+     size_t count = m_ownedRequests.size() - pageStart;
+     if (count == 0) {
+       return;
+     }
+     HttpTraceFixupPage(&m_ownedRequests[pageStart], count);
+
+     HttpTracePageRecord page;
+     page.firstRequest = pageStart;
+     page.requestCount = count;
+     page.clientId = 0;
+     m_ownedPages.push_back(page);
+   }
+
+   static bool ParseNumber(const char* p, const char* end, uint32_t& value) {
+     uint64_t v = 0;
+     if (p == end) {
+       return false;
+     }
+     for (; p < end; p++) {
+       if (*p < '0' || *p > '9') {
+         return false;
+       }
+       v = v * 10 + (*p - '0');
+       if (v > UINT32_MAX) {
+         return false;
+       }
+     }
+     value = v;
+     return true;
+   }
+
+   static bool FindText(const char* p, const char* end, const char* text) {
+     size_t len = strlen(text);
+     for (; p + len <= end; p++) {
+       if (memcmp(p, text, len) == 0) {
+         return true;
+       }
+     }
+     return false;
+   }
+
+   const char* m_map;                       // Mapped file (binary traces)
+   size_t m_mapSize;
+   const HttpTracePageRecord* m_pages;      // Page index
+   const HttpTraceRequestRecord* m_requests;
+   const char* m_strings;                   // URL string table
+   uint64_t m_pageCount;
+   uint64_t m_requestCount;
+   uint64_t m_stringSize;
+   uint64_t m_skippedLines;
+   std::string m_error;
+
+   // Backing store when the trace came from CSV; version 1 traces only
+   // keep their widened requests here
+   std::vector<HttpTracePageRecord> m_ownedPages;
+   std::vector<HttpTraceRequestRecord> m_ownedRequests;
+   std::vector<char> m_ownedStrings;
+ };
+
+ #endif /* HTTP_TRACE_H */
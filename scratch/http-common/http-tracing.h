@@ -0,0 +1,125 @@
+/* http-tracing.h
+ *
+ * Opt-in tracing for the HTTP simulations, selected with --tracing:
+ *
+ *   none     nothing is installed, so the packet path pays nothing (default)
+ *   flow     flow monitor on the local nodes, summary printed after the run
+ *   sampled  flow, plus the headers of one in --traceSample bottleneck
+ *            packets in <prefix>-sampled-<node>-<device>.pcap
+ *   full     flow, plus ASCII and pcap traces of every packet on every
+ *            device (what every run used to write)
+ */
+
+ #ifndef HTTP_TRACING_H
+ #define HTTP_TRACING_H
+
+ #include "ns3/core-module.h"
+ #include "ns3/flow-monitor-module.h"
+ #include "ns3/network-module.h"
+ #include "http-stats.h"
+ #include "http-topology.h"
+ #include <memory>
+ #include <string>
+ #include <vector>
+
+ using namespace ns3;
+
+ enum HttpTraceLevel {
+   HTTP_TRACE_NONE,
+   HTTP_TRACE_FLOW,
+   HTTP_TRACE_SAMPLED,
+   HTTP_TRACE_FULL
+ };
+
+ inline bool ParseHttpTraceLevel(const std::string& name, HttpTraceLevel& level) {
+   if (name == "none") {
+     level = HTTP_TRACE_NONE;
+   } else if (name == "flow") {
+     level = HTTP_TRACE_FLOW;
+   } else if (name == "sampled") {
+     level = HTTP_TRACE_SAMPLED;
+   } else if (name == "full") {
+     level = HTTP_TRACE_FULL;
+   } else {
+     return false;
+   }
+   return true;
+ }
+
+ class HttpTracing {
+ public:
+   HttpTracing() : m_level(HTTP_TRACE_NONE) {}
+
+   // Call once the applications are installed; prefix names the trace files
+   bool Enable(const std::string& levelName, uint32_t sampleEvery, HttpTopology& topology,
+               const std::string& prefix, std::string& error) {
+     if (!ParseHttpTraceLevel(levelName, m_level)) {
+       error = "unknown tracing level " + levelName + " (use none, flow, sampled or full)";
+       return false;
+     }
+     if (m_level == HTTP_TRACE_SAMPLED && sampleEvery == 0) {
+       error = "--traceSample must be at least 1";
+       return false;
+     }
+     if (m_level == HTTP_TRACE_NONE) {
+       return true;
+     }
+
+     m_flowMonitor = m_flowHelper.Install(topology.GetLocalNodes());
+     if (m_level == HTTP_TRACE_SAMPLED) {
+       EnableSampledPcap(topology, prefix, sampleEvery);
+     } else if (m_level == HTTP_TRACE_FULL) {
+       topology.EnableTracing(prefix);
+     }
+     return true;
+   }
+
+   // Flow monitor summary, if the level installed one
+   void PrintSummary() {
+     if (m_flowMonitor) {
+       PrintFlowStatistics(m_flowMonitor, m_flowHelper);
+     }
+   }
+
+ private:
+   // Link and network/transport headers are all the sampled traces keep
+   static const uint32_t SAMPLE_SNAPLEN = 128;
+
+   struct PcapSampler {
+     Ptr<PcapFileWrapper> file;
+     uint32_t every;
+     uint64_t seen;
+
+     void Sniff(Ptr<const Packet> packet) {
+       if (seen++ % every == 0) {
+         file->Write(Simulator::Now(), packet);
+       }
+     }
+   };
+
+   void EnableSampledPcap(HttpTopology& topology, const std::string& prefix, uint32_t sampleEvery) {
+     PcapHelper pcap;
+     NetDeviceContainer devices = topology.GetBottleneckDevices();
+     for (uint32_t i = 0; i < devices.GetN(); i++) {
+       Ptr<NetDevice> device = devices.Get(i);
+       if (!topology.IsLocal(device->GetNode())) {
+         continue;
+       }
+       std::unique_ptr<PcapSampler> sampler(new PcapSampler());
+       sampler->file = pcap.CreateFile(pcap.GetFilenameFromDevice(prefix + "-sampled", device),
+                                       std::ios::out, PcapHelper::DLT_PPP, SAMPLE_SNAPLEN);
+       sampler->every = sampleEvery;
+       sampler->seen = 0;
+       device->TraceConnectWithoutContext("PromiscSniffer",
+                                          MakeCallback(&PcapSampler::Sniff, sampler.get()));
+       m_samplers.push_back(std::move(sampler));
+     }
+   }
+
+   HttpTraceLevel m_level;
+   Ptr<FlowMonitor> m_flowMonitor;
+   FlowMonitorHelper m_flowHelper;
+   std::vector<std::unique_ptr<PcapSampler>> m_samplers;
+ };
+
+ #endif /* HTTP_TRACING_H */
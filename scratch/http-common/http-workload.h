@@ -0,0 +1,218 @@
+/* http-workload.h
+ *
+ * Generated pages for scale tests beyond the UCB trace (--workload). Every
+ * client replays an HttpWorkloadPageSource that makes its pages on demand:
+ * one primary (HTML) request followed by the page's embedded objects, with
+ * the number of objects, the primary size and each object size drawn from
+ * their own distributions. Nothing is read from disk and only the page
+ * being replayed exists, so with --workloadPages=0 the clients never run
+ * out of pages and a run lasts as long as --time.
+ *
+ * The defaults are shaped like current pages rather than 1996 ones: a
+ * median of about 70 objects per page, a heavy-tailed object size with a
+ * median of 5 KB and a mean near 18 KB, about 1.7 MB per page on average.
+ *
+ * A distribution is given as <name>:<parameters>,
+ *   fixed:<value>
+ *   uniform:<min>,<max>
+ *   exponential:<mean>
+ *   lognormal:<mu>,<sigma>    of the underlying normal; the median is e^mu
+ *   pareto:<scale>,<shape>    scale is the minimum, the mean scale*shape/(shape-1)
+ * and every draw is rounded and clamped to its option's limit.
+ *
+ * The random streams are numbered by client ID, so a client's pages only
+ * depend on --RngSeed, --RngRun and its ID, not on the other clients or
+ * the order the sources are created in.
+ */
+
+ #ifndef HTTP_WORKLOAD_H
+ #define HTTP_WORKLOAD_H
+
+ #include "ns3/core-module.h"
+ #include "http-page-source.h"
+ #include "http-trace.h"
+ #include <algorithm>
+ #include <cmath>
+ #include <cstdint>
+ #include <cstdlib>
+ #include <string>
+ #include <vector>
+
+ using namespace ns3;
+
+ // A parsed distribution spec; streams are created per client from it
+ struct HttpDistribution {
+   std::string name;
+   double a;
+   double b;
+
+   HttpDistribution() : name("fixed"), a(0.0), b(0.0) {}
+
+   bool Parse(const std::string& spec, std::string& error) {
+     size_t colon = spec.find(':');
+     name = spec.substr(0, colon);
+     std::vector<double> params;
+     if (colon != std::string::npos) {
+       const char* p = spec.c_str() + colon + 1;
+       while (*p) {
+         char* end;
+         params.push_back(strtod(p, &end));
+         if (end == p || (*end != ',' && *end != '\0')) {
+           error = "bad number in distribution " + spec;
+           return false;
+         }
+         p = *end ? end + 1 : end;
+       }
+     }
+
+     size_t expected = (name == "fixed" || name == "exponential") ? 1 : 2;
+     if (name != "fixed" && name != "uniform" && name != "exponential" && name != "lognormal" &&
+         name != "pareto") {
+       error = "unknown distribution " + spec + " (use fixed, uniform, exponential, lognormal or pareto)";
+       return false;
+     }
+     if (params.size() != expected) {
+       error = "distribution " + spec + " needs " + std::to_string(expected) + " parameters";
+       return false;
+     }
+     a = params[0];
+     b = expected > 1 ? params[1] : 0.0;
+     if ((name == "uniform" && b < a) || (name == "exponential" && a <= 0.0) ||
+         (name == "lognormal" && b < 0.0) || (name == "pareto" && (a <= 0.0 || b <= 0.0))) {
+       error = "bad parameters in distribution " + spec;
+       return false;
+     }
+     return true;
+   }
+
+   Ptr<RandomVariableStream> Create(int64_t stream) const {
+     Ptr<RandomVariableStream> rv;
+     if (name == "uniform") {
+       rv = CreateObjectWithAttributes<UniformRandomVariable>("Min", DoubleValue(a), "Max", DoubleValue(b));
+     } else if (name == "exponential") {
+       rv = CreateObjectWithAttributes<ExponentialRandomVariable>("Mean", DoubleValue(a));
+     } else if (name == "lognormal") {
+       rv = CreateObjectWithAttributes<LogNormalRandomVariable>("Mu", DoubleValue(a), "Sigma", DoubleValue(b));
+     } else if (name == "pareto") {
+       rv = CreateObjectWithAttributes<ParetoRandomVariable>("Scale", DoubleValue(a), "Shape", DoubleValue(b));
+     } else {
+       rv = CreateObjectWithAttributes<ConstantRandomVariable>("Constant", DoubleValue(a));
+     }
+     rv->SetStream(stream);
+     return rv;
+   }
+ };
+
+ class HttpWorkload {
+ public:
+   HttpWorkload() : m_enabled(false), m_pages(0), m_objectsSpec("lognormal:4.25,0.8"),
+                    m_primarySizeSpec("lognormal:10,1"), m_objectSizeSpec("lognormal:8.5,1.6"),
+                    m_maxObjects(1000), m_maxSize(16 << 20) {}
+
+   void AddOptions(CommandLine& cmd) {
+     cmd.AddValue("workload", "Generate pages (http-workload.h) instead of reading --traceFile", m_enabled);
+     cmd.AddValue("workloadPages", "Generated pages per client (0 = until --time)", m_pages);
+     cmd.AddValue("workloadObjects", "Distribution of the embedded objects per generated page", m_objectsSpec);
+     cmd.AddValue("workloadPrimarySize", "Distribution of the primary (HTML) response sizes in bytes", m_primarySizeSpec);
+     cmd.AddValue("workloadObjectSize", "Distribution of the embedded object sizes in bytes", m_objectSizeSpec);
+     cmd.AddValue("workloadMaxObjects", "Most embedded objects of a generated page", m_maxObjects);
+     cmd.AddValue("workloadMaxSize", "Largest generated response in bytes", m_maxSize);
+   }
+
+   bool Configure(std::string& error) {
+     if (!m_enabled) {
+       return true;
+     }
+     if (m_maxSize == 0) {
+       error = "--workloadMaxSize must be positive";
+       return false;
+     }
+     return m_objects.Parse(m_objectsSpec, error) && m_primarySize.Parse(m_primarySizeSpec, error) &&
+            m_objectSize.Parse(m_objectSizeSpec, error);
+   }
+
+   bool IsEnabled() const {
+     return m_enabled;
+   }
+
+   // 0 if the clients never run out
+   uint32_t GetPagesPerClient() const {
+     return m_pages;
+   }
+
+   Ptr<HttpPageSource> CreateSource(uint32_t clientId) const;
+
+   // Non-negative whole draw of rv, at most limit
+   static uint32_t Draw(Ptr<RandomVariableStream> rv, uint32_t limit) {
+     double value = std::round(rv->GetValue());
+     return value <= 0.0 ? 0 : (uint32_t) std::min(value, (double) limit);
+   }
+
+ private:
+   friend class HttpWorkloadPageSource;
+
+   bool m_enabled;
+   uint32_t m_pages;
+   std::string m_objectsSpec;
+   std::string m_primarySizeSpec;
+   std::string m_objectSizeSpec;
+   uint32_t m_maxObjects;
+   uint32_t m_maxSize;
+   HttpDistribution m_objects;
+   HttpDistribution m_primarySize;
+   HttpDistribution m_objectSize;
+ };
+
+ // One client's generated pages
+ class HttpWorkloadPageSource : public HttpPageSource {
+ public:
+   HttpWorkloadPageSource(const HttpWorkload& workload, uint32_t clientId)
+     : m_clientId(clientId), m_pages(workload.m_pages), m_maxObjects(workload.m_maxObjects),
+       m_maxSize(workload.m_maxSize), m_nextPage(0), m_nextId(0) {
+     int64_t stream = (int64_t) clientId * 3;
+     m_objects = workload.m_objects.Create(stream);
+     m_primarySize = workload.m_primarySize.Create(stream + 1);
+     m_objectSize = workload.m_objectSize.Create(stream + 2);
+   }
+
+   virtual bool Next(WebPage& page) {
+     if (m_pages > 0 && m_nextPage >= m_pages) {
+       return false;
+     }
+     std::string prefix = "/workload/" + std::to_string(m_clientId) + "/" + std::to_string(m_nextPage++);
+     uint32_t objects = HttpWorkload::Draw(m_objects, m_maxObjects);
+
+     page = WebPage();
+     page.requests.resize(1 + objects);
+     for (uint32_t i = 0; i <= objects; i++) {
+       WebRequest& req = page.requests[i];
+       req.id = m_nextId++;
+       req.isPrimary = (i == 0);
+       req.url = req.isPrimary ? prefix + "/index.html" : prefix + "/object" + std::to_string(i);
+       // Every response carries at least one byte
+       req.size = std::max<uint32_t>(HttpWorkload::Draw(req.isPrimary ? m_primarySize : m_objectSize, m_maxSize), 1);
+     }
+     return true;
+   }
+
+   virtual bool IsEndless() const {
+     return m_pages == 0;
+   }
+
+ private:
+   uint32_t m_clientId;
+   uint32_t m_pages;
+   uint32_t m_maxObjects;
+   uint32_t m_maxSize;
+   uint32_t m_nextPage;
+   uint32_t m_nextId;
+   Ptr<RandomVariableStream> m_objects;
+   Ptr<RandomVariableStream> m_primarySize;
+   Ptr<RandomVariableStream> m_objectSize;
+ };
+
+ inline Ptr<HttpPageSource> HttpWorkload::CreateSource(uint32_t clientId) const {
+   return Create<HttpWorkloadPageSource>(*this, clientId);
+ }
+
+ #endif /* HTTP_WORKLOAD_H */
@@ -0,0 +1,261 @@
+/* trace-format.h
+ *
+ * Compact binary page/request format for the HTTP trace simulations.
+ * Written once by a converter (ucb_trace_parser_new.py --binary, or the
+ * native converter in tools/) and memory-mapped by http-trace.h.
+ *
+ * This header has no ns-3 dependencies so the tools can share it.
+ *
+ * File layout (host byte order, little-endian on every platform we run on):
+ *   [HttpTraceFileHeader]
+ *   [HttpTraceRequestRecord x requestCount]   requests in page order
+ *   [HttpTracePageRecord x pageCount]         page offset index
+ *   [string table]                            NUL-terminated URLs
+ * Every section is located through the offsets in the header, so readers
+ * never depend on the order above.
+ *
+ * Version 2 added the trace's cache headers (If-Modified-Since, Expires,
+ * Last-Modified and the no-cache pragmas) to the request records; version
+ * 1 files are still read.
+ */
+
+ #ifndef HTTP_TRACE_FORMAT_H
+ #define HTTP_TRACE_FORMAT_H
+
+ #include <cstdint>
+ #include <cstdio>
+ #include <cstring>
+ #include <string>
+ #include <vector>
+
+ #define HTTP_TRACE_MAGIC "SSTTRACE"
+ #define HTTP_TRACE_VERSION 2
+
+ // Request flags
+ #define HTTP_TRACE_PRIMARY 0x1
+ #define HTTP_TRACE_NO_CACHE 0x2           // Client sent Pragma: no-cache (a reload)
+ #define HTTP_TRACE_IF_MODIFIED_SINCE 0x4  // ifModifiedSince is set
+ #define HTTP_TRACE_SERVER_NO_CACHE 0x8    // Server sent Pragma: no-cache
+ #define HTTP_TRACE_EXPIRES 0x10           // expires is set
+ #define HTTP_TRACE_LAST_MODIFIED 0x20     // lastModified is set
+
+ // The flags a converter takes from the trace's pragmas and dates
+ #define HTTP_TRACE_CACHE_FLAGS (HTTP_TRACE_NO_CACHE | HTTP_TRACE_IF_MODIFIED_SINCE | \
+                                 HTTP_TRACE_SERVER_NO_CACHE | HTTP_TRACE_EXPIRES | \
+                                 HTTP_TRACE_LAST_MODIFIED)
+
+ struct HttpTraceFileHeader {
+   char magic[8];               // HTTP_TRACE_MAGIC, not NUL-terminated
+   uint32_t version;            // HTTP_TRACE_VERSION
+   uint32_t headerSize;         // sizeof(HttpTraceFileHeader)
+   uint32_t pageRecordSize;     // sizeof(HttpTracePageRecord)
+   uint32_t requestRecordSize;  // sizeof(HttpTraceRequestRecord)
+   uint64_t pageCount;
+   uint64_t requestCount;
+   uint64_t pageOffset;         // File offset of the page index
+   uint64_t requestOffset;      // File offset of the request records
+   uint64_t stringOffset;       // File offset of the string table
+   uint64_t stringSize;         // Size of the string table in bytes
+ };
+
+ struct HttpTraceRequestRecord {
+   uint64_t urlOffset;          // Offset of the URL in the string table
+   uint32_t urlLength;          // URL length, excluding the NUL
+   uint32_t size;               // Response size in bytes (header + data)
+   uint32_t clientId;           // Client IP from the trace (0 if unknown)
+   uint32_t requestTime;        // Client request time (trace seconds)
+   uint32_t responseTime;       // Server response time (trace seconds)
+   uint32_t flags;              // HTTP_TRACE_* flags
+   uint32_t ifModifiedSince;    // Client If-Modified-Since (trace seconds, 0 if unset)
+   uint32_t expires;            // Server Expires (trace seconds, 0 if unset)
+   uint32_t lastModified;       // Server Last-Modified (trace seconds, 0 if unset)
+   uint32_t reserved;           // Zero
+ };
+
+ // Request record of version 1 traces, which had no cache fields; readers
+ // still accept those files
+ struct HttpTraceRequestRecordV1 {
+   uint64_t urlOffset;
+   uint32_t urlLength;
+   uint32_t size;
+   uint32_t clientId;
+   uint32_t requestTime;
+   uint32_t responseTime;
+   uint32_t flags;
+ };
+
+ struct HttpTracePageRecord {
+   uint64_t firstRequest;       // Index of the page's first request record
+   uint32_t requestCount;       // Number of requests in the page
+   uint32_t clientId;           // Client IP of the page's requests
+ };
+
+ static_assert(sizeof(HttpTraceFileHeader) == 72, "unexpected trace header layout");
+ static_assert(sizeof(HttpTraceRequestRecord) == 48, "unexpected trace request layout");
+ static_assert(sizeof(HttpTraceRequestRecordV1) == 32, "unexpected version 1 request layout");
+ static_assert(sizeof(HttpTracePageRecord) == 16, "unexpected trace page layout");
+
+ // Make sure the page has a primary request; if the grouping left it without
+ // one, the first request becomes the primary (same rule as the converters).
+ inline void HttpTraceFixupPage(HttpTraceRequestRecord* requests, uint32_t count) {
+   for (uint32_t i = 0; i < count; i++) {
+     if (requests[i].flags & HTTP_TRACE_PRIMARY) {
+       return;
+     }
+   }
+   if (count > 0) {
+     requests[0].flags |= HTTP_TRACE_PRIMARY;
+   }
+ }
+
+ // Streaming writer. Requests are added page by page; only the current page
+ // is kept in memory, the page index and string table are spooled to
+ // temporary files and appended on Close().
+ class HttpTraceWriter {
+ public:
+   HttpTraceWriter() : m_file(nullptr), m_pageSpool(nullptr), m_stringSpool(nullptr),
+                       m_pageCount(0), m_requestCount(0), m_stringSize(0) {}
+   ~HttpTraceWriter() {
+     Close();
+   }
+
+   bool Open(const std::string& filename) {
+     Close();
+     m_file = fopen(filename.c_str(), "wb");
+     m_pageSpool = tmpfile();
+     m_stringSpool = tmpfile();
+     if (!m_file || !m_pageSpool || !m_stringSpool) {
+       Abort();
+       return false;
+     }
+
+     m_pageCount = 0;
+     m_requestCount = 0;
+     m_stringSize = 0;
+     m_page.clear();
+
+     // Reserve room for the header; it is rewritten once the counts are known
+     HttpTraceFileHeader header;
+     memset(&header, 0, sizeof(header));
+     return fwrite(&header, sizeof(header), 1, m_file) == 1;
+   }
+
+   // cacheFlags are HTTP_TRACE_CACHE_FLAGS bits; each date is only kept
+   // when its flag is set
+   void AddRequest(const char* url, uint32_t urlLength, uint32_t size, bool isPrimary,
+                   uint32_t clientId, uint32_t requestTime, uint32_t responseTime,
+                   uint32_t cacheFlags = 0, uint32_t ifModifiedSince = 0,
+                   uint32_t expires = 0, uint32_t lastModified = 0) {
+     HttpTraceRequestRecord record;
+     memset(&record, 0, sizeof(record));
+     record.urlOffset = m_stringSize;
+     record.urlLength = urlLength;
+     record.size = size;
+     record.clientId = clientId;
+     record.requestTime = requestTime;
+     record.responseTime = responseTime;
+     record.flags = (isPrimary ? HTTP_TRACE_PRIMARY : 0) | (cacheFlags & HTTP_TRACE_CACHE_FLAGS);
+     if (record.flags & HTTP_TRACE_IF_MODIFIED_SINCE) {
+       record.ifModifiedSince = ifModifiedSince;
+     }
+     if (record.flags & HTTP_TRACE_EXPIRES) {
+       record.expires = expires;
+     }
+     if (record.flags & HTTP_TRACE_LAST_MODIFIED) {
+       record.lastModified = lastModified;
+     }
+     m_page.push_back(record);
+
+     fwrite(url, 1, urlLength, m_stringSpool);
+     fputc('\0', m_stringSpool);
+     m_stringSize += urlLength + 1;
+   }
+
+   void EndPage() {
+     if (m_page.empty()) {
+       return;
+     }
+
+     HttpTraceFixupPage(m_page.data(), m_page.size());
+     fwrite(m_page.data(), sizeof(HttpTraceRequestRecord), m_page.size(), m_file);
+
+     HttpTracePageRecord page;
+     page.firstRequest = m_requestCount;
+     page.requestCount = m_page.size();
+     page.clientId = m_page[0].clientId;
+     fwrite(&page, sizeof(page), 1, m_pageSpool);
+
+     m_requestCount += m_page.size();
+     m_pageCount++;
+     m_page.clear();
+   }
+
+   bool Close() {
+     if (!m_file) {
+       return false;
+     }
+     EndPage();
+
+     HttpTraceFileHeader header;
+     memset(&header, 0, sizeof(header));
+     memcpy(header.magic, HTTP_TRACE_MAGIC, sizeof(header.magic));
+     header.version = HTTP_TRACE_VERSION;
+     header.headerSize = sizeof(HttpTraceFileHeader);
+     header.pageRecordSize = sizeof(HttpTracePageRecord);
+     header.requestRecordSize = sizeof(HttpTraceRequestRecord);
+     header.pageCount = m_pageCount;
+     header.requestCount = m_requestCount;
+     header.requestOffset = sizeof(HttpTraceFileHeader);
+     header.pageOffset = header.requestOffset + m_requestCount * sizeof(HttpTraceRequestRecord);
+     header.stringOffset = header.pageOffset + m_pageCount * sizeof(HttpTracePageRecord);
+     header.stringSize = m_stringSize;
+
+     bool ok = AppendSpool(m_pageSpool) && AppendSpool(m_stringSpool);
+     ok = ok && fseek(m_file, 0, SEEK_SET) == 0 &&
+          fwrite(&header, sizeof(header), 1, m_file) == 1;
+     ok = (fclose(m_file) == 0) && ok;
+     m_file = nullptr;
+     Abort();
+     return ok;
+   }
+
+   uint64_t GetPageCount() const {
+     return m_pageCount;
+   }
+
+   uint64_t GetRequestCount() const {
+     return m_requestCount;
+   }
+
+ private:
+   bool AppendSpool(FILE* spool) {
+     char buffer[1 << 16];
+     size_t n;
+     rewind(spool);
+     while ((n = fread(buffer, 1, sizeof(buffer), spool)) > 0) {
+       if (fwrite(buffer, 1, n, m_file) != n) {
+         return false;
+       }
+     }
+     return !ferror(spool);
+   }
+
+   void Abort() {
+     if (m_file) fclose(m_file);
+     if (m_pageSpool) fclose(m_pageSpool);
+     if (m_stringSpool) fclose(m_stringSpool);
+     m_file = nullptr;
+     m_pageSpool = nullptr;
+     m_stringSpool = nullptr;
+   }
+
+   FILE* m_file;
+   FILE* m_pageSpool;
+   FILE* m_stringSpool;
+   std::vector<HttpTraceRequestRecord> m_page;  // Requests of the open page
+   uint64_t m_pageCount;
+   uint64_t m_requestCount;
+   uint64_t m_stringSize;
+ };
+
+ #endif /* HTTP_TRACE_FORMAT_H */
@@ -0,0 +1,517 @@
+/* http-sweep.cc
+ *
+ * Parameter sweep driver for the HTTP simulations
+ *
+ * Expands a grid of command line values, e.g.
+ *   --grid="mode=serial,pipelined,sst;bandwidth=1.5Mbps,10Mbps;delay=25ms,50ms"
+ * and runs every point as its own simulation process, keeping up to --jobs
+ * of them going at once (one per core by default).
+ *
+ * - "mode" selects the HTTP mode (serial, parallel, persistent, pipelined,
+ *   sst) of each run, one mode per process; every other key is passed
+ *   through as --key=value, so any option of the simulation (clients,
+ *   topology, maxPages...) can be swept
+ * - Each point runs in its own directory under --outDir, with its output in
+ *   run.log, so the per-run pcap/ascii traces do not clobber each other
+ * - Each point gets --RngRun derived from its parameter values, so a point
+ *   is reproducible no matter which worker ran it or how the grid changed
+ * - The trace is opened read-only by every worker; with the binary format
+ *   (ucb_convert / ucb_trace_parser_new.py --binary) it is memory-mapped
+ *   and all workers share the same page cache copy
+ * - When a point finishes its summary is parsed from run.log and appended
+ *   to --results (CSV, one row per point in grid order)
+ * - Every point writes its quantile sketches (http-sketch.h) to
+ *   sketches.txt; their page load time quantiles go into the results, and
+ *   the sketches of each mode are merged over all its points for the
+ *   closing summary
+ * - With --fork the points that differ only in their link parameters
+ *   (bandwidth, delay, accessBandwidth, accessDelay) share one simulation
+ *   process: it loads the trace, builds the network and installs the
+ *   applications once, then forks a run per point (http-fork.h), so a
+ *   delay sweep pays for the setup once per group instead of once per
+ *   point. The setup's random streams then come from the group's RngRun,
+ *   so forked points reproduce each other but not unforked ones
+ */
+
+ #include "ns3/core-module.h"
+ #include <sys/wait.h>
+ #include <algorithm>
+ #include <cerrno>
+ #include <cstring>
+ #include <fstream>
+ #include <iostream>
+ #include <map>
+ #include <sstream>
+ #include <string>
+ #include <vector>
+ #include "http-common/http-fork.h"
+ #include "http-common/http-process.h"
+ #include "http-common/http-sketch.h"
+
+ using namespace ns3;
+
+ NS_LOG_COMPONENT_DEFINE("HttpSweep");
+
+ struct SweepAxis {
+   std::string key;
+   std::vector<std::string> values;
+ };
+
+ struct SweepPoint {
+   uint32_t index;
+   std::vector<std::pair<std::string, std::string>> params;  // In grid key order
+   std::string mode;
+   uint32_t run;                // Value passed as --RngRun
+   std::string dir;             // Working directory of the run
+   pid_t pid;
+   int status;                  // Raw waitpid() status
+   double wallSeconds;
+ };
+
+ // One process of the sweep: a single point, or with --fork a group of
+ // points forked from one prepared simulation
+ struct SweepLaunch {
+   std::vector<size_t> points;
+   std::string dir;             // Working directory of a forking process, empty for a single point
+   uint32_t run;                // RngRun of a forking process's setup
+   uint32_t slots;              // Concurrent runs it takes
+   double startTime;
+ };
+
+ static std::vector<std::string> Split(const std::string& s, char sep) {
+   std::vector<std::string> parts;
+   std::stringstream ss(s);
+   std::string part;
+   while (std::getline(ss, part, sep)) {
+     if (!part.empty()) {
+       parts.push_back(part);
+     }
+   }
+   return parts;
+ }
+
+ // "key=a,b;key2=c" -> axes in the order given
+ static bool ParseGrid(const std::string& grid, std::vector<SweepAxis>& axes, std::string& error) {
+   for (const std::string& spec : Split(grid, ';')) {
+     size_t eq = spec.find('=');
+     if (eq == std::string::npos || eq == 0) {
+       error = "bad grid entry '" + spec + "', expected key=value[,value...]";
+       return false;
+     }
+     SweepAxis axis;
+     axis.key = spec.substr(0, eq);
+     axis.values = Split(spec.substr(eq + 1), ',');
+     if (axis.values.empty()) {
+       error = "no values for grid key " + axis.key;
+       return false;
+     }
+     for (const SweepAxis& other : axes) {
+       if (other.key == axis.key) {
+         error = "grid key " + axis.key + " given twice";
+         return false;
+       }
+     }
+     if (axis.key == "mode") {
+       for (const std::string& mode : axis.values) {
+         if (!HttpProcess::IsMode(mode)) {
+           error = "unknown mode " + mode;
+           return false;
+         }
+       }
+     }
+     axes.push_back(axis);
+   }
+   return true;
+ }
+
+ // FNV-1a over the point's parameters; never 0 so it is a valid RngRun
+ static uint32_t PointRun(const std::vector<std::pair<std::string, std::string>>& params,
+                          uint32_t baseRun) {
+   uint32_t hash = 2166136261u;
+   for (const auto& p : params) {
+     std::string kv = p.first + "=" + p.second + ";";
+     for (unsigned char c : kv) {
+       hash = (hash ^ c) * 16777619u;
+     }
+   }
+   uint32_t run = hash + baseRun;
+   return run == 0 ? 1 : run;
+ }
+
+ // Cartesian product of the axes; the last axis varies fastest
+ static std::vector<SweepPoint> ExpandGrid(const std::vector<SweepAxis>& axes,
+                                           const std::string& defaultMode) {
+   std::vector<SweepPoint> points;
+   std::vector<size_t> pos(axes.size(), 0);
+   while (true) {
+     SweepPoint point;
+     point.index = points.size();
+     point.mode = defaultMode;
+     for (size_t a = 0; a < axes.size(); a++) {
+       point.params.push_back({axes[a].key, axes[a].values[pos[a]]});
+       if (axes[a].key == "mode") {
+         point.mode = axes[a].values[pos[a]];
+       }
+     }
+     point.run = 0;
+     point.pid = -1;
+     point.status = -1;
+     point.wallSeconds = 0.0;
+     points.push_back(point);
+
+     size_t a = axes.size();
+     while (a > 0 && ++pos[a - 1] == axes[a - 1].values.size()) {
+       pos[a - 1] = 0;
+       a--;
+     }
+     if (a == 0) {
+       break;
+     }
+   }
+   return points;
+ }
+
+ // Fork and exec one point; the child's stdout/stderr go to <dir>/run.log
+ static pid_t LaunchPoint(const SweepPoint& point, const std::vector<std::string>& fixedArgs) {
+   std::vector<std::string> args;
+   args.push_back(HttpProcess::ProgramPath("http-sweep", HttpProcess::GetProgram()));
+   args.push_back("--mode=" + point.mode);
+   args.insert(args.end(), fixedArgs.begin(), fixedArgs.end());
+   for (const auto& p : point.params) {
+     if (p.first != "mode") {
+       args.push_back("--" + p.first + "=" + p.second);
+     }
+   }
+   args.push_back("--RngRun=" + std::to_string(point.run));
+   args.push_back("--sketches=sketches.txt");
+   return HttpProcess::Launch(args, point.dir);
+ }
+
+ // Link parameters can change after the setup, so they do not split groups
+ static bool IsLinkParam(const std::string& key) {
+   return key != "RngRun" && HttpForkServer::IsPointOption(key);
+ }
+
+ // Group the points by mode and every parameter but the link ones, in grid
+ // order; groups of one point are launched on their own
+ static std::vector<SweepLaunch> GroupPoints(const std::vector<SweepPoint>& points, bool forkGroups,
+                                             uint32_t jobs, uint32_t baseRun, const std::string& outDir) {
+   std::vector<SweepLaunch> launches;
+   std::map<std::string, size_t> groups;
+   for (const SweepPoint& point : points) {
+     std::vector<std::pair<std::string, std::string>> setup;
+     std::string key = point.mode;
+     for (const auto& p : point.params) {
+       if (!IsLinkParam(p.first)) {
+         setup.push_back(p);
+         key += ";" + p.first + "=" + p.second;
+       }
+     }
+     auto it = groups.find(key);
+     if (forkGroups && it != groups.end()) {
+       launches[it->second].points.push_back(point.index);
+       continue;
+     }
+     SweepLaunch launch;
+     launch.points.push_back(point.index);
+     launch.run = PointRun(setup, baseRun);
+     launch.startTime = 0.0;
+     groups[key] = launches.size();
+     launches.push_back(launch);
+   }
+   for (size_t i = 0; i < launches.size(); i++) {
+     SweepLaunch& launch = launches[i];
+     launch.slots = std::min<uint32_t>(jobs, launch.points.size());
+     if (launch.points.size() > 1) {
+       launch.dir = outDir + "/group" + std::to_string(i);
+     }
+   }
+   return launches;
+ }
+
+ // Run a group's setup once and fork its points from it; the forking
+ // process logs to <dir>/run.log, each point to its own run.log
+ static pid_t LaunchGroup(const SweepLaunch& launch, const std::vector<SweepPoint>& points,
+                          const std::vector<std::string>& fixedArgs) {
+   const SweepPoint& first = points[launch.points[0]];
+   std::vector<HttpForkPoint> forkPoints;
+   for (size_t index : launch.points) {
+     HttpForkPoint forkPoint;
+     forkPoint.dir = points[index].dir;
+     for (const auto& p : points[index].params) {
+       if (IsLinkParam(p.first)) {
+         forkPoint.options.push_back(p);
+       }
+     }
+     forkPoint.options.push_back({"RngRun", std::to_string(points[index].run)});
+     forkPoints.push_back(forkPoint);
+   }
+   std::string pointFile = launch.dir + "/points.txt";
+   if (!HttpForkServer::WritePoints(pointFile, forkPoints)) {
+     errno = EIO;
+     return -1;
+   }
+
+   std::vector<std::string> args;
+   args.push_back(HttpProcess::ProgramPath("http-sweep", HttpProcess::GetProgram()));
+   args.push_back("--mode=" + first.mode);
+   args.insert(args.end(), fixedArgs.begin(), fixedArgs.end());
+   for (const auto& p : first.params) {
+     if (p.first != "mode" && !IsLinkParam(p.first)) {
+       args.push_back("--" + p.first + "=" + p.second);
+     }
+   }
+   args.push_back("--RngRun=" + std::to_string(launch.run));
+   args.push_back("--sketches=sketches.txt");
+   args.push_back("--forkPoints=" + pointFile);
+   args.push_back("--forkJobs=" + std::to_string(launch.slots));
+   return HttpProcess::Launch(args, launch.dir);
+ }
+
+ // Each point's status and wall time from the forking process's log; points
+ // it never reported take the process's own status
+ static void ReadGroupStatus(const SweepLaunch& launch, int status, std::vector<SweepPoint>& points) {
+   std::map<std::string, size_t> byDir;
+   for (size_t index : launch.points) {
+     points[index].status = status;
+     points[index].wallSeconds = 0.0;
+     byDir[points[index].dir] = index;
+   }
+   std::ifstream in(launch.dir + "/run.log");
+   std::string line;
+   while (std::getline(in, line)) {
+     std::string dir;
+     int pointStatus;
+     double wallSeconds;
+     if (!HttpForkServer::ParseStatusLine(line, dir, pointStatus, wallSeconds)) {
+       continue;
+     }
+     auto it = byDir.find(dir);
+     if (it != byDir.end()) {
+       points[it->second].status = pointStatus;
+       points[it->second].wallSeconds = wallSeconds;
+     }
+   }
+ }
+
+ static std::string CsvField(const std::string& s) {
+   if (s.find_first_of(",\"\n") == std::string::npos) {
+     return s;
+   }
+   std::string quoted = "\"";
+   for (char c : s) {
+     quoted += (c == '"') ? std::string("\"\"") : std::string(1, c);
+   }
+   return quoted + "\"";
+ }
+
+ int main(int argc, char* argv[]) {
+   std::string grid = "";
+   std::string traceFile = "";
+   std::string mode = "serial";   // Used when the grid has no mode key
+   std::string extraArgs = "";
+   std::string outDir = "sweep";
+   std::string resultsFile = "";
+   uint32_t jobs = 0;
+   uint32_t baseRun = 0;
+   bool forkGroups = false;
+
+   CommandLine cmd(__FILE__);
+   cmd.AddValue("grid", "Grid spec, key=v1,v2;key2=v1,... (one mode per point)", grid);
+   cmd.AddValue("traceFile", "Path to trace file, passed to every run", traceFile);
+   cmd.AddValue("mode", "HTTP mode when the grid does not sweep it", mode);
+   cmd.AddValue("args", "Extra options passed to every run, e.g. \"--time=100 --maxPages=0\"", extraArgs);
+   cmd.AddValue("outDir", "Directory for the per-point run directories", outDir);
+   cmd.AddValue("results", "Results CSV (default <outDir>/results.csv)", resultsFile);
+   cmd.AddValue("jobs", "Concurrent runs (0 for one per online core)", jobs);
+   cmd.AddValue("run", "Offset added to every point's RngRun", baseRun);
+   cmd.AddValue("fork", "Set up once per group of points differing only in link parameters and fork the points", forkGroups);
+   cmd.Parse(argc, argv);
+
+   std::vector<SweepAxis> axes;
+   std::string error;
+   if (!ParseGrid(grid, axes, error)) {
+     std::cout << "Error: " << error << std::endl;
+     return 1;
+   }
+   if (!HttpProcess::IsMode(mode)) {
+     std::cout << "Error: unknown mode " << mode << std::endl;
+     return 1;
+   }
+   if (jobs == 0) {
+     long cores = sysconf(_SC_NPROCESSORS_ONLN);
+     jobs = cores > 0 ? cores : 1;
+   }
+   if (!HttpProcess::MakeDirectory(outDir)) {
+     std::cout << "Error: could not create " << outDir << ": " << strerror(errno) << std::endl;
+     return 1;
+   }
+   outDir = HttpProcess::AbsolutePath(outDir);
+   if (resultsFile.empty()) {
+     resultsFile = outDir + "/results.csv";
+   }
+
+   // Runs execute in their own directories, so the trace path must be absolute
+   std::vector<std::string> fixedArgs;
+   if (!traceFile.empty()) {
+     fixedArgs.push_back("--traceFile=" + HttpProcess::AbsolutePath(traceFile));
+   }
+   for (const std::string& arg : Split(extraArgs, ' ')) {
+     fixedArgs.push_back(arg);
+   }
+
+   std::vector<SweepPoint> points = ExpandGrid(axes, mode);
+   for (SweepPoint& point : points) {
+     point.run = PointRun(point.params, baseRun);
+     point.dir = outDir + "/" + std::to_string(point.index);
+     if (!HttpProcess::MakeDirectory(point.dir)) {
+       std::cout << "Error: could not create " << point.dir << ": " << strerror(errno) << std::endl;
+       return 1;
+     }
+   }
+
+   std::vector<SweepLaunch> launches = GroupPoints(points, forkGroups, jobs, baseRun, outDir);
+   for (const SweepLaunch& launch : launches) {
+     if (!launch.dir.empty() && !HttpProcess::MakeDirectory(launch.dir)) {
+       std::cout << "Error: could not create " << launch.dir << ": " << strerror(errno) << std::endl;
+       return 1;
+     }
+   }
+
+   std::cout << "Sweeping " << points.size() << " points with " << jobs << " concurrent runs";
+   if (launches.size() < points.size()) {
+     std::cout << ", forked from " << launches.size() << " setups";
+   }
+   std::cout << std::endl;
+
+   std::map<pid_t, size_t> running;
+   uint32_t busy = 0;
+   size_t next = 0;
+   size_t finished = 0;
+   uint32_t failures = 0;
+   while (finished < points.size()) {
+     while (next < launches.size() && (busy + launches[next].slots <= jobs || running.empty())) {
+       SweepLaunch& launch = launches[next];
+       pid_t pid = launch.dir.empty() ? LaunchPoint(points[launch.points[0]], fixedArgs)
+                                      : LaunchGroup(launch, points, fixedArgs);
+       if (pid < 0) {
+         NS_LOG_ERROR("fork failed for point " << launch.points[0] << ": " << strerror(errno));
+         if (running.empty()) {
+           return 1;
+         }
+         break;  // Retry once a run has finished
+       }
+       for (size_t index : launch.points) {
+         points[index].pid = pid;
+       }
+       launch.startTime = HttpProcess::WallClock();
+       busy += launch.slots;
+       running[pid] = next++;
+     }
+
+     int status;
+     pid_t pid = waitpid(-1, &status, 0);
+     if (pid < 0) {
+       if (errno == EINTR) {
+         continue;
+       }
+       NS_LOG_ERROR("waitpid failed: " << strerror(errno));
+       return 1;
+     }
+     auto it = running.find(pid);
+     if (it == running.end()) {
+       continue;
+     }
+
+     const SweepLaunch& launch = launches[it->second];
+     running.erase(it);
+     busy -= launch.slots;
+     if (launch.dir.empty()) {
+       points[launch.points[0]].status = status;
+       points[launch.points[0]].wallSeconds = HttpProcess::WallClock() - launch.startTime;
+     } else {
+       ReadGroupStatus(launch, status, points);
+     }
+
+     for (size_t index : launch.points) {
+       const SweepPoint& point = points[index];
+       finished++;
+       bool ok = WIFEXITED(point.status) && WEXITSTATUS(point.status) == 0;
+       if (!ok) {
+         failures++;
+       }
+       std::cout << "[" << finished << "/" << points.size() << "] point " << point.index
+                 << " (" << point.mode;
+       for (const auto& p : point.params) {
+         if (p.first != "mode") {
+           std::cout << " " << p.first << "=" << p.second;
+         }
+       }
+       std::cout << ") " << (ok ? "done" : "FAILED") << " in " << point.wallSeconds << "s" << std::endl;
+     }
+   }
+
+   // Collect the results in grid order
+   std::ofstream results(resultsFile);
+   if (!results.is_open()) {
+     std::cout << "Error: could not write " << resultsFile << std::endl;
+     return 1;
+   }
+   results << "point,mode";
+   for (const SweepAxis& axis : axes) {
+     if (axis.key != "mode") {
+       results << "," << CsvField(axis.key);
+     }
+   }
+   results << ",rngRun,exitCode,wallSeconds,avgPageTimeMs,completedPages,totalPages,"
+           << "avgRequestTime,completedRequests,p50PageTimeMs,p90PageTimeMs,p99PageTimeMs,"
+           << "p999PageTimeMs" << std::endl;
+
+   HttpSketchMap modeSketches;
+   for (const SweepPoint& point : points) {
+     HttpRunSummary result = HttpProcess::ParseRunLog(point.dir + "/run.log");
+     int exitCode = WIFEXITED(point.status) ? WEXITSTATUS(point.status) : 128 + WTERMSIG(point.status);
+     HttpSketchMap sketches;
+     if (exitCode == 0 && !ReadSketchFile(point.dir + "/sketches.txt", sketches)) {
+       NS_LOG_WARN("No quantile sketches for point " << point.index);
+     }
+     for (const auto& entry : sketches) {
+       modeSketches[entry.first].Merge(entry.second);
+     }
+     const HttpQuantileSketch& pageTimes = sketches[std::make_pair(point.mode, std::string("page"))];
+
+     results << point.index << "," << point.mode;
+     for (const auto& p : point.params) {
+       if (p.first != "mode") {
+         results << "," << CsvField(p.second);
+       }
+     }
+     results << "," << point.run << "," << exitCode << "," << point.wallSeconds
+             << "," << result.avgPageTimeMs << "," << result.completedPages
+             << "," << result.totalPages << "," << result.avgRequestTime
+             << "," << result.completedRequests << "," << pageTimes.GetQuantile(0.5) / 1000.0
+             << "," << pageTimes.GetQuantile(0.9) / 1000.0 << "," << pageTimes.GetQuantile(0.99) / 1000.0
+             << "," << pageTimes.GetQuantile(0.999) / 1000.0 << std::endl;
+   }
+
+   // Each mode over every point it ran at
+   for (const std::string& name : HttpProcess::GetModes()) {
+     auto pages = modeSketches.find(std::make_pair(name, std::string("page")));
+     auto requests = modeSketches.find(std::make_pair(name, std::string("request")));
+     if (pages == modeSketches.end() || pages->second.GetCount() == 0) {
+       continue;
+     }
+     std::cout << name << " over all points (ms):" << std::endl;
+     PrintSketchQuantiles(std::cout, "page load time", pages->second, 1000.0);
+     if (requests != modeSketches.end()) {
+       PrintSketchQuantiles(std::cout, "request time", requests->second, 1000.0);
+     }
+   }
+
+   std::cout << "Wrote " << points.size() << " results to " << resultsFile;
+   if (failures > 0) {
+     std::cout << " (" << failures << " runs failed, see their run.log)";
+   }
+   std::cout << std::endl;
+   return failures > 0 ? 1 : 0;
+ }
@@ -0,0 +1,107 @@
+/*
+ *       File: addrmap.c
+ *
+ * Open-addressing address map; see addrmap.h.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "addrmap.h"
+
+#define MIN_BITS 4
+
+/* Fibonacci hashing: the top bits of key * 2^32 / phi */
+static unsigned long slot_of(const addr_map *map, UINT32 key)
+{
+  unsigned int h = (unsigned int) (key & 0xFFFFFFFFUL) * 2654435769U;
+
+  return h >> (32 - map->bits);
+}
+
+static int alloc_slots(addr_map *map, unsigned int bits)
+{
+  unsigned long slots = 1UL << bits;
+
+  map->keys = (UINT32 *) malloc(slots * sizeof(UINT32));
+  map->values = (UINT32 *) malloc(slots * sizeof(UINT32));
+  map->used = (unsigned char *) calloc(slots, 1);
+  if (map->keys == NULL || map->values == NULL || map->used == NULL) {
+    addr_map_destroy(map);
+    return -1;
+  }
+  map->bits = bits;
+  map->count = 0;
+  return 0;
+}
+
+int addr_map_init(addr_map *map, unsigned long expected)
+{
+  unsigned int bits = MIN_BITS;
+
+  memset(map, 0, sizeof(*map));
+  while (bits < 31 && (1UL << bits) * 3 / 4 < expected)
+    bits++;
+  return alloc_slots(map, bits);
+}
+
+void addr_map_destroy(addr_map *map)
+{
+  free(map->keys);
+  free(map->values);
+  free(map->used);
+  map->keys = map->values = NULL;
+  map->used = NULL;
+  map->count = 0;
+}
+
+UINT32 *addr_map_find(const addr_map *map, UINT32 key)
+{
+  unsigned long mask = (1UL << map->bits) - 1, i;
+
+  key &= 0xFFFFFFFFUL;
+  for (i = slot_of(map, key); map->used[i]; i = (i + 1) & mask) {
+    if (map->keys[i] == key)
+      return &(map->values[i]);
+  }
+  return NULL;
+}
+
+/* Double the table and reinsert everything */
+static int grow(addr_map *map)
+{
+  addr_map      bigger;
+  unsigned long i;
+
+  if (map->bits >= 31 || alloc_slots(&bigger, map->bits + 1) != 0)
+    return -1;
+  for (i = 0; i < (1UL << map->bits); i++) {
+    if (map->used[i])
+      addr_map_insert(&bigger, map->keys[i], map->values[i]);
+  }
+  addr_map_destroy(map);
+  *map = bigger;
+  return 0;
+}
+
+int addr_map_insert(addr_map *map, UINT32 key, UINT32 value)
+{
+  unsigned long mask, i;
+
+  key &= 0xFFFFFFFFUL;
+  if ((map->count + 1) * 4 > (1UL << map->bits) * 3 && grow(map) != 0)
+    return -1;
+
+  mask = (1UL << map->bits) - 1;
+  for (i = slot_of(map, key); map->used[i]; i = (i + 1) & mask) {
+    if (map->keys[i] == key) {
+      map->values[i] = value;
+      return 0;
+    }
+  }
+  map->used[i] = 1;
+  map->keys[i] = key;
+  map->values[i] = value;
+  map->count++;
+  return 0;
+}
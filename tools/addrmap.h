@@ -0,0 +1,41 @@
+/*
+ *       File: addrmap.h
+ *
+ * An open-addressing map from 32-bit addresses to 32-bit values, for the
+ * per-client lookups of anon_filter.  The keys and values live in flat
+ * arrays that are probed linearly from a multiplicative hash of the key,
+ * so a lookup is normally one or two adjacent cache lines; the chained
+ * hash tables of utils.h cost an allocation per element and a pointer
+ * chase per probe.  The map doubles when it is 3/4 full and never
+ * shrinks; elements cannot be deleted.
+ *
+ * A map is not locked: concurrent addr_map_find calls are safe, but
+ * inserting needs the map to itself.
+ */
+
+#ifndef ADDRMAP_H
+#define ADDRMAP_H
+
+#include "config.h"
+
+typedef struct addr_map_st {
+  UINT32        *keys;
+  UINT32        *values;
+  unsigned char *used;
+  unsigned long  count;
+  unsigned int   bits;     /* the arrays have 2^bits slots */
+} addr_map;
+
+/* Room for "expected" elements before the first resize.  Returns 0 on
+   success, -1 if out of memory. */
+int     addr_map_init(addr_map *map, unsigned long expected);
+void    addr_map_destroy(addr_map *map);
+
+/* The value stored for key, or NULL if there is none. */
+UINT32 *addr_map_find(const addr_map *map, UINT32 key);
+
+/* Store value for key, replacing any previous value.  Returns 0 on
+   success, -1 if out of memory. */
+int     addr_map_insert(addr_map *map, UINT32 key, UINT32 value);
+
+#endif
@@ -0,0 +1,47 @@
+/* 
+ * COPYRIGHT AND DISCLAIMER
+ * 
+ * Copyright (C) 1996-1997 by the Regents of the University of California.
+ *
+ * IN NO EVENT SHALL THE AUTHORS OR DISTRIBUTORS BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES ARISING OUT
+ * OF THE USE OF THIS SOFTWARE, ITS DOCUMENTATION, OR ANY DERIVATIVES THEREOF,
+ * EVEN IF THE AUTHORS HAVE BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ * THE AUTHORS AND DISTRIBUTORS SPECIFICALLY DISCLAIM ANY WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT. THIS SOFTWARE IS
+ * PROVIDED ON AN "AS IS" BASIS, AND THE AUTHORS AND DISTRIBUTORS HAVE NO
+ * OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR
+ * MODIFICATIONS.
+ *
+ * For inquiries email Steve Gribble <gribble@cs.berkeley.edu>.
+ */
+
+/*
+ *     Author: Steve Gribble - gribble@cs.berkeley.edu
+ *       Date: Nov. 19th, 1996
+ *       File: anon.h
+ */
+
+#ifndef PB_ANON_H
+#define PB_ANON_H
+
+#include "config.h"
+#include "logparse.h"
+
+/* The anonymized form of a client or server address */
+UINT32 anon_address(UINT32 addr);
+
+/* Replace the URL with its MD5, keeping the method, the suffix, whether
+   it had a query or "cgi" in it, and the HTTP version.  *new_url is
+   malloc()ed; *new_urllen is 0 (and *new_url NULL) if the URL was left
+   alone. */
+void anon_switcheroo_url(unsigned char *orig_url, UINT16 orig_urllen,
+			 unsigned char **new_url, UINT16 *new_urllen);
+
+/* Whether the record is a well-formed GET, POST, HEAD or PUT worth
+   keeping */
+int sanitycheck(lf_entry *entry);
+
+#endif
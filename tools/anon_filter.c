@@ -0,0 +1,505 @@
+/*
+ *       File: anon_filter.c
+ *
+ * A pipelined anon_clients and showtrace for multi-day traces.  A reader
+ * thread pulls the input in large blocks and cuts each one at a record
+ * boundary, worker threads anonymize and filter the records of a block
+ * each, and the main thread writes the finished blocks out in input
+ * order, so the output is the same as one thread would produce.
+ *
+ * Records are anonymized exactly as anon_clients does (anon.c) unless -n
+ * is given.  Each worker remembers the addresses it has anonymized in an
+ * open-addressing map (addrmap.h), so a client or server costs one MD5
+ * per worker rather than one per request.
+ *
+ * Clients are selected by their original address: -c keeps only those
+ * listed in a file (one dotted quad per line), -s keeps one client in N
+ * by a hash of the address, so each kept client has all of its requests.
+ *
+ * Output is the binary trace format (lf_write) or, with -d, the text of
+ * showtrace (lf_dump).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+#include "logparse.h"
+#include "anon.h"
+#include "addrmap.h"
+
+#define HEADER_SIZE       60
+#define MAX_RECORD_SIZE   (HEADER_SIZE + 65535)
+#define DEFAULT_BLOCK_MB  4
+#define BLOCKS_PER_WORKER 4
+#define MAX_WORKERS       256
+
+typedef struct block_st {
+  unsigned char *data;        /* whole records */
+  size_t         length;
+  char          *out;         /* open_memstream() output of the worker */
+  size_t         outlength;
+  unsigned long  records;     /* records in data */
+  unsigned long  kept;        /* records written to out */
+  unsigned long  insane;      /* records that failed sanitycheck */
+  int            done;
+} block;
+
+typedef struct options_st {
+  int            anonymize;
+  int            dump;
+  unsigned long  sample;      /* keep one client in this many; 1 keeps all */
+  addr_map       clients;     /* clients to keep, in host order */
+  int            have_clients;
+} options;
+
+/* The state shared by the reader, the workers and the writer.  Block i
+   of the input lives in blocks[i % nblocks]; read counts the blocks the
+   reader has filled, taken those a worker has started and written those
+   the writer is finished with, so read - written <= nblocks. */
+typedef struct pipeline_st {
+  pthread_mutex_t lock;
+  pthread_cond_t  changed;
+  block          *blocks;
+  unsigned long   nblocks;
+  size_t          block_size;
+  unsigned long   read;
+  unsigned long   taken;
+  unsigned long   written;
+  int             eof;
+  int             error;      /* the input was unreadable or truncated */
+  int             fd;
+  const options  *opts;
+} pipeline;
+
+static void usage(const char *prog)
+{
+  fprintf(stderr, "Usage: %s [-t threads] [-b block_mb] [-c clientfile] [-s N] [-n] [-d]"
+          " < infile > outfile\n", prog);
+  fprintf(stderr, "  -t  worker threads (default one per online core)\n");
+  fprintf(stderr, "  -b  input block size in MB (default %d)\n", DEFAULT_BLOCK_MB);
+  fprintf(stderr, "  -c  keep only the client addresses listed in clientfile\n");
+  fprintf(stderr, "  -s  keep one client in N\n");
+  fprintf(stderr, "  -n  do not anonymize, only filter\n");
+  fprintf(stderr, "  -d  write showtrace text instead of binary records\n");
+  exit(1);
+}
+
+static void *xmalloc(size_t size)
+{
+  void *p = malloc(size);
+
+  if (p == NULL) {
+    fprintf(stderr, "Out of memory.\n");
+    exit(1);
+  }
+  return p;
+}
+
+static unsigned int record_size(const unsigned char *header)
+{
+  UINT16 urllen;
+
+  memcpy(&urllen, header + 58, 2);
+  return HEADER_SIZE + ntohs(urllen);
+}
+
+/* Same layout as lf_get_next_entry; the URL is copied into url, which
+   must hold 65536 bytes */
+static void parse_entry(const unsigned char *rec, lf_entry *entry, unsigned char *url)
+{
+  memset(entry, 0, sizeof(*entry));
+  memcpy( &(entry->crs),  rec+0,  4);
+  memcpy( &(entry->cru),  rec+4,  4);
+  memcpy( &(entry->srs),  rec+8,  4);
+  memcpy( &(entry->sru),  rec+12, 4);
+  memcpy( &(entry->sls),  rec+16, 4);
+  memcpy( &(entry->slu),  rec+20, 4);
+  memcpy( &(entry->cip),  rec+24, 4);
+  memcpy( &(entry->cpt),  rec+28, 2);
+  memcpy( &(entry->sip),  rec+30, 4);
+  memcpy( &(entry->spt),  rec+34, 2);
+  memcpy( &(entry->cprg), rec+36, 1);
+  memcpy( &(entry->sprg), rec+37, 1);
+  memcpy( &(entry->cims), rec+38, 4);
+  memcpy( &(entry->sexp), rec+42, 4);
+  memcpy( &(entry->slmd), rec+46, 4);
+  memcpy( &(entry->rhl),  rec+50, 4);
+  memcpy( &(entry->rdl),  rec+54, 4);
+  memcpy( &(entry->urllen), rec+58, 2);
+
+  memcpy(url, rec + HEADER_SIZE, ntohs(entry->urllen));
+  url[ntohs(entry->urllen)] = '\0';
+  entry->url = url;
+}
+
+static int keep_client(const options *opts, UINT32 cip)
+{
+  UINT32 host = ntohl((unsigned int) cip);
+
+  if (opts->have_clients && addr_map_find(&opts->clients, host) == NULL)
+    return 0;
+  if (opts->sample > 1 &&
+      ((unsigned int) (host & 0xFFFFFFFFUL) * 2654435769U >> 8) % opts->sample != 0)
+    return 0;
+  return 1;
+}
+
+static UINT32 anon_cached(addr_map *seen, UINT32 addr)
+{
+  UINT32 *anon = addr_map_find(seen, addr);
+  UINT32  value;
+
+  if (anon != NULL)
+    return *anon;
+  value = anon_address(addr);
+  if (addr_map_insert(seen, addr, value) != 0) {
+    fprintf(stderr, "Out of memory.\n");
+    exit(1);
+  }
+  return value;
+}
+
+/* Anonymize and filter one block into b->out */
+static void process_block(const options *opts, block *b, addr_map *seen, unsigned char *url)
+{
+  FILE    *out;
+  size_t   pos;
+  lf_entry entry;
+  int      ok = 1;
+
+  b->out = NULL;
+  b->outlength = 0;
+  b->records = b->kept = b->insane = 0;
+  if ((out = open_memstream(&b->out, &b->outlength)) == NULL) {
+    perror("open_memstream");
+    exit(1);
+  }
+
+  for (pos = 0; pos < b->length; pos += record_size(b->data + pos)) {
+    parse_entry(b->data + pos, &entry, url);
+    b->records++;
+    if (!keep_client(opts, entry.cip))
+      continue;
+
+    if (opts->anonymize) {
+      unsigned char *new_url = NULL;
+      UINT16         new_urllen = 0;
+
+      if (!sanitycheck(&entry)) {
+        b->insane++;
+        continue;
+      }
+      entry.cip = anon_cached(seen, entry.cip);
+      entry.sip = anon_cached(seen, entry.sip);
+      anon_switcheroo_url(entry.url, ntohs(entry.urllen), &new_url, &new_urllen);
+      if (new_urllen != 0) {
+        entry.url = new_url;
+        entry.urllen = htons(new_urllen);
+      }
+      if (opts->dump)
+        lf_dump(out, &entry);
+      else
+        ok = lf_write(out, &entry) == 0 && ok;
+      free(new_url);
+    } else if (opts->dump) {
+      lf_dump(out, &entry);
+    } else {
+      ok = lf_write(out, &entry) == 0 && ok;
+    }
+    b->kept++;
+  }
+
+  if (fclose(out) != 0 || !ok) {
+    fprintf(stderr, "Failed to format a block of output.\n");
+    exit(1);
+  }
+}
+
+/* Fill buf with up to size bytes; fewer only at EOF.  -1 on a read error. */
+static ssize_t read_full(int fd, unsigned char *buf, size_t size)
+{
+  size_t  sofar = 0;
+  ssize_t ret;
+
+  while (sofar < size) {
+    ret = read(fd, buf + sofar, size - sofar);
+    if (ret < 0) {
+      if (errno == EINTR)
+        continue;
+      return -1;
+    }
+    if (ret == 0)
+      break;
+    sofar += ret;
+  }
+  return sofar;
+}
+
+/* Cut the input into blocks of whole records; the partial record at the
+   end of a read starts the next block */
+static void *reader_main(void *arg)
+{
+  pipeline      *p = (pipeline *) arg;
+  unsigned char *carry = (unsigned char *) xmalloc(MAX_RECORD_SIZE);
+  size_t         carried = 0, pos, length, want;
+  ssize_t        got;
+  int            error = 0;
+
+  while (1) {
+    block *b;
+
+    pthread_mutex_lock(&p->lock);
+    while (p->read - p->written >= p->nblocks)
+      pthread_cond_wait(&p->changed, &p->lock);
+    b = &p->blocks[p->read % p->nblocks];
+    pthread_mutex_unlock(&p->lock);
+
+    memcpy(b->data, carry, carried);
+    want = p->block_size - carried;
+    got = read_full(p->fd, b->data + carried, want);
+    if (got < 0) {
+      perror("read");
+      error = 1;
+      break;
+    }
+    length = carried + got;
+
+    pos = 0;
+    while (pos + HEADER_SIZE <= length && pos + record_size(b->data + pos) <= length)
+      pos += record_size(b->data + pos);
+    carried = length - pos;
+    memcpy(carry, b->data + pos, carried);
+
+    if (pos > 0) {
+      b->length = pos;
+      b->done = 0;
+      pthread_mutex_lock(&p->lock);
+      p->read++;
+      pthread_cond_broadcast(&p->changed);
+      pthread_mutex_unlock(&p->lock);
+    }
+    if ((size_t) got < want)
+      break;  /* EOF */
+  }
+
+  if (!error && carried > 0) {
+    fprintf(stderr, "Truncated record at the end of the input.\n");
+    error = 1;
+  }
+  free(carry);
+
+  pthread_mutex_lock(&p->lock);
+  p->eof = 1;
+  p->error = error;
+  pthread_cond_broadcast(&p->changed);
+  pthread_mutex_unlock(&p->lock);
+  return NULL;
+}
+
+static void *worker_main(void *arg)
+{
+  pipeline      *p = (pipeline *) arg;
+  /* anon_switcheroo_url briefly writes the byte before a URL it finds no
+     end of, so leave one in front */
+  unsigned char *buf = (unsigned char *) xmalloc(1 + 65536);
+  unsigned char *url = buf + 1;
+  addr_map       seen;
+
+  if (addr_map_init(&seen, 1 << 16) != 0) {
+    fprintf(stderr, "Out of memory.\n");
+    exit(1);
+  }
+
+  while (1) {
+    block *b;
+
+    pthread_mutex_lock(&p->lock);
+    while (p->taken == p->read && !p->eof)
+      pthread_cond_wait(&p->changed, &p->lock);
+    if (p->taken == p->read) {
+      pthread_mutex_unlock(&p->lock);
+      break;
+    }
+    b = &p->blocks[p->taken++ % p->nblocks];
+    pthread_mutex_unlock(&p->lock);
+
+    process_block(p->opts, b, &seen, url);
+
+    pthread_mutex_lock(&p->lock);
+    b->done = 1;
+    pthread_cond_broadcast(&p->changed);
+    pthread_mutex_unlock(&p->lock);
+  }
+
+  addr_map_destroy(&seen);
+  free(buf);
+  return NULL;
+}
+
+static void load_clients(const char *filename, addr_map *clients)
+{
+  FILE          *in = fopen(filename, "r");
+  char           line[256];
+  struct in_addr addr;
+
+  if (in == NULL) {
+    perror(filename);
+    exit(1);
+  }
+  if (addr_map_init(clients, 1024) != 0) {
+    fprintf(stderr, "Out of memory.\n");
+    exit(1);
+  }
+  while (fgets(line, sizeof(line), in) != NULL) {
+    line[strcspn(line, " \t\r\n")] = '\0';
+    if (line[0] == '\0' || line[0] == '#')
+      continue;
+    if (inet_aton(line, &addr) == 0) {
+      fprintf(stderr, "Bad client address '%s' in %s.\n", line, filename);
+      exit(1);
+    }
+    if (addr_map_insert(clients, ntohl(addr.s_addr), 1) != 0) {
+      fprintf(stderr, "Out of memory.\n");
+      exit(1);
+    }
+  }
+  fclose(in);
+}
+
+int main(int argc, char **argv)
+{
+  options        opts;
+  pipeline       p;
+  pthread_t      reader, workers[MAX_WORKERS];
+  long           nworkers = 0, i;
+  size_t         block_mb = DEFAULT_BLOCK_MB;
+  unsigned long  records = 0, kept = 0, insane = 0;
+  int            opt, failed = 0;
+
+  memset(&opts, 0, sizeof(opts));
+  opts.anonymize = 1;
+  opts.sample = 1;
+
+  while ((opt = getopt(argc, argv, "t:b:c:s:nd")) != -1) {
+    switch (opt) {
+    case 't':
+      nworkers = atol(optarg);
+      if (nworkers < 1 || nworkers > MAX_WORKERS)
+        usage(argv[0]);
+      break;
+    case 'b':
+      block_mb = atol(optarg);
+      if (block_mb < 1)
+        usage(argv[0]);
+      break;
+    case 'c':
+      load_clients(optarg, &opts.clients);
+      opts.have_clients = 1;
+      break;
+    case 's':
+      opts.sample = strtoul(optarg, NULL, 10);
+      if (opts.sample < 1)
+        usage(argv[0]);
+      break;
+    case 'n':
+      opts.anonymize = 0;
+      break;
+    case 'd':
+      opts.dump = 1;
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if (optind != argc)
+    usage(argv[0]);
+  if (nworkers == 0) {
+    nworkers = sysconf(_SC_NPROCESSORS_ONLN);
+    if (nworkers < 1)
+      nworkers = 1;
+    if (nworkers > MAX_WORKERS)
+      nworkers = MAX_WORKERS;
+  }
+
+  memset(&p, 0, sizeof(p));
+  pthread_mutex_init(&p.lock, NULL);
+  pthread_cond_init(&p.changed, NULL);
+  p.nblocks = nworkers * BLOCKS_PER_WORKER;
+  p.block_size = block_mb << 20;
+  if (p.block_size < MAX_RECORD_SIZE)
+    p.block_size = MAX_RECORD_SIZE;
+  p.blocks = (block *) xmalloc(p.nblocks * sizeof(block));
+  for (i = 0; i < (long) p.nblocks; i++) {
+    memset(&p.blocks[i], 0, sizeof(block));
+    p.blocks[i].data = (unsigned char *) xmalloc(p.block_size);
+  }
+  p.fd = 0;
+  p.opts = &opts;
+  posix_fadvise(p.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+  if (pthread_create(&reader, NULL, reader_main, &p) != 0) {
+    perror("pthread_create");
+    exit(1);
+  }
+  for (i = 0; i < nworkers; i++) {
+    if (pthread_create(&workers[i], NULL, worker_main, &p) != 0) {
+      perror("pthread_create");
+      exit(1);
+    }
+  }
+
+  /* Write the blocks out in input order as they are finished */
+  while (1) {
+    block *b;
+
+    pthread_mutex_lock(&p.lock);
+    while (!(p.written < p.read && p.blocks[p.written % p.nblocks].done) &&
+           !(p.eof && p.written == p.read))
+      pthread_cond_wait(&p.changed, &p.lock);
+    if (p.written == p.read) {
+      failed = p.error;
+      pthread_mutex_unlock(&p.lock);
+      break;
+    }
+    b = &p.blocks[p.written % p.nblocks];
+    pthread_mutex_unlock(&p.lock);
+
+    if (b->outlength > 0 && fwrite(b->out, b->outlength, 1, stdout) != 1) {
+      perror("write");
+      exit(1);
+    }
+    records += b->records;
+    kept += b->kept;
+    insane += b->insane;
+    free(b->out);
+    b->out = NULL;
+
+    pthread_mutex_lock(&p.lock);
+    b->done = 0;
+    p.written++;
+    pthread_cond_broadcast(&p.changed);
+    pthread_mutex_unlock(&p.lock);
+  }
+
+  pthread_join(reader, NULL);
+  for (i = 0; i < nworkers; i++)
+    pthread_join(workers[i], NULL);
+  if (fflush(stdout) != 0) {
+    perror("write");
+    exit(1);
+  }
+
+  fprintf(stderr, "Read %lu records, wrote %lu", records, kept);
+  if (insane > 0)
+    fprintf(stderr, ", dropped %lu that failed the sanity check", insane);
+  fprintf(stderr, ".\n");
+  if (failed)
+    fprintf(stderr, "Failed to get next entry.\n");
+  exit(failed ? 1 : 0);
+}
@@ -0,0 +1,326 @@
+/*
+ *       File: ucb_convert.cc
+ *
+ * Converts a UCB HomeIP trace into the binary page format read by the
+ * ns-3 simulations (scratch/http-common/trace-format.h).
+ *
+ * Pages are formed with the Section 5.5 method used by
+ * ucb_trace_parser_new.py: requests are sorted by client IP (ties keep
+ * trace order), and each contiguous run of secondary requests is
+ * attached to the preceding primary request of the same client.
+ *
+ * The sort is an external merge sort: records are read with
+ * lf_get_next_entry into a bounded chunk, each chunk is sorted and
+ * spilled to a temporary run file, and the runs are merged straight into
+ * the trace writer. Memory use is bounded by the chunk size (-m).
+ *
+ * The no-cache pragmas and the If-Modified-Since, Expires and
+ * Last-Modified dates are carried through for the browser cache model.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <queue>
+#include <vector>
+
+extern "C" {
+#include "logparse.h"
+}
+#include "trace-format.h"
+
+#define DEFAULT_CHUNK_MB 256
+#define RUN_BUFFER_SIZE  (1 << 20)
+#define UNDEFINED_FIELD  0xFFFFFFFFUL
+
+/* One request as stored in a chunk and in a run file.  The URL follows
+   the fixed fields in the run file, and lives in the chunk's arena while
+   the chunk is being sorted. */
+struct ConvertRecord {
+  uint32_t cip;
+  uint64_t seq;           /* position in the input trace */
+  uint32_t size;
+  uint32_t requestTime;
+  uint32_t responseTime;
+  uint32_t cacheFlags;    /* HTTP_TRACE_CACHE_FLAGS bits */
+  uint32_t cims;          /* dates, valid when flagged */
+  uint32_t sexp;
+  uint32_t slmd;
+  uint32_t urlOffset;     /* offset in the chunk arena */
+  uint16_t urlLength;
+  uint8_t  isPrimary;
+};
+
+struct RunReader {
+  FILE *file;
+  ConvertRecord rec;
+  std::vector<char> url;
+};
+
+struct RunOrder {
+  const std::vector<RunReader> *runs;
+  bool operator()(int a, int b) const {
+    const ConvertRecord &ra = (*runs)[a].rec, &rb = (*runs)[b].rec;
+    if (ra.cip != rb.cip)
+      return ra.cip > rb.cip;
+    return ra.seq > rb.seq;
+  }
+};
+
+/* Same heuristic as is_primary_request() in ucb_trace_parser_new.py, so
+   both converters produce identical pages. */
+static int is_primary_url(const char *url, int len)
+{
+  static const char *secondary[] = {
+    ".gif", ".jpg", ".jpeg", ".png", ".css", ".js", ".ico", ".bmp", NULL
+  };
+  char lower[1024];
+  int  i, n = (len < (int) sizeof(lower) - 1) ? len : (int) sizeof(lower) - 1;
+
+  for (i = 0; i < n; i++)
+    lower[i] = tolower((unsigned char) url[i]);
+  lower[n] = '\0';
+
+  for (i = 0; secondary[i] != NULL; i++) {
+    if (strstr(lower, secondary[i]) != NULL)
+      return 0;
+  }
+
+  /* CGI flag (but not CSS files) */
+  if (strstr(url, ".c") != NULL && strstr(lower, ".css") == NULL)
+    return 0;
+
+  return 1;
+}
+
+static uint32_t defined_or_zero(unsigned long v)
+{
+  return (v == UNDEFINED_FIELD) ? 0 : (uint32_t) v;
+}
+
+/* Cache flags from the pragmas and dates; an undefined pragma (0xFF) says
+   nothing, an undefined date is simply absent. */
+static uint32_t cache_flags(lf_entry *entry)
+{
+  uint32_t flags = 0;
+
+  if (entry->cprg != 0xFF && (entry->cprg & PB_CLNT_NO_CACHE))
+    flags |= HTTP_TRACE_NO_CACHE;
+  if (entry->sprg != 0xFF && (entry->sprg & PB_SRVR_NO_CACHE))
+    flags |= HTTP_TRACE_SERVER_NO_CACHE;
+  if (entry->cims != UNDEFINED_FIELD)
+    flags |= HTTP_TRACE_IF_MODIFIED_SINCE;
+  if (entry->sexp != UNDEFINED_FIELD)
+    flags |= HTTP_TRACE_EXPIRES;
+  if (entry->slmd != UNDEFINED_FIELD)
+    flags |= HTTP_TRACE_LAST_MODIFIED;
+  return flags;
+}
+
+static void make_record(lf_entry *entry, uint64_t seq, ConvertRecord *rec)
+{
+  long elapsed;
+
+  rec->cip = (uint32_t) entry->cip;
+  rec->seq = seq;
+  rec->size = defined_or_zero(entry->rhl) + defined_or_zero(entry->rdl);
+  rec->requestTime = (uint32_t) entry->crs;
+  elapsed = (long) (uint32_t) entry->sls - (long) (uint32_t) entry->srs;
+  if (entry->sls == UNDEFINED_FIELD || entry->srs == UNDEFINED_FIELD || elapsed < 1)
+    elapsed = 1;
+  rec->responseTime = (uint32_t) elapsed;
+  rec->cacheFlags = cache_flags(entry);
+  rec->cims = defined_or_zero(entry->cims);
+  rec->sexp = defined_or_zero(entry->sexp);
+  rec->slmd = defined_or_zero(entry->slmd);
+  rec->urlLength = entry->urllen;
+  rec->isPrimary = is_primary_url((const char *) entry->url, entry->urllen);
+}
+
+static int write_run_record(FILE *run, const ConvertRecord *rec, const char *url)
+{
+  if (fwrite(rec, sizeof(*rec), 1, run) != 1)
+    return -1;
+  if (rec->urlLength > 0 && fwrite(url, 1, rec->urlLength, run) != rec->urlLength)
+    return -1;
+  return 0;
+}
+
+static int read_run_record(RunReader *reader)
+{
+  if (fread(&reader->rec, sizeof(reader->rec), 1, reader->file) != 1)
+    return 1;
+  reader->url.resize(reader->rec.urlLength);
+  if (reader->rec.urlLength > 0 &&
+      fread(reader->url.data(), 1, reader->rec.urlLength, reader->file) != reader->rec.urlLength)
+    return 2;
+  return 0;
+}
+
+/* Sort the chunk by (client IP, trace position) and spill it as a run. */
+static FILE *spill_chunk(std::vector<ConvertRecord> &chunk, std::vector<char> &arena)
+{
+  FILE *run;
+  size_t i;
+
+  std::sort(chunk.begin(), chunk.end(),
+            [](const ConvertRecord &a, const ConvertRecord &b) {
+              if (a.cip != b.cip)
+                return a.cip < b.cip;
+              return a.seq < b.seq;
+            });
+
+  if ((run = tmpfile()) == NULL) {
+    perror("tmpfile");
+    exit(1);
+  }
+  for (i = 0; i < chunk.size(); i++) {
+    if (write_run_record(run, &chunk[i], arena.data() + chunk[i].urlOffset) != 0) {
+      fprintf(stderr, "Failed to write sort run.\n");
+      exit(1);
+    }
+  }
+  rewind(run);
+
+  chunk.clear();
+  arena.clear();
+  return run;
+}
+
+static void usage(const char *prog)
+{
+  fprintf(stderr, "Usage: %s [-m chunk_mb] <infile|-> <outfile>\n", prog);
+  exit(1);
+}
+
+int main(int argc, char **argv)
+{
+  std::vector<ConvertRecord> chunk;
+  std::vector<char>          arena;
+  std::vector<RunReader>     runs;
+  HttpTraceWriter            writer;
+  lf_entry                   entry;
+  ConvertRecord              rec;
+  size_t                     chunkLimit = (size_t) DEFAULT_CHUNK_MB << 20;
+  uint64_t                   seq = 0;
+  uint32_t                   lastClient = 0;
+  int                        haveClient = 0;
+  int                        fd, ret, opt;
+  size_t                     i;
+
+  while ((opt = getopt(argc, argv, "m:")) != -1) {
+    switch (opt) {
+    case 'm':
+      chunkLimit = (size_t) atol(optarg) << 20;
+      if (chunkLimit == 0)
+        usage(argv[0]);
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if (argc - optind != 2)
+    usage(argv[0]);
+
+  if (strcmp(argv[optind], "-") == 0) {
+    fd = 0;
+  } else if ((fd = open(argv[optind], O_RDONLY)) < 0) {
+    perror(argv[optind]);
+    exit(1);
+  }
+
+  /* Pass 1: read bounded chunks and spill them as sorted runs */
+  memset(&entry, 0, sizeof(entry));
+  while ((ret = lf_get_next_entry(fd, &entry, 0)) == 0) {
+    lf_convert_order(&entry);
+    make_record(&entry, seq++, &rec);
+    rec.urlOffset = arena.size();
+    arena.insert(arena.end(), (char *) entry.url, (char *) entry.url + rec.urlLength);
+    chunk.push_back(rec);
+    free(entry.url);
+    memset(&entry, 0, sizeof(entry));
+
+    if (chunk.size() * sizeof(ConvertRecord) + arena.size() >= chunkLimit) {
+      RunReader reader = RunReader();
+      reader.file = spill_chunk(chunk, arena);
+      runs.push_back(reader);
+      fprintf(stderr, "Sorted run %lu (%llu records so far).\n",
+              (unsigned long) runs.size(), (unsigned long long) seq);
+    }
+  }
+  if (ret != 1) {
+    fprintf(stderr, "Failed to get next entry after %llu records.\n",
+            (unsigned long long) seq);
+    exit(1);
+  }
+  if (!chunk.empty()) {
+    RunReader reader = RunReader();
+    reader.file = spill_chunk(chunk, arena);
+    runs.push_back(reader);
+  }
+  if (fd != 0)
+    close(fd);
+  std::vector<ConvertRecord>().swap(chunk);
+  std::vector<char>().swap(arena);
+
+  fprintf(stderr, "Read %llu records into %lu sorted runs.\n",
+          (unsigned long long) seq, (unsigned long) runs.size());
+
+  /* Pass 2: merge the runs and group requests into pages */
+  if (!writer.Open(argv[optind + 1])) {
+    perror(argv[optind + 1]);
+    exit(1);
+  }
+
+  RunOrder order = { &runs };
+  std::priority_queue<int, std::vector<int>, RunOrder> heap(order);
+  for (i = 0; i < runs.size(); i++) {
+    setvbuf(runs[i].file, NULL, _IOFBF, RUN_BUFFER_SIZE);
+    if (read_run_record(&runs[i]) == 0)
+      heap.push((int) i);
+  }
+
+  while (!heap.empty()) {
+    int top = heap.top();
+    RunReader &reader = runs[top];
+    heap.pop();
+
+    /* A new client or a primary request closes the current page */
+    if (!haveClient || reader.rec.cip != lastClient || reader.rec.isPrimary)
+      writer.EndPage();
+    haveClient = 1;
+    lastClient = reader.rec.cip;
+
+    writer.AddRequest(reader.url.data(), reader.rec.urlLength, reader.rec.size,
+                      reader.rec.isPrimary, reader.rec.cip,
+                      reader.rec.requestTime, reader.rec.responseTime,
+                      reader.rec.cacheFlags, reader.rec.cims, reader.rec.sexp,
+                      reader.rec.slmd);
+
+    ret = read_run_record(&reader);
+    if (ret == 0) {
+      heap.push(top);
+    } else if (ret != 1) {
+      fprintf(stderr, "Truncated sort run.\n");
+      exit(1);
+    }
+  }
+
+  for (i = 0; i < runs.size(); i++)
+    fclose(runs[i].file);
+
+  if (!writer.Close()) {
+    fprintf(stderr, "Failed to write %s.\n", argv[optind + 1]);
+    exit(1);
+  }
+  fprintf(stderr, "Wrote %llu requests in %llu pages to %s.\n",
+          (unsigned long long) writer.GetRequestCount(),
+          (unsigned long long) writer.GetPageCount(), argv[optind + 1]);
+  return 0;
+}
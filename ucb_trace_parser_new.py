@@ -14,8 +14,20 @@ import os
 
 # Defining the binary record structure as per logparse.h
 HEADER_SIZE = 60  # 60 bytes for the fixed header
+UNDEFINED = 0xFFFFFFFF  # Missing dates in the trace
 
-def parse_binary_trace(trace_file, output_file):
+# Cache flags of scratch/http-common/trace-format.h
+TRACE_NO_CACHE = 0x2
+TRACE_IF_MODIFIED_SINCE = 0x4
+TRACE_SERVER_NO_CACHE = 0x8
+TRACE_EXPIRES = 0x10
+TRACE_LAST_MODIFIED = 0x20
+
+# logparse.h pragma bits
+PB_CLNT_NO_CACHE = 1
+PB_SRVR_NO_CACHE = 1
+
+def parse_binary_trace(trace_file, output_file, binary_output=False):
     """Parse the binary UCB trace file using SST paper methodology"""
     
     requests = []
@@ -74,7 +86,12 @@ def parse_binary_trace(trace_file, output_file):
                         'resp_data_len': resp_data_len,
                         'size': resp_header_len + resp_data_len,
                         'is_primary': is_primary_request(url),
-                        'response_time': max(1, server_last_sec - server_first_sec)
+                        'response_time': max(1, server_last_sec - server_first_sec),
+                        'cache_flags': cache_flags(client_pragma, server_pragma, client_if_mod_since,
+                                                   server_expires, server_last_modified),
+                        'if_modified_since': defined_or_zero(client_if_mod_since),
+                        'expires': defined_or_zero(server_expires),
+                        'last_modified': defined_or_zero(server_last_modified)
                     }
                     
                     requests.append(request)
@@ -98,7 +115,10 @@ def parse_binary_trace(trace_file, output_file):
         pages = group_requests_into_pages_sst_method(requests)
         
         # Write to output file
-        write_pages_to_file(pages, output_file)
+        if binary_output:
+            write_pages_to_binary_file(pages, output_file)
+        else:
+            write_pages_to_file(pages, output_file)
         
     except Exception as e:
         print(f"Error processing trace file: {e}")
@@ -106,6 +126,24 @@ def parse_binary_trace(trace_file, output_file):
     
     return True
 
+def defined_or_zero(value):
+    return 0 if value == UNDEFINED else value
+
+def cache_flags(client_pragma, server_pragma, if_mod_since, expires, last_modified):
+    """Cache flags from the pragmas and dates, as tools/ucb_convert.cc sets them"""
+    flags = 0
+    if client_pragma != 0xFF and client_pragma & PB_CLNT_NO_CACHE:
+        flags |= TRACE_NO_CACHE
+    if server_pragma != 0xFF and server_pragma & PB_SRVR_NO_CACHE:
+        flags |= TRACE_SERVER_NO_CACHE
+    if if_mod_since != UNDEFINED:
+        flags |= TRACE_IF_MODIFIED_SINCE
+    if expires != UNDEFINED:
+        flags |= TRACE_EXPIRES
+    if last_modified != UNDEFINED:
+        flags |= TRACE_LAST_MODIFIED
+    return flags
+
 def is_primary_request(url):
     """Determine if URL is likely a primary (HTML) request"""
     url_lower = url.lower()
@@ -192,26 +230,68 @@ def group_requests_into_pages_sst_method(requests):
 def write_pages_to_file(pages, output_file):
     """Write pages to output file in format suitable for NS-3 simulation"""
     with open(output_file, 'w') as f:
-        f.write("# URL,SIZE_IN_BYTES,IS_PRIMARY(1=true,0=false),REQUEST_TIME,RESPONSE_TIME\n")
+        f.write("# URL,SIZE_IN_BYTES,IS_PRIMARY(1=true,0=false),REQUEST_TIME,RESPONSE_TIME,"
+                "CACHE_FLAGS,IF_MODIFIED_SINCE,EXPIRES,LAST_MODIFIED\n")
         
         for i, page in enumerate(pages):
             f.write(f"# --- Page {i+1} ({len(page)} requests) ---\n")
             
             for req in page:
                 f.write(f"{req['url']},{req['size']},{1 if req['is_primary'] else 0},"
-                       f"{req['client_req_time']},{req['response_time']}\n")
+                       f"{req['client_req_time']},{req['response_time']},"
+                       f"{req['cache_flags']},{req['if_modified_since']},"
+                       f"{req['expires']},{req['last_modified']}\n")
             
             f.write(f"# --- End of Page {i+1} ---\n")
     
     print(f"Successfully wrote {len(pages)} pages to {output_file}")
 
+def write_pages_to_binary_file(pages, output_file):
+    """Write pages in the binary format read by scratch/http-common/http-trace.h"""
+    header_size = 72
+    request_record_size = 48
+    request_records = bytearray()
+    page_records = bytearray()
+    strings = bytearray()
+    request_count = 0
+
+    for page in pages:
+        page_records += struct.pack('<QII', request_count, len(page), page[0]['client_ip'])
+        for req in page:
+            url = req['url'].encode('utf-8', errors='replace')
+            flags = (1 if req['is_primary'] else 0) | req['cache_flags']
+            request_records += struct.pack('<QIIIIIIIIII', len(strings), len(url), req['size'],
+                                           req['client_ip'], req['client_req_time'],
+                                           req['response_time'], flags,
+                                           req['if_modified_since'], req['expires'],
+                                           req['last_modified'], 0)
+            strings += url + b'\0'
+        request_count += len(page)
+
+    request_offset = header_size
+    page_offset = request_offset + len(request_records)
+    string_offset = page_offset + len(page_records)
+
+    with open(output_file, 'wb') as f:
+        f.write(struct.pack('<8sIIIIQQQQQQ', b'SSTTRACE', 2, header_size, 16, request_record_size,
+                            len(pages), request_count, page_offset, request_offset,
+                            string_offset, len(strings)))
+        f.write(request_records)
+        f.write(page_records)
+        f.write(strings)
+
+    print(f"Successfully wrote {len(pages)} pages to {output_file} (binary)")
+
 def main():
-    if len(sys.argv) != 3:
-        print(f"Usage: {sys.argv[0]} <trace_file> <output_file.txt>")
+    args = [arg for arg in sys.argv[1:] if arg != '--binary']
+    binary_output = len(args) != len(sys.argv) - 1
+
+    if len(args) != 2:
+        print(f"Usage: {sys.argv[0]} [--binary] <trace_file> <output_file>")
         sys.exit(1)
     
-    trace_file = sys.argv[1]
-    output_file = sys.argv[2]
+    trace_file = args[0]
+    output_file = args[1]
     
     # Check if the trace file exists
     if not os.path.isfile(trace_file):
@@ -224,7 +304,7 @@ def main():
         sys.exit(1)
     
     # Parse the trace file
-    success = parse_binary_trace(trace_file, output_file)
+    success = parse_binary_trace(trace_file, output_file, binary_output)
     
     if not success:
         print("Failed to process the trace file")